@@ -113,7 +113,7 @@ cluster_hash_alloc (void *p)
 }
 
 /* Cluster list related functions. */
-static struct cluster_list *
+struct cluster_list *
 cluster_parse (struct in_addr * pnt, int length)
 {
   struct cluster_list tmp;
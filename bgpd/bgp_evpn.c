@@ -325,34 +325,121 @@ free_vni_entry (struct hash_backet *backet, struct bgp *bgp)
 }
 
 /*
- * Add (update) or delete MACIP from zebra.
+ * MACIP install/uninstall waiting to be sent to zebra. There is at most
+ * one per MAC/IP in a VNI; a later install or uninstall of the same
+ * MAC/IP overwrites it, so a burst of MAC moves only sends the final
+ * state of each MAC.
  */
+struct evpn_macip_pending
+{
+  struct prefix_evpn p;
+  struct in_addr remote_vtep_ip;
+  int add;
+};
+
+/* Largest MACIP entry in a ZEBRA_REMOTE_MACIP_ADD/DEL message. */
+#define EVPN_MACIP_ENTRY_MAXLEN \
+  (4 + ETHER_ADDR_LEN + 4 + IPV6_MAX_BYTELEN + IPV4_MAX_BYTELEN)
+
+/* State while writing the pending MACIPs of a VNI to zebra. */
+struct evpn_macip_batch
+{
+  struct bgp *bgp;
+  struct bgpevpn *vpn;
+  int add;
+  unsigned int count;
+};
+
+static unsigned int
+macip_pending_hash_key_make (void *p)
+{
+  struct evpn_macip_pending *mp = p;
+
+  return jhash (&mp->p.prefix, sizeof (struct evpn_addr), 0);
+}
+
 static int
-bgp_zebra_send_remote_macip (struct bgp *bgp, struct bgpevpn *vpn,
-                             struct prefix_evpn *p,
-                             struct in_addr remote_vtep_ip,
-                             int add)
+macip_pending_hash_cmp (const void *p1, const void *p2)
 {
-  struct stream *s;
+  const struct evpn_macip_pending *mp1 = p1;
+  const struct evpn_macip_pending *mp2 = p2;
+
+  return (memcmp (&mp1->p.prefix, &mp2->p.prefix,
+                  sizeof (struct evpn_addr)) == 0);
+}
+
+static void *
+macip_pending_alloc (void *p)
+{
+  struct evpn_macip_pending *mp;
+
+  mp = XCALLOC (MTYPE_BGP_EVPN_MACIP, sizeof (struct evpn_macip_pending));
+  mp->p = ((struct evpn_macip_pending *) p)->p;
+  return mp;
+}
+
+static void
+macip_pending_free (void *p)
+{
+  XFREE (MTYPE_BGP_EVPN_MACIP, p);
+}
+
+static void
+macip_batch_start (struct evpn_macip_batch *batch)
+{
+  struct stream *s = zclient->obuf;
+
+  stream_reset (s);
+  zclient_create_header (s, batch->add ?
+                         ZEBRA_REMOTE_MACIP_ADD : ZEBRA_REMOTE_MACIP_DEL,
+                         batch->bgp->vrf_id);
+  batch->count = 0;
+}
+
+static void
+macip_batch_send (struct evpn_macip_batch *batch)
+{
+  struct stream *s = zclient->obuf;
+
+  if (!batch->count)
+    return;
+
+  stream_putw_at (s, 0, stream_get_endp (s));
+
+  if (bgp_debug_zebra (NULL))
+    zlog_debug("Tx %s MACIP, VNI %u, %u entries",
+               batch->add ? "ADD" : "DEL", batch->vpn->vni, batch->count);
+
+  zclient_send_message (zclient);
+  batch->count = 0;
+}
+
+/*
+ * Add one pending MACIP to the message being built, sending the message
+ * first if the entry would not fit. Iterator function, called once for
+ * uninstalls and once for installs.
+ */
+static void
+macip_batch_put (struct hash_backet *backet, struct evpn_macip_batch *batch)
+{
+  struct evpn_macip_pending *mp = backet->data;
+  struct prefix_evpn *p = &mp->p;
+  struct stream *s = zclient->obuf;
   int ipa_len;
   char buf1[MACADDR_STRLEN];
   char buf2[INET6_ADDRSTRLEN];
   char buf3[INET6_ADDRSTRLEN];
 
-  /* Check socket. */
-  if (!zclient || zclient->sock < 0)
-    return 0;
-
-  /* Don't try to register if Zebra doesn't know of this instance. */
-  if (!IS_BGP_INST_KNOWN_TO_ZEBRA(bgp))
-    return 0;
+  if (mp->add != batch->add || zclient->sock < 0)
+    return;
 
-  s = zclient->obuf;
-  stream_reset (s);
+  if (batch->count && STREAM_WRITEABLE (s) < EVPN_MACIP_ENTRY_MAXLEN)
+    {
+      macip_batch_send (batch);
+      macip_batch_start (batch);
+    }
 
-  zclient_create_header (s, add ? ZEBRA_REMOTE_MACIP_ADD : ZEBRA_REMOTE_MACIP_DEL,
-                         bgp->vrf_id);
-  stream_putl(s, vpn->vni);
+  stream_putl(s, batch->vpn->vni);
   stream_put (s, &p->prefix.mac.octet, ETHER_ADDR_LEN); /* Mac Addr */
   /* IP address length and IP address, if any. */
   if (IS_EVPN_PREFIX_IPADDR_NONE(p))
@@ -364,18 +451,103 @@ bgp_zebra_send_remote_macip (struct bgp *bgp, struct bgpevpn *vpn,
       stream_putl(s, ipa_len);
       stream_put (s, &p->prefix.ip.ip.addr, ipa_len);
     }
-  stream_put_in_addr(s, &remote_vtep_ip);
-
-  stream_putw_at (s, 0, stream_get_endp (s));
+  stream_put_in_addr(s, &mp->remote_vtep_ip);
+  batch->count++;
 
   if (bgp_debug_zebra (NULL))
     zlog_debug("Tx %s MACIP, VNI %u MAC %s IP %s remote VTEP %s",
-               add ? "ADD" : "DEL", vpn->vni,
+               mp->add ? "ADD" : "DEL", batch->vpn->vni,
                mac2str (&p->prefix.mac, buf1, sizeof(buf1)),
                ipaddr2str (&p->prefix.ip, buf3, sizeof(buf3)),
-               inet_ntop(AF_INET, &remote_vtep_ip, buf2, sizeof(buf2)));
+               inet_ntop(AF_INET, &mp->remote_vtep_ip, buf2, sizeof(buf2)));
+}
 
-  return zclient_send_message(zclient);
+/*
+ * Send the pending MACIP installs and uninstalls of a VNI to zebra, as
+ * few messages as fit. Uninstalls go first so that zebra never holds the
+ * old and the new entry for a MAC at the same time.
+ */
+static void
+evpn_zebra_flush_macip (struct bgp *bgp, struct bgpevpn *vpn)
+{
+  struct evpn_macip_batch batch;
+
+  if (!CHECK_FLAG (vpn->flags, VNI_FLAG_MACIP_PENDING))
+    return;
+
+  UNSET_FLAG (vpn->flags, VNI_FLAG_MACIP_PENDING);
+  TAILQ_REMOVE (&bgp->evpn_macip_queue, vpn, macip_entry);
+
+  /* Don't try to register if Zebra doesn't know of this instance. */
+  if (zclient && zclient->sock >= 0 && IS_BGP_INST_KNOWN_TO_ZEBRA(bgp))
+    {
+      batch.bgp = bgp;
+      batch.vpn = vpn;
+      for (batch.add = 0; batch.add <= 1; batch.add++)
+        {
+          macip_batch_start (&batch);
+          hash_iterate (vpn->macip_pending,
+                        (void (*) (struct hash_backet *, void *))
+                        macip_batch_put, &batch);
+          if (zclient->sock >= 0)
+            macip_batch_send (&batch);
+        }
+    }
+
+  hash_clean (vpn->macip_pending, macip_pending_free);
+}
+
+/*
+ * Send the MACIP updates of all VNIs queued since the timer was started.
+ */
+static int
+evpn_zebra_macip_timer (struct thread *thread)
+{
+  struct bgp *bgp = THREAD_ARG (thread);
+  struct bgpevpn *vpn;
+
+  bgp->t_evpn_macip = NULL;
+
+  while ((vpn = TAILQ_FIRST (&bgp->evpn_macip_queue)) != NULL)
+    evpn_zebra_flush_macip (bgp, vpn);
+
+  return 0;
+}
+
+/*
+ * Queue a MACIP install (add) or uninstall for zebra. Updates arriving
+ * within BGP_EVPN_MACIP_HOLD_MSEC of each other are grouped per VNI and
+ * sent together.
+ */
+static int
+evpn_zebra_queue_macip (struct bgp *bgp, struct bgpevpn *vpn,
+                        struct prefix_evpn *p,
+                        struct in_addr remote_vtep_ip,
+                        int add)
+{
+  struct evpn_macip_pending tmp;
+  struct evpn_macip_pending *mp;
+
+  if (!vpn->macip_pending)
+    vpn->macip_pending = hash_create (macip_pending_hash_key_make,
+                                      macip_pending_hash_cmp);
+
+  memset (&tmp, 0, sizeof (tmp));
+  tmp.p = *p;
+  mp = hash_get (vpn->macip_pending, &tmp, macip_pending_alloc);
+  mp->remote_vtep_ip = remote_vtep_ip;
+  mp->add = add;
+
+  if (!CHECK_FLAG (vpn->flags, VNI_FLAG_MACIP_PENDING))
+    {
+      SET_FLAG (vpn->flags, VNI_FLAG_MACIP_PENDING);
+      TAILQ_INSERT_TAIL (&bgp->evpn_macip_queue, vpn, macip_entry);
+    }
+
+  THREAD_TIMER_MSEC_ON (bm->master, bgp->t_evpn_macip,
+                        evpn_zebra_macip_timer, bgp,
+                        BGP_EVPN_MACIP_HOLD_MSEC);
+  return 0;
 }
 
 /*
@@ -397,6 +569,9 @@ bgp_zebra_send_remote_vtep (struct bgp *bgp, struct bgpevpn *vpn,
   if (!IS_BGP_INST_KNOWN_TO_ZEBRA(bgp))
     return 0;
 
+  /* Keep MACIPs queued for this VNI ahead of the VTEP change. */
+  evpn_zebra_flush_macip (bgp, vpn);
+
   s = zclient->obuf;
   stream_reset (s);
 
@@ -498,7 +673,7 @@ evpn_zebra_install (struct bgp *bgp, struct bgpevpn *vpn,
   int ret;
 
   if (p->prefix.route_type == BGP_EVPN_MAC_IP_ROUTE)
-    ret = bgp_zebra_send_remote_macip (bgp, vpn, p, remote_vtep_ip, 1);
+    ret = evpn_zebra_queue_macip (bgp, vpn, p, remote_vtep_ip, 1);
   else
     ret = bgp_zebra_send_remote_vtep (bgp, vpn, p, 1);
 
@@ -513,7 +688,7 @@ evpn_zebra_uninstall (struct bgp *bgp, struct bgpevpn *vpn,
   int ret;
 
   if (p->prefix.route_type == BGP_EVPN_MAC_IP_ROUTE)
-    ret = bgp_zebra_send_remote_macip (bgp, vpn, p, remote_vtep_ip, 0);
+    ret = evpn_zebra_queue_macip (bgp, vpn, p, remote_vtep_ip, 0);
   else
     ret = bgp_zebra_send_remote_vtep (bgp, vpn, p, 0);
 
@@ -993,7 +1168,7 @@ delete_global_type2_routes (struct bgp *bgp, struct bgpevpn *vpn)
   afi = AFI_L2VPN;
   safi = SAFI_EVPN;
 
-  rdrn = bgp_node_lookup (bgp->rib[afi][safi], (struct prefix *) &vpn->prd);
+  rdrn = bgp_rd_node_lookup (bgp->rib[afi][safi], &vpn->prd);
   if (rdrn && rdrn->info)
     {
       table = (struct bgp_table *)rdrn->info;
@@ -2134,6 +2309,12 @@ bgp_evpn_new (struct bgp *bgp, vni_t vni, struct in_addr originator_ip)
 void
 bgp_evpn_free (struct bgp *bgp, struct bgpevpn *vpn)
 {
+  if (vpn->macip_pending)
+    {
+      evpn_zebra_flush_macip (bgp, vpn);
+      hash_free (vpn->macip_pending);
+      vpn->macip_pending = NULL;
+    }
   bgp_table_unlock (vpn->route_table);
   bgp_evpn_unmap_vni_from_its_rts (bgp, vpn);
   list_delete (vpn->import_rtl);
@@ -2589,6 +2770,7 @@ bgp_evpn_init (struct bgp *bgp)
 {
   bgp->vnihash = hash_create(vni_hash_key_make, vni_hash_cmp);
   bgp->import_rt_hash = hash_create(import_rt_hash_key_make, import_rt_hash_cmp);
+  TAILQ_INIT (&bgp->evpn_macip_queue);
 }
 
 /*
@@ -2613,6 +2795,7 @@ bgp_evpn_cleanup (struct bgp *bgp)
   hash_iterate (bgp->vnihash,
                 (void (*) (struct hash_backet *, void *))
                 free_vni_entry, bgp);
+  THREAD_TIMER_OFF (bgp->t_evpn_macip);
   hash_free(bgp->import_rt_hash);
   bgp->import_rt_hash = NULL;
   hash_free(bgp->vnihash);
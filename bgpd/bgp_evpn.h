@@ -57,6 +57,7 @@ struct bgpevpn
 #define VNI_FLAG_RD_CFGD           0x4  /* RD is user configured. */
 #define VNI_FLAG_IMPRT_CFGD        0x8  /* Import RT is user configured */
 #define VNI_FLAG_EXPRT_CFGD        0x10 /* Export RT is user configured */
+#define VNI_FLAG_MACIP_PENDING     0x20 /* MACIPs queued for zebra */
 
   /* RD for this VNI. */
   struct prefix_rd          prd;
@@ -71,6 +72,11 @@ struct bgpevpn
   /* Route table for EVPN routes for this VNI. */
   struct bgp_table          *route_table;
 
+  /* MACIP installs/uninstalls not yet sent to zebra, and linkage on
+   * the instance's queue of VNIs that have some. */
+  struct hash               *macip_pending;
+  TAILQ_ENTRY (bgpevpn)     macip_entry;
+
   QOBJ_FIELDS
 };
 
@@ -955,7 +955,7 @@ bgp_evpn_show_route_rd (struct vty *vty, struct bgp *bgp,
   safi = SAFI_EVPN;
   prefix_cnt = path_cnt = 0;
 
-  rd_rn = bgp_node_lookup (bgp->rib[afi][safi], (struct prefix *) prd);
+  rd_rn = bgp_rd_node_lookup (bgp->rib[afi][safi], prd);
   if (!rd_rn)
     return;
   table = (struct bgp_table *)rd_rn->info;
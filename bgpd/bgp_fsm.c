@@ -550,6 +550,19 @@ bgp_graceful_stale_timer_expire (struct thread *thread)
   return 0;
 }
 
+/* Start the stalepath timer for a peer whose stale paths were not left
+ * over by a session going down, e.g. paths restored from a RIB snapshot. */
+void
+bgp_graceful_stale_timer_start (struct peer *peer)
+{
+  if (bgp_debug_neighbor_events(peer))
+    zlog_debug ("%s graceful restart stalepath timer started for %d sec",
+                peer->host, peer->bgp->stalepath_time);
+
+  BGP_TIMER_ON (peer->t_gr_stale, bgp_graceful_stale_timer_expire,
+                peer->bgp->stalepath_time);
+}
+
 static int
 bgp_update_delay_applicable (struct bgp *bgp)
 {
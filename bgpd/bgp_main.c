@@ -54,6 +54,7 @@ Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
 #include "bgpd/bgp_debug.h"
 #include "bgpd/bgp_filter.h"
 #include "bgpd/bgp_zebra.h"
+#include "bgpd/bgp_snapshot.h"
 
 #ifdef ENABLE_BGP_VNC
 #include "bgpd/rfapi/rfapi_backend.h"
@@ -209,6 +210,8 @@ sigint (void)
 {
   zlog_notice ("Terminating on signal");
 
+  bgp_snapshot_save_all ();
+
   if (! retain_mode)
     {
       bgp_terminate ();
@@ -551,6 +554,9 @@ main (int argc, char **argv)
   /* Start execution only if not in dry-run mode */
   if(dryrun)
     return(0);
+
+  /* Restore the RIB saved at the last clean shutdown, if configured. */
+  bgp_snapshot_load_all ();
   
   /* Turn into daemon if daemon_mode is set. */
   if (daemon_mode && daemon (0, 0) < 0)
@@ -73,6 +73,8 @@ bnc_new (void)
 void
 bnc_free (struct bgp_nexthop_cache *bnc)
 {
+  if (CHECK_FLAG (bnc->flags, BGP_NEXTHOP_EVAL_PENDING))
+    TAILQ_REMOVE (&bnc->bgp->nht_eval_queue, bnc, eval_entry);
   bnc_nexthop_free (bnc);
   XFREE (MTYPE_BGP_NEXTHOP_CACHE, bnc);
 }
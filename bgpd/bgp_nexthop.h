@@ -54,6 +54,7 @@ struct bgp_nexthop_cache
 #define BGP_NEXTHOP_PEER_NOTIFIED     (1 << 3)
 #define BGP_STATIC_ROUTE              (1 << 4)
 #define BGP_STATIC_ROUTE_EXACT_MATCH  (1 << 5)
+#define BGP_NEXTHOP_EVAL_PENDING      (1 << 6)
 
   u_int16_t change_flags;
 
@@ -66,6 +67,9 @@ struct bgp_nexthop_cache
   LIST_HEAD(path_list, bgp_info) paths;
   unsigned int path_count;
   struct bgp *bgp;
+
+  /* Linkage on bgp->nht_eval_queue while BGP_NEXTHOP_EVAL_PENDING */
+  TAILQ_ENTRY (bgp_nexthop_cache) eval_entry;
 };
 
 extern int bgp_nexthop_lookup (afi_t, struct peer *peer, struct bgp_info *,
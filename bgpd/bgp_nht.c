@@ -50,6 +50,7 @@ static void register_zebra_rnh(struct bgp_nexthop_cache *bnc,
 static void unregister_zebra_rnh(struct bgp_nexthop_cache *bnc,
 				 int is_bgp_static_route);
 static void evaluate_paths(struct bgp_nexthop_cache *bnc);
+static void schedule_evaluate_paths(struct bgp_nexthop_cache *bnc);
 static int make_prefix(int afi, struct bgp_info *ri, struct prefix *p);
 static void path_nh_map(struct bgp_info *path, struct bgp_nexthop_cache *bnc,
 			int keep);
@@ -287,6 +288,31 @@ bgp_find_or_add_nexthop (struct bgp *bgp, afi_t afi, struct bgp_info *ri,
   return (bgp_isvalid_nexthop(bnc));
 }
 
+/* Register with zebra every nexthop of this instance that is not yet
+ * registered.  Nexthops added while zebra was unreachable, e.g. by the
+ * RIB snapshot loaded at startup, would otherwise never be resolved. */
+void
+bgp_nht_register_nexthops (struct bgp *bgp)
+{
+  struct bgp_node *rn;
+  afi_t afi;
+
+  for (afi = AFI_IP; afi < AFI_MAX; afi++)
+    {
+      if (bgp->nexthop_cache_table[afi])
+        for (rn = bgp_table_top (bgp->nexthop_cache_table[afi]); rn;
+             rn = bgp_route_next (rn))
+          if (rn->info)
+            register_zebra_rnh (rn->info, 0);
+
+      if (bgp->import_check_table[afi])
+        for (rn = bgp_table_top (bgp->import_check_table[afi]); rn;
+             rn = bgp_route_next (rn))
+          if (rn->info)
+            register_zebra_rnh (rn->info, 1);
+    }
+}
+
 void
 bgp_delete_connected_nexthop (afi_t afi, struct peer *peer)
 {
@@ -412,7 +438,8 @@ bgp_parse_nexthop_update (int command, vrf_id_t vrf_id)
   bnc = rn->info;
   bgp_unlock_node (rn);
   bnc->last_update = bgp_clock();
-  bnc->change_flags = 0;
+  /* change_flags accumulate until the paths are evaluated; an update
+   * arriving while one is already pending is folded into it. */
   (void)stream_getc (s);
   metric = stream_getl (s);
   nexthop_num = stream_getc (s);
@@ -517,7 +544,7 @@ bgp_parse_nexthop_update (int command, vrf_id_t vrf_id)
       bnc->nexthop = NULL;
     }
 
-  evaluate_paths(bnc);
+  schedule_evaluate_paths(bnc);
 }
 
 /**
@@ -762,6 +789,64 @@ evaluate_paths (struct bgp_nexthop_cache *bnc)
   RESET_FLAG(bnc->change_flags);
 }
 
+/**
+ * bgp_nht_eval_timer - Evaluate the paths of every nexthop that received
+ *   an update from zebra since the timer was started.
+ * ARGUMENTS:
+ *   struct thread *thread -- timer thread, argument is the bgp instance.
+ * RETURNS:
+ *   0
+ */
+static int
+bgp_nht_eval_timer (struct thread *thread)
+{
+  struct bgp *bgp = THREAD_ARG (thread);
+  struct bgp_nexthop_cache *bnc;
+  unsigned int count = 0;
+
+  bgp->t_nht_eval = NULL;
+
+  /* A path's node is only queued once for bgp_process() however many of
+   * the nexthops below touch it (BGP_NODE_PROCESS_SCHEDULED), so a burst
+   * of IGP changes costs one best-path run per affected prefix. */
+  while ((bnc = TAILQ_FIRST (&bgp->nht_eval_queue)) != NULL)
+    {
+      TAILQ_REMOVE (&bgp->nht_eval_queue, bnc, eval_entry);
+      UNSET_FLAG (bnc->flags, BGP_NEXTHOP_EVAL_PENDING);
+      evaluate_paths (bnc);
+      count++;
+    }
+
+  if (BGP_DEBUG(nht, NHT))
+    zlog_debug("%s: evaluated %u nexthop(s)", __FUNCTION__, count);
+
+  return 0;
+}
+
+/**
+ * schedule_evaluate_paths - Queue a nexthop for path evaluation. Updates
+ *   arriving within BGP_NHT_EVAL_HOLD_MSEC of each other are handled in a
+ *   single pass, and repeated updates for the same nexthop are coalesced.
+ * ARGUMENTS:
+ *   struct bgp_nexthop_cache *bnc -- the nexthop structure.
+ * RETURNS:
+ *   void.
+ */
+static void
+schedule_evaluate_paths (struct bgp_nexthop_cache *bnc)
+{
+  struct bgp *bgp = bnc->bgp;
+
+  if (!CHECK_FLAG (bnc->flags, BGP_NEXTHOP_EVAL_PENDING))
+    {
+      SET_FLAG (bnc->flags, BGP_NEXTHOP_EVAL_PENDING);
+      TAILQ_INSERT_TAIL (&bgp->nht_eval_queue, bnc, eval_entry);
+    }
+
+  THREAD_TIMER_MSEC_ON (bm->master, bgp->t_nht_eval, bgp_nht_eval_timer,
+                        bgp, BGP_NHT_EVAL_HOLD_MSEC);
+}
+
 /**
  * path_nh_map - make or break path-to-nexthop association.
  * ARGUMENTS:
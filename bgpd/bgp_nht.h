@@ -67,4 +67,12 @@ void bgp_unlink_nexthop_by_peer (struct peer *);
  */
 extern void bgp_delete_connected_nexthop (afi_t afi, struct peer *peer);
 
+/**
+ * bgp_nht_register_nexthops() - Register with zebra all nexthops of the
+ * instance that are not registered yet.
+ * ARGUMENTS:
+ *   bgp - BGP instance
+ */
+extern void bgp_nht_register_nexthops (struct bgp *bgp);
+
 #endif /* _BGP_NHT_H */
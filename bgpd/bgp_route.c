@@ -87,7 +87,7 @@ bgp_afi_node_get (struct bgp_table *table, afi_t afi, safi_t safi, struct prefix
   
   if ((safi == SAFI_MPLS_VPN) || (safi == SAFI_ENCAP) || (safi == SAFI_EVPN))
     {
-      prn = bgp_node_get (table, (struct prefix *) prd);
+      prn = bgp_rd_node_get (table, prd);
 
       if (prn->info == NULL)
 	prn->info = bgp_table_init (afi, safi);
@@ -116,7 +116,7 @@ bgp_afi_node_lookup (struct bgp_table *table, afi_t afi, safi_t safi, struct pre
   
   if ((safi == SAFI_MPLS_VPN) || (safi == SAFI_ENCAP) || (safi == SAFI_EVPN))
     {
-      prn = bgp_node_lookup (table, (struct prefix *) prd);
+      prn = bgp_rd_node_lookup (table, prd);
       if (!prn)
         return NULL;
 
@@ -2291,7 +2291,7 @@ bgp_rib_withdraw (struct bgp_node *rn, struct bgp_info *ri, struct peer *peer,
 	struct bgp_node		*prn = NULL;
 	struct bgp_table	*table = NULL;
 
-	prn = bgp_node_get(peer->bgp->rib[afi][safi], (struct prefix *) prd);
+	prn = bgp_rd_node_get(peer->bgp->rib[afi][safi], prd);
 	if (prn->info) {
 	    table = (struct bgp_table *)(prn->info);
 
@@ -2623,7 +2623,7 @@ bgp_update (struct peer *peer, struct prefix *p, u_int32_t addpath_id,
 	struct bgp_node		*prn = NULL;
 	struct bgp_table	*table = NULL;
 
-	prn = bgp_node_get(bgp->rib[afi][safi], (struct prefix *) prd);
+	prn = bgp_rd_node_get(bgp->rib[afi][safi], prd);
 	if (prn->info) {
 	    table = (struct bgp_table *)(prn->info);
 
@@ -2745,7 +2745,7 @@ bgp_update (struct peer *peer, struct prefix *p, u_int32_t addpath_id,
           struct bgp_node		*prn = NULL;
           struct bgp_table	*table = NULL;
 
-          prn = bgp_node_get(bgp->rib[afi][safi], (struct prefix *) prd);
+          prn = bgp_rd_node_get(bgp->rib[afi][safi], prd);
           if (prn->info) 
             {
               table = (struct bgp_table *)(prn->info);
@@ -2847,7 +2847,7 @@ bgp_update (struct peer *peer, struct prefix *p, u_int32_t addpath_id,
       struct bgp_node		*prn = NULL;
       struct bgp_table	*table = NULL;
     
-      prn = bgp_node_get(bgp->rib[afi][safi], (struct prefix *) prd);
+      prn = bgp_rd_node_get(bgp->rib[afi][safi], prd);
       if (prn->info) 
         {
           table = (struct bgp_table *)(prn->info);
@@ -4474,8 +4474,7 @@ bgp_static_set_safi (safi_t safi, struct vty *vty, const char *ip_str,
       return CMD_WARNING;
     }
 
-  prn = bgp_node_get (bgp->route[AFI_IP][safi],
-			(struct prefix *)&prd);
+  prn = bgp_rd_node_get (bgp->route[AFI_IP][safi], &prd);
   if (prn->info == NULL)
     prn->info = bgp_table_init (AFI_IP, safi);
   else
@@ -4556,8 +4555,7 @@ bgp_static_unset_safi(safi_t safi, struct vty *vty, const char *ip_str,
       return CMD_WARNING;
     }
 
-  prn = bgp_node_get (bgp->route[AFI_IP][safi],
-			(struct prefix *)&prd);
+  prn = bgp_rd_node_get (bgp->route[AFI_IP][safi], &prd);
   if (prn->info == NULL)
     prn->info = bgp_table_init (AFI_IP, safi);
   else
@@ -0,0 +1,745 @@
+/* BGP RIB snapshot for warm restart
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/*
+ * On a clean shutdown bgpd can write the paths it learnt from its peers
+ * to a compact file.  On the next start the file is mapped and the paths
+ * are installed as stale routes of the configured peers, exactly as if
+ * those peers had gone through a graceful restart.  The usual GR handling
+ * then replaces them as the peers resend their tables and flushes
+ * whatever is left on End-of-RIB or when the stalepath timer fires.
+ */
+
+#include <zebra.h>
+#include <sys/mman.h>
+
+#include "log.h"
+#include "vty.h"
+#include "stream.h"
+#include "sockunion.h"
+#include "prefix.h"
+#include "thread.h"
+#include "linklist.h"
+#include "hash.h"
+#include "memory.h"
+#include "network.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_table.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_community.h"
+#include "bgpd/bgp_ecommunity.h"
+#include "bgpd/bgp_fsm.h"
+#include "bgpd/bgp_nht.h"
+#include "bgpd/bgp_debug.h"
+#include "bgpd/bgp_snapshot.h"
+
+/* Large enough for any one path: attributes of a received path fit in
+ * a single UPDATE. */
+#define BGP_SNAPSHOT_RECORD_MAX (BGP_MAX_PACKET_SIZE * 2)
+
+struct bgp_snapshot_peer
+{
+  struct peer *peer;
+  u_int16_t index;
+};
+
+static unsigned int
+bgp_snapshot_peer_key (void *arg)
+{
+  struct bgp_snapshot_peer *sp = arg;
+
+  return (unsigned int) ((uintptr_t) sp->peer >> 4);
+}
+
+static int
+bgp_snapshot_peer_cmp (const void *arg1, const void *arg2)
+{
+  const struct bgp_snapshot_peer *sp1 = arg1;
+  const struct bgp_snapshot_peer *sp2 = arg2;
+
+  return sp1->peer == sp2->peer;
+}
+
+static void *
+bgp_snapshot_peer_alloc (void *arg)
+{
+  struct bgp_snapshot_peer *sp;
+
+  sp = XMALLOC (MTYPE_TMP, sizeof (struct bgp_snapshot_peer));
+  *sp = *(struct bgp_snapshot_peer *) arg;
+  return sp;
+}
+
+static void
+bgp_snapshot_peer_free (void *arg)
+{
+  XFREE (MTYPE_TMP, arg);
+}
+
+static int
+bgp_snapshot_write (int fd, struct stream *s)
+{
+  size_t len = stream_get_endp (s);
+  u_char *p = STREAM_DATA (s);
+  ssize_t n;
+
+  while (len)
+    {
+      n = write (fd, p, len);
+      if (n < 0)
+        {
+          if (ERRNO_IO_RETRY (errno))
+            continue;
+          return -1;
+        }
+      p += n;
+      len -= n;
+    }
+  stream_reset (s);
+  return 0;
+}
+
+/* Peers whose paths are worth keeping across a restart. */
+static int
+bgp_snapshot_peer_eligible (struct peer *peer)
+{
+  if (CHECK_FLAG (peer->sflags, PEER_STATUS_GROUP)
+      || peer_dynamic_neighbor (peer)
+      || peer->conf_if)
+    return 0;
+
+  return (peer->su.sa.sa_family == AF_INET
+          || peer->su.sa.sa_family == AF_INET6);
+}
+
+static void
+bgp_snapshot_put_route (struct stream *s, u_int16_t index, afi_t afi,
+                        safi_t safi, struct bgp_node *rn, struct bgp_info *ri)
+{
+  struct attr *attr = ri->attr;
+  struct attr_extra *ae = attr->extra;
+  size_t start, lenp;
+
+  start = stream_get_endp (s);
+  stream_putw (s, 0);
+
+  stream_putw (s, index);
+  stream_putw (s, afi);
+  stream_putc (s, safi);
+  stream_putc (s, rn->p.prefixlen);
+  stream_put (s, &rn->p.u.prefix, PSIZE (rn->p.prefixlen));
+
+  stream_putl (s, attr->flag);
+  stream_putc (s, attr->origin);
+  stream_putl (s, attr->med);
+  stream_putl (s, attr->local_pref);
+  stream_put_in_addr (s, &attr->nexthop);
+
+  if (ae && afi == AFI_IP6
+      && (ae->mp_nexthop_len == BGP_ATTR_NHLEN_IPV6_GLOBAL
+          || ae->mp_nexthop_len == BGP_ATTR_NHLEN_IPV6_GLOBAL_AND_LL))
+    {
+      stream_putc (s, ae->mp_nexthop_len);
+      stream_put (s, &ae->mp_nexthop_global, IPV6_MAX_BYTELEN);
+      if (ae->mp_nexthop_len == BGP_ATTR_NHLEN_IPV6_GLOBAL_AND_LL)
+        stream_put (s, &ae->mp_nexthop_local, IPV6_MAX_BYTELEN);
+    }
+  else
+    stream_putc (s, 0);
+
+  stream_putl (s, ae ? ae->weight : 0);
+  stream_put_in_addr (s, ae ? &ae->originator_id : &attr->nexthop);
+  stream_putl (s, ae ? ae->aggregator_as : 0);
+  stream_put_in_addr (s, ae ? &ae->aggregator_addr : &attr->nexthop);
+
+  if (ae && ae->cluster)
+    {
+      stream_putw (s, ae->cluster->length);
+      stream_put (s, ae->cluster->list, ae->cluster->length);
+    }
+  else
+    stream_putw (s, 0);
+
+  lenp = stream_get_endp (s);
+  stream_putw (s, 0);
+  if (attr->aspath)
+    stream_putw_at (s, lenp, aspath_put (s, attr->aspath, 1));
+
+  if (attr->community)
+    {
+      stream_putw (s, attr->community->size * 4);
+      stream_put (s, attr->community->val, attr->community->size * 4);
+    }
+  else
+    stream_putw (s, 0);
+
+  if (ae && ae->ecommunity)
+    {
+      stream_putw (s, ae->ecommunity->size * ECOMMUNITY_SIZE);
+      stream_put (s, ae->ecommunity->val,
+                  ae->ecommunity->size * ECOMMUNITY_SIZE);
+    }
+  else
+    stream_putw (s, 0);
+
+  stream_putw_at (s, start, stream_get_endp (s) - start - 2);
+}
+
+/* Write the paths learnt from peers of this instance to the snapshot
+ * file.  Written to a temporary file and renamed, so that a crash while
+ * saving never leaves a truncated snapshot behind. */
+int
+bgp_snapshot_save (struct bgp *bgp)
+{
+  struct hash *peers;
+  struct bgp_snapshot_peer lookup, *sp;
+  struct listnode *node;
+  struct peer *peer;
+  struct stream *s;
+  struct bgp_node *rn;
+  struct bgp_info *ri;
+  char tmpfile[MAXPATHLEN];
+  u_int16_t npeers = 0;
+  u_int32_t nroutes = 0;
+  afi_t afi;
+  int fd;
+
+  if (!bgp->snapshot_file)
+    return 0;
+
+  snprintf (tmpfile, sizeof (tmpfile), "%s.tmp", bgp->snapshot_file);
+  fd = open (tmpfile, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  if (fd < 0)
+    {
+      zlog_err ("%s: can't open %s: %s", __func__, tmpfile,
+                safe_strerror (errno));
+      return -1;
+    }
+
+  s = stream_new (BGP_SNAPSHOT_RECORD_MAX * 4);
+  peers = hash_create (bgp_snapshot_peer_key, bgp_snapshot_peer_cmp);
+
+  /* Header, counts are filled in once known. */
+  stream_putl (s, BGP_SNAPSHOT_MAGIC);
+  stream_putw (s, BGP_SNAPSHOT_VERSION);
+  stream_putw (s, 0);
+  stream_putl (s, 0);
+
+  for (ALL_LIST_ELEMENTS_RO (bgp->peer, node, peer))
+    {
+      if (!bgp_snapshot_peer_eligible (peer) || npeers == UINT16_MAX)
+        continue;
+
+      lookup.peer = peer;
+      lookup.index = npeers++;
+      hash_get (peers, &lookup, bgp_snapshot_peer_alloc);
+
+      if (peer->su.sa.sa_family == AF_INET)
+        {
+          stream_putc (s, AFI_IP);
+          stream_put_in_addr (s, &peer->su.sin.sin_addr);
+        }
+      else
+        {
+          stream_putc (s, AFI_IP6);
+          stream_put (s, &peer->su.sin6.sin6_addr, IPV6_MAX_BYTELEN);
+        }
+
+      if (STREAM_WRITEABLE (s) < BGP_SNAPSHOT_RECORD_MAX
+          && bgp_snapshot_write (fd, s) < 0)
+        goto write_error;
+    }
+
+  for (afi = AFI_IP; afi <= AFI_IP6; afi++)
+    for (rn = bgp_table_top (bgp->rib[afi][SAFI_UNICAST]); rn;
+         rn = bgp_route_next (rn))
+      for (ri = rn->info; ri; ri = ri->next)
+        {
+          if (ri->type != ZEBRA_ROUTE_BGP
+              || ri->sub_type != BGP_ROUTE_NORMAL
+              || CHECK_FLAG (ri->flags, BGP_INFO_REMOVED | BGP_INFO_HISTORY))
+            continue;
+
+          lookup.peer = ri->peer;
+          sp = hash_lookup (peers, &lookup);
+          if (!sp)
+            continue;
+
+          bgp_snapshot_put_route (s, sp->index, afi, SAFI_UNICAST, rn, ri);
+          nroutes++;
+
+          if (STREAM_WRITEABLE (s) < BGP_SNAPSHOT_RECORD_MAX
+              && bgp_snapshot_write (fd, s) < 0)
+            {
+              bgp_unlock_node (rn);
+              goto write_error;
+            }
+        }
+
+  if (bgp_snapshot_write (fd, s) < 0)
+    goto write_error;
+
+  /* Now that the counts are known, rewrite the header in place. */
+  stream_putl (s, BGP_SNAPSHOT_MAGIC);
+  stream_putw (s, BGP_SNAPSHOT_VERSION);
+  stream_putw (s, npeers);
+  stream_putl (s, nroutes);
+  if (lseek (fd, 0, SEEK_SET) < 0 || bgp_snapshot_write (fd, s) < 0)
+    goto write_error;
+
+  /* On disk before it takes the real name, or a crash could leave an
+   * empty file there. */
+  if (fsync (fd) < 0)
+    goto write_error;
+
+  close (fd);
+  stream_free (s);
+  hash_clean (peers, bgp_snapshot_peer_free);
+  hash_free (peers);
+
+  if (rename (tmpfile, bgp->snapshot_file) < 0)
+    {
+      zlog_err ("%s: can't rename %s to %s: %s", __func__, tmpfile,
+                bgp->snapshot_file, safe_strerror (errno));
+      unlink (tmpfile);
+      return -1;
+    }
+
+  zlog_info ("Saved %u paths from %u peers to RIB snapshot %s",
+             nroutes, npeers, bgp->snapshot_file);
+  return 0;
+
+write_error:
+  zlog_err ("%s: write to %s failed: %s", __func__, tmpfile,
+            safe_strerror (errno));
+  close (fd);
+  unlink (tmpfile);
+  stream_free (s);
+  hash_clean (peers, bgp_snapshot_peer_free);
+  hash_free (peers);
+  return -1;
+}
+
+/* Install one path from the record in 's' as a stale route, counting it
+ * against its peer in 'restored'.  The record must start at the beginning
+ * of the stream.  Returns 1 if the route was installed, 0 if it was
+ * skipped and -1 if the record is malformed. */
+static int
+bgp_snapshot_get_route (struct bgp *bgp, struct stream *s,
+                        struct peer **peers, u_int32_t *restored,
+                        u_int16_t npeers)
+{
+  struct attr attr;
+  struct attr_extra extra;
+  struct attr *attr_new;
+  struct prefix p;
+  struct peer *peer;
+  struct bgp_node *rn;
+  struct bgp_info *ri, *new;
+  u_int16_t index;
+  u_int16_t len;
+  size_t need;
+  afi_t afi;
+  safi_t safi;
+  u_int32_t flag;
+  int connected;
+
+  /* The record must hold its fixed part, plus whatever optional part
+   * each field read says follows. */
+  need = BGP_SNAPSHOT_ROUTE_FIXED_SIZE;
+  if (stream_get_endp (s) < need)
+    return -1;
+
+  index = stream_getw (s);
+  afi = stream_getw (s);
+  safi = stream_getc (s);
+
+  memset (&p, 0, sizeof (struct prefix));
+  p.prefixlen = stream_getc (s);
+  if (afi == AFI_IP)
+    {
+      p.family = AF_INET;
+      if (p.prefixlen > IPV4_MAX_BITLEN)
+        return -1;
+    }
+  else if (afi == AFI_IP6)
+    {
+      p.family = AF_INET6;
+      if (p.prefixlen > IPV6_MAX_BITLEN)
+        return -1;
+    }
+  else
+    return -1;
+  if (index >= npeers || safi != SAFI_UNICAST)
+    return -1;
+
+  need += PSIZE (p.prefixlen);
+  if (stream_get_endp (s) < need)
+    return -1;
+  stream_get (&p.u.prefix, s, PSIZE (p.prefixlen));
+
+  memset (&attr, 0, sizeof (struct attr));
+  memset (&extra, 0, sizeof (struct attr_extra));
+  attr.extra = &extra;
+
+  flag = stream_getl (s);
+  attr.origin = stream_getc (s);
+  attr.med = stream_getl (s);
+  attr.local_pref = stream_getl (s);
+  attr.nexthop.s_addr = stream_get_ipv4 (s);
+
+  extra.mp_nexthop_len = stream_getc (s);
+  if (extra.mp_nexthop_len == BGP_ATTR_NHLEN_IPV6_GLOBAL
+      || extra.mp_nexthop_len == BGP_ATTR_NHLEN_IPV6_GLOBAL_AND_LL)
+    {
+      need += IPV6_MAX_BYTELEN;
+      if (stream_get_endp (s) < need)
+        return -1;
+      stream_get (&extra.mp_nexthop_global, s, IPV6_MAX_BYTELEN);
+
+      if (extra.mp_nexthop_len == BGP_ATTR_NHLEN_IPV6_GLOBAL_AND_LL)
+        {
+          need += IPV6_MAX_BYTELEN;
+          if (stream_get_endp (s) < need)
+            return -1;
+          stream_get (&extra.mp_nexthop_local, s, IPV6_MAX_BYTELEN);
+        }
+    }
+  else if (extra.mp_nexthop_len != 0)
+    return -1;
+
+  extra.weight = stream_getl (s);
+  extra.originator_id.s_addr = stream_get_ipv4 (s);
+  extra.aggregator_as = stream_getl (s);
+  extra.aggregator_addr.s_addr = stream_get_ipv4 (s);
+
+  len = stream_getw (s);
+  need += len;
+  if (stream_get_endp (s) < need || len % 4)
+    return -1;
+  if (len)
+    {
+      extra.cluster = cluster_parse ((struct in_addr *) stream_pnt (s), len);
+      stream_forward_getp (s, len);
+    }
+
+  len = stream_getw (s);
+  need += len;
+  if (stream_get_endp (s) < need)
+    goto malformed;
+  attr.aspath = aspath_parse (s, len, 1);
+  if (!attr.aspath)
+    goto malformed;
+
+  len = stream_getw (s);
+  need += len;
+  if (stream_get_endp (s) < need)
+    goto malformed;
+  if (len)
+    {
+      attr.community = community_parse ((u_int32_t *) stream_pnt (s), len);
+      stream_forward_getp (s, len);
+      if (!attr.community)
+        goto malformed;
+    }
+
+  len = stream_getw (s);
+  need += len;
+  if (stream_get_endp (s) < need)
+    goto malformed;
+  if (len)
+    {
+      extra.ecommunity = ecommunity_parse (stream_pnt (s), len);
+      stream_forward_getp (s, len);
+      if (!extra.ecommunity)
+        goto malformed;
+    }
+
+  /* Only claim the attributes that were actually restored: anything else
+   * in the saved flags (AS4_*, encap, ...) has no data behind it here. */
+  attr.flag = flag & (ATTR_FLAG_BIT (BGP_ATTR_ORIGIN)
+                      | ATTR_FLAG_BIT (BGP_ATTR_NEXT_HOP)
+                      | ATTR_FLAG_BIT (BGP_ATTR_MULTI_EXIT_DISC)
+                      | ATTR_FLAG_BIT (BGP_ATTR_LOCAL_PREF)
+                      | ATTR_FLAG_BIT (BGP_ATTR_ATOMIC_AGGREGATE)
+                      | ATTR_FLAG_BIT (BGP_ATTR_AGGREGATOR)
+                      | ATTR_FLAG_BIT (BGP_ATTR_ORIGINATOR_ID));
+  attr.flag |= ATTR_FLAG_BIT (BGP_ATTR_AS_PATH);
+  if (attr.community)
+    attr.flag |= ATTR_FLAG_BIT (BGP_ATTR_COMMUNITIES);
+  if (extra.ecommunity)
+    attr.flag |= ATTR_FLAG_BIT (BGP_ATTR_EXT_COMMUNITIES);
+  if (extra.cluster)
+    attr.flag |= ATTR_FLAG_BIT (BGP_ATTR_CLUSTER_LIST);
+  if (extra.mp_nexthop_len)
+    attr.flag |= ATTR_FLAG_BIT (BGP_ATTR_MP_REACH_NLRI);
+
+  /* The peer is no longer configured, or no longer for this AFI. */
+  peer = peers[index];
+  if (!peer || !peer->afc[afi][safi])
+    {
+      bgp_attr_unintern_sub (&attr);
+      return 0;
+    }
+
+  rn = bgp_afi_node_get (bgp->rib[afi][safi], afi, safi, &p, NULL);
+
+  /* Already known, e.g. the same snapshot was loaded twice. */
+  for (ri = rn->info; ri; ri = ri->next)
+    if (ri->peer == peer && ri->type == ZEBRA_ROUTE_BGP
+        && ri->sub_type == BGP_ROUTE_NORMAL)
+      break;
+  if (ri)
+    {
+      bgp_unlock_node (rn);
+      bgp_attr_unintern_sub (&attr);
+      return 0;
+    }
+
+  attr_new = bgp_attr_intern (&attr);
+  bgp_attr_unintern_sub (&attr);
+
+  new = info_make (ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, 0, peer, attr_new, rn);
+  SET_FLAG (new->flags, BGP_INFO_STALE);
+
+  if (peer->sort == BGP_PEER_EBGP && peer->ttl == 1
+      && ! CHECK_FLAG (peer->flags, PEER_FLAG_DISABLE_CONNECTED_CHECK)
+      && ! bgp_flag_check (bgp, BGP_FLAG_DISABLE_NH_CONNECTED_CHK))
+    connected = 1;
+  else
+    connected = 0;
+
+  if (bgp_find_or_add_nexthop (bgp, afi, new, NULL, connected))
+    bgp_info_set_flag (rn, new, BGP_INFO_VALID);
+  else
+    bgp_info_unset_flag (rn, new, BGP_INFO_VALID);
+
+  bgp_aggregate_increment (bgp, &p, new, afi, safi);
+  bgp_info_add (rn, new);
+  bgp_unlock_node (rn);
+
+  bgp_process (bgp, rn, afi, safi);
+  restored[index]++;
+  return 1;
+
+malformed:
+  bgp_attr_unintern_sub (&attr);
+  return -1;
+}
+
+/* Load a snapshot written by bgp_snapshot_save().  The file is consumed:
+ * it is moved aside before it is parsed and removed once loaded, so that
+ * only a snapshot from the last clean shutdown is ever used, and a bad
+ * one at most once. */
+int
+bgp_snapshot_load (struct bgp *bgp)
+{
+  struct stat st;
+  struct stream *s;
+  struct peer **peers;
+  u_int32_t *restored;
+  union sockunion su;
+  struct timeval start, end;
+  u_char *map, *pnt, *lim;
+  u_int16_t npeers, i, len;
+  u_int32_t nroutes, count = 0, installed = 0;
+  char loadfile[MAXPATHLEN];
+  afi_t afi;
+  safi_t safi;
+  int fd, ret;
+
+  if (!bgp->snapshot_file)
+    return 0;
+
+  snprintf (loadfile, sizeof (loadfile), "%s.load", bgp->snapshot_file);
+  if (rename (bgp->snapshot_file, loadfile) < 0)
+    {
+      if (errno != ENOENT)
+        zlog_warn ("%s: can't rename %s to %s: %s", __func__,
+                   bgp->snapshot_file, loadfile, safe_strerror (errno));
+      return 0;
+    }
+
+  fd = open (loadfile, O_RDONLY);
+  if (fd < 0)
+    {
+      zlog_warn ("%s: can't open %s: %s", __func__, loadfile,
+                 safe_strerror (errno));
+      unlink (loadfile);
+      return -1;
+    }
+
+  if (fstat (fd, &st) < 0 || st.st_size < BGP_SNAPSHOT_HEADER_SIZE)
+    {
+      zlog_warn ("%s: %s is not a RIB snapshot", __func__,
+                 bgp->snapshot_file);
+      close (fd);
+      unlink (loadfile);
+      return -1;
+    }
+
+  map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    {
+      zlog_warn ("%s: can't map %s: %s", __func__, bgp->snapshot_file,
+                 safe_strerror (errno));
+      unlink (loadfile);
+      return -1;
+    }
+  madvise (map, st.st_size, MADV_SEQUENTIAL);
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+
+  s = stream_new (BGP_SNAPSHOT_RECORD_MAX);
+  stream_put (s, map, BGP_SNAPSHOT_HEADER_SIZE);
+  if (stream_getl (s) != BGP_SNAPSHOT_MAGIC
+      || stream_getw (s) != BGP_SNAPSHOT_VERSION)
+    {
+      zlog_warn ("%s: %s has an unknown format", __func__,
+                 bgp->snapshot_file);
+      stream_free (s);
+      munmap (map, st.st_size);
+      unlink (loadfile);
+      return -1;
+    }
+  npeers = stream_getw (s);
+  nroutes = stream_getl (s);
+
+  pnt = map + BGP_SNAPSHOT_HEADER_SIZE;
+  lim = map + st.st_size;
+
+  /* Resolve the peer table against the current configuration. */
+  peers = XCALLOC (MTYPE_TMP, sizeof (struct peer *) * (npeers + 1));
+  restored = XCALLOC (MTYPE_TMP, sizeof (u_int32_t) * (npeers + 1));
+  for (i = 0; i < npeers; i++)
+    {
+      memset (&su, 0, sizeof (union sockunion));
+      if (pnt < lim && *pnt == AFI_IP && pnt + 1 + IPV4_MAX_BYTELEN <= lim)
+        {
+          su.sin.sin_family = AF_INET;
+          memcpy (&su.sin.sin_addr, pnt + 1, IPV4_MAX_BYTELEN);
+          pnt += 1 + IPV4_MAX_BYTELEN;
+        }
+      else if (pnt < lim && *pnt == AFI_IP6
+               && pnt + 1 + IPV6_MAX_BYTELEN <= lim)
+        {
+          su.sin6.sin6_family = AF_INET6;
+          memcpy (&su.sin6.sin6_addr, pnt + 1, IPV6_MAX_BYTELEN);
+          pnt += 1 + IPV6_MAX_BYTELEN;
+        }
+      else
+        break;
+
+      peers[i] = peer_lookup (bgp, &su);
+    }
+
+  ret = (i == npeers) ? 0 : -1;
+
+  while (ret == 0 && count < nroutes && pnt + 2 <= lim)
+    {
+      len = (pnt[0] << 8) | pnt[1];
+      pnt += 2;
+      if (len > BGP_SNAPSHOT_RECORD_MAX || pnt + len > lim)
+        {
+          ret = -1;
+          break;
+        }
+
+      stream_reset (s);
+      stream_put (s, pnt, len);
+      pnt += len;
+      count++;
+
+      switch (bgp_snapshot_get_route (bgp, s, peers, restored, npeers))
+        {
+        case 1:
+          installed++;
+          break;
+        case 0:
+          break;
+        default:
+          ret = -1;
+          break;
+        }
+    }
+
+  /* Cut short between two records. */
+  if (count < nroutes)
+    ret = -1;
+
+  if (ret < 0)
+    zlog_warn ("%s: %s is truncated or corrupt after %u paths", __func__,
+               bgp->snapshot_file, count);
+
+  /* Treat every peer that had paths restored as a restarting GR peer:
+   * its stale paths go on End-of-RIB or when the stalepath timer fires. */
+  for (i = 0; i < npeers; i++)
+    {
+      struct peer *peer = peers[i];
+
+      if (!peer || !restored[i])
+        continue;
+
+      for (afi = AFI_IP; afi <= AFI_IP6; afi++)
+        {
+          safi = SAFI_UNICAST;
+          if (peer->afc[afi][safi])
+            peer->nsf[afi][safi] = 1;
+        }
+      bgp_graceful_stale_timer_start (peer);
+    }
+
+  stream_free (s);
+  XFREE (MTYPE_TMP, peers);
+  XFREE (MTYPE_TMP, restored);
+  munmap (map, st.st_size);
+  unlink (loadfile);
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &end);
+  zlog_info ("Restored %u of %u paths from RIB snapshot %s in %lu msecs",
+             installed, nroutes, bgp->snapshot_file,
+             timeval_elapsed (end, start) / 1000);
+
+  return ret;
+}
+
+void
+bgp_snapshot_save_all (void)
+{
+  struct listnode *node;
+  struct bgp *bgp;
+
+  for (ALL_LIST_ELEMENTS_RO (bm->bgp, node, bgp))
+    bgp_snapshot_save (bgp);
+}
+
+void
+bgp_snapshot_load_all (void)
+{
+  struct listnode *node;
+  struct bgp *bgp;
+
+  for (ALL_LIST_ELEMENTS_RO (bm->bgp, node, bgp))
+    bgp_snapshot_load (bgp);
+}
@@ -0,0 +1,52 @@
+/* BGP RIB snapshot for warm restart
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _QUAGGA_BGP_SNAPSHOT_H
+#define _QUAGGA_BGP_SNAPSHOT_H
+
+/* On-disk layout, all fields in network byte order:
+ *
+ *   header:  magic (4), version (2), peer count (2), route count (4)
+ *   peer:    afi (1), address (4 or 16)
+ *   route:   length (2), followed by 'length' octets of
+ *            peer index (2), afi (2), safi (1), prefixlen (1), prefix,
+ *            attribute flags (4), origin (1), med (4), local-pref (4),
+ *            nexthop (4), mp nexthop length (1), mp nexthops,
+ *            weight (4), originator-id (4),
+ *            aggregator AS (4), aggregator address (4),
+ *            cluster-list length (2), cluster-list,
+ *            as-path length (2), as-path (4-octet ASNs),
+ *            community length (2), communities,
+ *            ext-community length (2), ext-communities
+ */
+#define BGP_SNAPSHOT_MAGIC              0x51524942 /* "QRIB" */
+#define BGP_SNAPSHOT_VERSION            2
+#define BGP_SNAPSHOT_HEADER_SIZE        12
+
+/* Octets of a route record besides its prefix, its mp nexthops and the
+ * contents of its length-prefixed fields. */
+#define BGP_SNAPSHOT_ROUTE_FIXED_SIZE   48
+
+extern int bgp_snapshot_save (struct bgp *);
+extern int bgp_snapshot_load (struct bgp *);
+extern void bgp_snapshot_save_all (void);
+extern void bgp_snapshot_load_all (void);
+
+#endif /* _QUAGGA_BGP_SNAPSHOT_H */
@@ -26,6 +26,8 @@ Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
 #include "vty.h"
 #include "queue.h"
 #include "filter.h"
+#include "hash.h"
+#include "jhash.h"
 
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_table.h"
@@ -50,6 +52,12 @@ bgp_table_unlock (struct bgp_table *rt)
   route_table_finish (rt->route_table);
   rt->route_table = NULL;
 
+  if (rt->rd_index)
+    {
+      hash_free (rt->rd_index);
+      rt->rd_index = NULL;
+    }
+
   if (rt->owner)
     {
       peer_unlock (rt->owner);
@@ -88,7 +96,13 @@ bgp_node_destroy (route_table_delegate_t *delegate,
 		  struct route_table *table, struct route_node *node)
 {
   struct bgp_node *bgp_node;
+  struct bgp_table *rt = table->info;
+
   bgp_node = bgp_node_from_rnode (node);
+  /* Glue nodes are not in the index but may compare equal to an RD
+   * node, so only release the entry that is this node. */
+  if (rt && rt->rd_index && hash_lookup (rt->rd_index, bgp_node) == bgp_node)
+    hash_release (rt->rd_index, bgp_node);
   XFREE (MTYPE_BGP_NODE, bgp_node);
 }
 
@@ -124,3 +138,70 @@ bgp_table_init (afi_t afi, safi_t safi)
 
   return rt;
 }
+
+static unsigned int
+bgp_rd_node_hash_key (void *arg)
+{
+  struct bgp_node *rn = arg;
+
+  return jhash (rn->p.u.val, sizeof (rn->p.u.val), rn->p.prefixlen);
+}
+
+static int
+bgp_rd_node_hash_cmp (const void *arg1, const void *arg2)
+{
+  const struct bgp_node *rn1 = arg1;
+  const struct bgp_node *rn2 = arg2;
+
+  return (rn1->p.prefixlen == rn2->p.prefixlen
+          && !memcmp (rn1->p.u.val, rn2->p.u.val, sizeof (rn1->p.u.val)));
+}
+
+/*
+ * bgp_rd_node_lookup
+ *
+ * Equivalent of bgp_node_lookup() for the RD level of a two-level
+ * (MPLS-VPN, ENCAP, EVPN) table, using the RD index instead of a walk
+ * down the tree.  Returns the node locked, or NULL.
+ */
+struct bgp_node *
+bgp_rd_node_lookup (const struct bgp_table *table, struct prefix_rd *prd)
+{
+  struct bgp_node tmp;
+  struct bgp_node *rn;
+
+  if (!table->rd_index)
+    return NULL;
+
+  tmp.p.prefixlen = prd->prefixlen;
+  memcpy (tmp.p.u.val, prd->val, sizeof (tmp.p.u.val));
+  rn = hash_lookup (table->rd_index, &tmp);
+  if (rn)
+    bgp_lock_node (rn);
+  return rn;
+}
+
+/*
+ * bgp_rd_node_get
+ *
+ * Equivalent of bgp_node_get() for the RD level of a two-level table.
+ * Nodes created here are added to the RD index; all RD nodes must be
+ * created through this function for bgp_rd_node_lookup() to find them.
+ */
+struct bgp_node *
+bgp_rd_node_get (struct bgp_table *table, struct prefix_rd *prd)
+{
+  struct bgp_node *rn;
+
+  rn = bgp_rd_node_lookup (table, prd);
+  if (rn)
+    return rn;
+
+  if (!table->rd_index)
+    table->rd_index = hash_create (bgp_rd_node_hash_key,
+                                   bgp_rd_node_hash_cmp);
+
+  rn = bgp_node_get (table, (struct prefix *) prd);
+  hash_get (table->rd_index, rn, hash_alloc_intern);
+  return rn;
+}
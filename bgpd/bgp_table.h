@@ -36,6 +36,10 @@ struct bgp_table
 
   struct route_table *route_table;
   uint64_t version;
+
+  /* For the RD level of MPLS-VPN/ENCAP/EVPN tables: RD -> bgp_node,
+   * created on first use by bgp_rd_node_get(). */
+  struct hash *rd_index;
 };
 
 struct bgp_node
@@ -77,6 +81,10 @@ extern struct bgp_table *bgp_table_init (afi_t, safi_t);
 extern void bgp_table_lock (struct bgp_table *);
 extern void bgp_table_unlock (struct bgp_table *);
 extern void bgp_table_finish (struct bgp_table **);
+extern struct bgp_node *bgp_rd_node_get (struct bgp_table *,
+                                         struct prefix_rd *);
+extern struct bgp_node *bgp_rd_node_lookup (const struct bgp_table *,
+                                            struct prefix_rd *);
 
 
 /*
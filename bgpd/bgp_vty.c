@@ -1919,6 +1919,54 @@ ALIAS (no_bgp_graceful_restart_restart_time,
        "Set the time to wait to delete stale routes before a BGP open message is received\n"
        "Delay value (seconds)\n")
 
+DEFUN (bgp_graceful_restart_rib_snapshot,
+       bgp_graceful_restart_rib_snapshot_cmd,
+       "bgp graceful-restart rib-snapshot FILE",
+       "BGP specific commands\n"
+       "Graceful restart capability parameters\n"
+       "Save the RIB on shutdown and restore it as stale paths on startup\n"
+       "Snapshot file name\n")
+{
+  struct bgp *bgp;
+
+  bgp = vty->index;
+  if (! bgp)
+    return CMD_WARNING;
+
+  if (bgp->snapshot_file)
+    XFREE (MTYPE_BGP, bgp->snapshot_file);
+  bgp->snapshot_file = XSTRDUP (MTYPE_BGP, argv[0]);
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_bgp_graceful_restart_rib_snapshot,
+       no_bgp_graceful_restart_rib_snapshot_cmd,
+       "no bgp graceful-restart rib-snapshot",
+       NO_STR
+       "BGP specific commands\n"
+       "Graceful restart capability parameters\n"
+       "Save the RIB on shutdown and restore it as stale paths on startup\n")
+{
+  struct bgp *bgp;
+
+  bgp = vty->index;
+  if (! bgp)
+    return CMD_WARNING;
+
+  if (bgp->snapshot_file)
+    XFREE (MTYPE_BGP, bgp->snapshot_file);
+  return CMD_SUCCESS;
+}
+
+ALIAS (no_bgp_graceful_restart_rib_snapshot,
+       no_bgp_graceful_restart_rib_snapshot_val_cmd,
+       "no bgp graceful-restart rib-snapshot FILE",
+       NO_STR
+       "BGP specific commands\n"
+       "Graceful restart capability parameters\n"
+       "Save the RIB on shutdown and restore it as stale paths on startup\n"
+       "Snapshot file name\n")
+
 /* "bgp fast-external-failover" configuration. */
 DEFUN (bgp_fast_external_failover,
        bgp_fast_external_failover_cmd,
@@ -15572,6 +15620,9 @@ bgp_vty_init (void)
   install_element (BGP_NODE, &bgp_graceful_restart_restart_time_cmd);
   install_element (BGP_NODE, &no_bgp_graceful_restart_restart_time_cmd);
   install_element (BGP_NODE, &no_bgp_graceful_restart_restart_time_val_cmd);
+  install_element (BGP_NODE, &bgp_graceful_restart_rib_snapshot_cmd);
+  install_element (BGP_NODE, &no_bgp_graceful_restart_rib_snapshot_cmd);
+  install_element (BGP_NODE, &no_bgp_graceful_restart_rib_snapshot_val_cmd);
  
   /* "bgp fast-external-failover" commands */
   install_element (BGP_NODE, &bgp_fast_external_failover_cmd);
@@ -2086,6 +2086,10 @@ bgp_zebra_instance_register (struct bgp *bgp)
   /* Register for router-id, interfaces, redistributed routes. */
   zclient_send_reg_requests (zclient, bgp->vrf_id);
 
+  /* Nexthops tracked before zebra was reachable, e.g. those of paths
+   * restored from a RIB snapshot, were never registered. */
+  bgp_nht_register_nexthops (bgp);
+
   /* For default instance, register to learn about VNIs, if appropriate. */
   if (bgp->inst_type == BGP_INSTANCE_TYPE_DEFAULT
       && bgp->advertise_all_vni)
@@ -2937,6 +2937,8 @@ bgp_create (as_t *as, const char *name, enum bgp_instance_type inst_type)
   bgp->group = list_new ();
   bgp->group->cmp = (int (*)(void *, void *)) peer_group_cmp;
 
+  TAILQ_INIT (&bgp->nht_eval_queue);
+
   for (afi = AFI_IP; afi < AFI_MAX; afi++)
     for (safi = SAFI_UNICAST; safi < SAFI_MAX; safi++)
       {
@@ -3224,6 +3226,7 @@ bgp_delete (struct bgp *bgp)
       BGP_TIMER_OFF(bgp->t_rmap_def_originate_eval);
       bgp_unlock(bgp);  /* TODO - This timer is started with a lock - why? */
     }
+  BGP_TIMER_OFF (bgp->t_nht_eval);
 
   /* Inform peers we're going down. */
   for (ALL_LIST_ELEMENTS (bgp->peer, node, next, peer))
@@ -3347,6 +3350,8 @@ bgp_free (struct bgp *bgp)
 
   if (bgp->name)
     XFREE(MTYPE_BGP, bgp->name);
+  if (bgp->snapshot_file)
+    XFREE(MTYPE_BGP, bgp->snapshot_file);
   
   XFREE (MTYPE_BGP, bgp);
 }
@@ -7463,6 +7468,9 @@ bgp_config_write (struct vty *vty)
 		 bgp->restart_time, VTY_NEWLINE);
       if (bgp_flag_check (bgp, BGP_FLAG_GRACEFUL_RESTART))
        vty_out (vty, " bgp graceful-restart%s", VTY_NEWLINE);
+      if (bgp->snapshot_file)
+	vty_out (vty, " bgp graceful-restart rib-snapshot %s%s",
+		 bgp->snapshot_file, VTY_NEWLINE);
 
       /* BGP bestpath method. */
       if (bgp_flag_check (bgp, BGP_FLAG_ASPATH_IGNORE))
@@ -297,6 +297,11 @@ struct bgp
   /* Route table for import-check */
   struct bgp_table *import_check_table[AFI_MAX];
 
+  /* Nexthop cache entries with a zebra update awaiting path evaluation */
+  TAILQ_HEAD (, bgp_nexthop_cache) nht_eval_queue;
+  struct thread *t_nht_eval;
+#define BGP_NHT_EVAL_HOLD_MSEC 10
+
   struct bgp_table *connected_table[AFI_MAX];
 
   struct hash *address_hash;
@@ -339,6 +344,9 @@ struct bgp
   u_int32_t restart_time;
   u_int32_t stalepath_time;
 
+  /* File the RIB is saved to on shutdown and restored from on startup */
+  char *snapshot_file;
+
   /* Maximum-paths configuration */
   struct bgp_maxpaths_cfg {
     u_int16_t maxpaths_ebgp;
@@ -358,6 +366,10 @@ struct bgp
   int advertise_all_vni; /* Redistribute VNIs into BGP? */
   /* EVPN: import_rt_hash for auto/configured import route target */
   struct hash *import_rt_hash;
+  /* EVPN: VNIs with MACIP updates waiting to be sent to zebra */
+  TAILQ_HEAD (, bgpevpn) evpn_macip_queue;
+  struct thread *t_evpn_macip;
+#define BGP_EVPN_MACIP_HOLD_MSEC 10
 
 #if ENABLE_BGP_VNC
   struct rfapi_cfg *rfapi_cfg;
@@ -503,7 +503,7 @@ del_vnc_route (
           struct bgp_node *prn = NULL;
           struct bgp_table *table = NULL;
 
-          prn = bgp_node_get (bgp->rib[afi][safi], (struct prefix *) prd);
+          prn = bgp_rd_node_get (bgp->rib[afi][safi], prd);
           if (prn->info)
             {
               table = (struct bgp_table *) (prn->info);
@@ -1104,7 +1104,7 @@ add_vnc_route (
               struct bgp_node *prn = NULL;
               struct bgp_table *table = NULL;
 
-              prn = bgp_node_get (bgp->rib[afi][safi], (struct prefix *) prd);
+              prn = bgp_rd_node_get (bgp->rib[afi][safi], prd);
               if (prn->info)
                 {
                   table = (struct bgp_table *) (prn->info);
@@ -1130,7 +1130,7 @@ add_vnc_route (
               struct bgp_node *prn = NULL;
               struct bgp_table *table = NULL;
 
-              prn = bgp_node_get (bgp->rib[afi][safi], (struct prefix *) prd);
+              prn = bgp_rd_node_get (bgp->rib[afi][safi], prd);
               if (prn->info)
                 {
                   table = (struct bgp_table *) (prn->info);
@@ -1179,7 +1179,7 @@ add_vnc_route (
       struct bgp_node *prn = NULL;
       struct bgp_table *table = NULL;
 
-      prn = bgp_node_get (bgp->rib[afi][safi], (struct prefix *) prd);
+      prn = bgp_rd_node_get (bgp->rib[afi][safi], prd);
       if (prn->info)
         {
           table = (struct bgp_table *) (prn->info);
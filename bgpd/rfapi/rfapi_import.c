@@ -34,6 +34,9 @@
 #include "lib/log.h"
 #include "lib/skiplist.h"
 #include "lib/thread.h"
+#include "lib/hash.h"
+#include "lib/jhash.h"
+#include "lib/linklist.h"
 
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_ecommunity.h"
@@ -1038,6 +1041,7 @@ rfapiImportTableRefDelByIt (
         {
           h->imports = it->next;
         }
+      rfapiImportTableIndexDel (h, it);
       rfapiImportTableFlush (it);
       XFREE (MTYPE_RFAPI_IMPORTTABLE, it);
     }
@@ -4058,6 +4062,8 @@ rfapiProcessUpdate (
   struct bgp			*bgp;
   struct rfapi			*h;
   struct rfapi_import_table	*it;
+  struct list			*matched = NULL;
+  struct listnode		*node;
   int				has_ip_route = 1;
   uint32_t			lni = 0;
 
@@ -4129,24 +4135,31 @@ rfapiProcessUpdate (
     return;
 
   /*
-   * Iterate over all import tables; do a filtered import
-   * for the afi/safi combination
+   * Do a filtered import for the afi/safi combination into each
+   * import table whose RT list intersects the route's. Tables
+   * with no common RT would reject the update anyway.
    */
-  for (it = h->imports; it; it = it->next)
+  if (attr && attr->extra)
+    matched = rfapiImportTableIndexMatch (h, attr->extra->ecommunity);
+  if (matched)
     {
-      (*rfapiBgpInfoFilteredImportFunction (safi)) (
-	it,
-	FIF_ACTION_UPDATE,
-	peer,
-	rfd,
-	p,        /* prefix */
-	NULL,
-	afi,
-	prd,
-	attr,
-	type,
-	sub_type,
-	label);
+      for (ALL_LIST_ELEMENTS_RO (matched, node, it))
+        {
+          (*rfapiBgpInfoFilteredImportFunction (safi)) (
+	    it,
+	    FIF_ACTION_UPDATE,
+	    peer,
+	    rfd,
+	    p,        /* prefix */
+	    NULL,
+	    afi,
+	    prd,
+	    attr,
+	    type,
+	    sub_type,
+	    label);
+        }
+      list_delete (matched);
     }
 
   if (safi == SAFI_MPLS_VPN || safi == BGP_SAFI_VPN)
@@ -4584,6 +4597,8 @@ bgp_rfapi_destroy (struct bgp *bgp, struct rfapi *h)
       h->import_mac = NULL;
     }
 
+  rfapiImportTableIndexFree (h);
+
   work_queue_free (h->deferred_close_q);
 
   if (h->rfp != NULL)
@@ -4592,6 +4607,168 @@ bgp_rfapi_destroy (struct bgp *bgp, struct rfapi *h)
   XFREE (MTYPE_RFAPI, h);
 }
 
+/*
+ * Route-target index
+ *
+ * Maps each RT value appearing in an import table's rt_import_list
+ * to the list of import tables that import it, so that an update
+ * is offered only to tables whose import list it intersects instead
+ * of to every import table. MAC import tables and it_ce are not
+ * indexed; they are selected by LNI and match all RTs respectively.
+ */
+struct rfapi_rt_index_entry
+{
+  uint8_t	rt[ECOMMUNITY_SIZE];
+  struct list	*tables;	/* of struct rfapi_import_table */
+};
+
+static unsigned int
+rfapi_rt_index_key (void *arg)
+{
+  struct rfapi_rt_index_entry *e = arg;
+
+  return jhash (e->rt, ECOMMUNITY_SIZE, 0x5254);
+}
+
+static int
+rfapi_rt_index_cmp (const void *arg1, const void *arg2)
+{
+  const struct rfapi_rt_index_entry *e1 = arg1;
+  const struct rfapi_rt_index_entry *e2 = arg2;
+
+  return !memcmp (e1->rt, e2->rt, ECOMMUNITY_SIZE);
+}
+
+static void *
+rfapi_rt_index_alloc (void *arg)
+{
+  struct rfapi_rt_index_entry *e;
+
+  e = XCALLOC (MTYPE_RFAPI_RT_INDEX, sizeof (struct rfapi_rt_index_entry));
+  memcpy (e->rt, ((struct rfapi_rt_index_entry *) arg)->rt, ECOMMUNITY_SIZE);
+  e->tables = list_new ();
+  return e;
+}
+
+static void
+rfapi_rt_index_free (void *arg)
+{
+  struct rfapi_rt_index_entry *e = arg;
+
+  list_delete (e->tables);
+  XFREE (MTYPE_RFAPI_RT_INDEX, e);
+}
+
+void
+rfapiImportTableIndexAdd (struct rfapi *h, struct rfapi_import_table *it)
+{
+  struct rfapi_rt_index_entry key;
+  struct rfapi_rt_index_entry *e;
+  int i;
+
+  if (!it->rt_import_list)
+    return;
+
+  if (!h->rt_import_index)
+    h->rt_import_index = hash_create (rfapi_rt_index_key, rfapi_rt_index_cmp);
+
+  for (i = 0; i < it->rt_import_list->size; ++i)
+    {
+      memcpy (key.rt, it->rt_import_list->val + (i * ECOMMUNITY_SIZE),
+              ECOMMUNITY_SIZE);
+      e = hash_get (h->rt_import_index, &key, rfapi_rt_index_alloc);
+
+      /* an RT listed twice in one import list is indexed once */
+      if (!listnode_lookup (e->tables, it))
+        listnode_add (e->tables, it);
+    }
+}
+
+void
+rfapiImportTableIndexDel (struct rfapi *h, struct rfapi_import_table *it)
+{
+  struct rfapi_rt_index_entry key;
+  struct rfapi_rt_index_entry *e;
+  int i;
+
+  if (!it->rt_import_list || !h->rt_import_index)
+    return;
+
+  for (i = 0; i < it->rt_import_list->size; ++i)
+    {
+      memcpy (key.rt, it->rt_import_list->val + (i * ECOMMUNITY_SIZE),
+              ECOMMUNITY_SIZE);
+      e = hash_lookup (h->rt_import_index, &key);
+      if (!e)
+        continue;
+
+      listnode_delete (e->tables, it);
+      if (!listcount (e->tables))
+        {
+          hash_release (h->rt_import_index, e);
+          rfapi_rt_index_free (e);
+        }
+    }
+}
+
+void
+rfapiImportTableIndexFree (struct rfapi *h)
+{
+  if (!h->rt_import_index)
+    return;
+
+  hash_clean (h->rt_import_index, rfapi_rt_index_free);
+  hash_free (h->rt_import_index);
+  h->rt_import_index = NULL;
+}
+
+/*
+ * Return a list of the indexed import tables whose rt_import_list
+ * intersects ecom, each table at most once, or NULL if there are
+ * none. The caller frees the list with list_delete().
+ *
+ * A list is built rather than walking the index in place because
+ * importing a route can call back into the RFP, which may register
+ * routes and so re-enter rfapiProcessUpdate().
+ */
+struct list *
+rfapiImportTableIndexMatch (struct rfapi *h, struct ecommunity *ecom)
+{
+  struct rfapi_rt_index_entry key;
+  struct rfapi_rt_index_entry *e;
+  struct rfapi_import_table *it;
+  struct listnode *node;
+  struct list *matched = NULL;
+  int i;
+
+  if (!ecom || !h->rt_import_index)
+    return NULL;
+
+  /* stamp tables as they are collected to suppress duplicates */
+  if (++h->rt_index_gen == 0)
+    ++h->rt_index_gen;
+
+  for (i = 0; i < ecom->size; ++i)
+    {
+      memcpy (key.rt, ecom->val + (i * ECOMMUNITY_SIZE), ECOMMUNITY_SIZE);
+      e = hash_lookup (h->rt_import_index, &key);
+      if (!e)
+        continue;
+
+      for (ALL_LIST_ELEMENTS_RO (e->tables, node, it))
+        {
+          if (it->rt_index_gen == h->rt_index_gen)
+            continue;
+          it->rt_index_gen = h->rt_index_gen;
+
+          if (!matched)
+            matched = list_new ();
+          listnode_add (matched, it);
+        }
+    }
+  return matched;
+}
+
 struct rfapi_import_table *
 rfapiImportTableRefAdd (struct bgp *bgp, struct ecommunity *rt_import_list)
 {
@@ -4619,6 +4796,7 @@ rfapiImportTableRefAdd (struct bgp *bgp, struct ecommunity *rt_import_list)
       h->imports = it;
 
       it->rt_import_list = ecommunity_dup (rt_import_list);
+      rfapiImportTableIndexAdd (h, it);
       it->monitor_exterior_orphans =
         skiplist_new (0, NULL, (void (*)(void *)) prefix_free);
 
@@ -29,6 +29,9 @@
 
 #include "lib/thread.h"
 
+struct rfapi;
+struct list;
+
 /*
  * These are per-rt-import-list
  *
@@ -40,6 +43,7 @@ struct rfapi_import_table
   struct rfapi_import_table *next;
   struct ecommunity *rt_import_list;    /* copied from nve grp */
   int refcount;                 /* nve grps and nves */
+  uint32_t rt_index_gen;        /* dedup stamp for RT index matches */
   uint32_t l2_logical_net_id;   /* L2 only: EVPN Eth Seg Id */
   struct route_table *imported_vpn[AFI_MAX];
   struct rfapi_monitor_vpn *vpn0_queries[AFI_MAX];
@@ -96,6 +100,21 @@ rfapiImportTableRefDelByIt (
   struct bgp			*bgp,
   struct rfapi_import_table	*it_target);
 
+/*
+ * Route-target index of import tables (see rfapi_import.c)
+ */
+extern void
+rfapiImportTableIndexAdd (struct rfapi *h, struct rfapi_import_table *it);
+
+extern void
+rfapiImportTableIndexDel (struct rfapi *h, struct rfapi_import_table *it);
+
+extern void
+rfapiImportTableIndexFree (struct rfapi *h);
+
+extern struct list *
+rfapiImportTableIndexMatch (struct rfapi *h, struct ecommunity *ecom);
+
 
 /*
  * Construct an rfapi nexthop list based on the routes attached to
@@ -189,6 +189,14 @@ struct rfapi
 {
   struct route_table		un[AFI_MAX];
   struct rfapi_import_table	*imports;	/* IPv4, IPv6 */
+
+  /*
+   * Index of the tables on the imports list by route target.
+   * Hash keys are single RT values; each entry holds the list
+   * of import tables whose rt_import_list contains that RT.
+   */
+  struct hash			*rt_import_index;
+  uint32_t			rt_index_gen;
   struct list			descriptors;/* debug & resolve-nve imports */
 
   struct rfapi_global_stats	stat;
@@ -432,6 +440,7 @@ DECLARE_MTYPE(RFAPI_RFP_GROUP_CFG)
 DECLARE_MTYPE(RFAPI)
 DECLARE_MTYPE(RFAPI_DESC)
 DECLARE_MTYPE(RFAPI_IMPORTTABLE)
+DECLARE_MTYPE(RFAPI_RT_INDEX)
 DECLARE_MTYPE(RFAPI_MONITOR)
 DECLARE_MTYPE(RFAPI_MONITOR_ENCAP)
 DECLARE_MTYPE(RFAPI_NEXTHOP)
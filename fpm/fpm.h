@@ -85,6 +85,29 @@
  * If the connection to the FPM goes down for some reason, the client
  * (zebra) should send the FPM a complete copy of the forwarding
  * table(s) when it reconnects.
+ *
+ * With the netlink format, the following additions allow the two ends
+ * to avoid that full copy:
+ *
+ *  - Every route message carries a sequence number in nlmsg_seq,
+ *    which increases monotonically over the life of the zebra
+ *    process, and the pid of that process in nlmsg_pid.
+ *
+ *  - The FPM may acknowledge the messages it has applied by sending a
+ *    netlink NLMSG_ERROR message with error 0 and the sequence number
+ *    of the last message applied.
+ *
+ *  - After (re)connecting, the FPM may send an RTM_GETROUTE message
+ *    with nlmsg_pid and nlmsg_seq set to the last zebra message it
+ *    applied, or with nlmsg_seq 0 if it has no routes. Zebra then
+ *    sends only the routes that changed after that message if it can,
+ *    or a complete copy otherwise, and follows them with an NLMSG_DONE
+ *    message whose payload is FPM_RESYNC_INCREMENTAL or
+ *    FPM_RESYNC_FULL. After a full resync the FPM should discard
+ *    routes that were not refreshed by it.
+ *
+ *  - A single FPM message may carry several netlink messages, one
+ *    after the other.
  */
 
 /*
@@ -102,6 +125,12 @@
  */
 #define FPM_MAX_MSG_LEN 4096
 
+/*
+ * Payload of the NLMSG_DONE message that ends a resync.
+ */
+#define FPM_RESYNC_INCREMENTAL 0
+#define FPM_RESYNC_FULL 1
+
 #ifdef __SUNPRO_C
 #pragma pack(1)
 #endif
@@ -318,6 +318,12 @@ zclient_send_message(struct zclient *zclient)
 {
   if (zclient->sock < 0)
     return -1;
+  if (zclient->batch)
+    {
+      buffer_put(zclient->wb, STREAM_DATA(zclient->obuf),
+		 stream_get_endp(zclient->obuf));
+      return 0;
+    }
   switch (buffer_write(zclient->wb, zclient->sock, STREAM_DATA(zclient->obuf),
 		       stream_get_endp(zclient->obuf)))
     {
@@ -337,6 +343,39 @@ zclient_send_message(struct zclient *zclient)
   return 0;
 }
 
+void
+zclient_batch_begin (struct zclient *zclient)
+{
+  zclient->batch++;
+}
+
+int
+zclient_batch_end (struct zclient *zclient)
+{
+  assert (zclient->batch > 0);
+  if (--zclient->batch)
+    return 0;
+
+  /* A pending write thread flushes the queued messages with the rest. */
+  if (zclient->sock < 0 || zclient->t_write)
+    return 0;
+  switch (buffer_flush_available(zclient->wb, zclient->sock))
+    {
+    case BUFFER_ERROR:
+      zlog_warn("%s: buffer_flush_available failed on zclient fd %d, closing",
+		__func__, zclient->sock);
+      return zclient_failed(zclient);
+      break;
+    case BUFFER_PENDING:
+      zclient->t_write = thread_add_write(zclient->master, zclient_flush_data,
+					  zclient, zclient->sock);
+      break;
+    case BUFFER_EMPTY:
+      break;
+    }
+  return 0;
+}
+
 void
 zclient_create_header (struct stream *s, uint16_t command, vrf_id_t vrf_id)
 {
@@ -75,6 +75,10 @@ struct zclient
   /* Thread to write buffered data to zebra. */
   struct thread *t_write;
 
+  /* Messages are only queued on wb while batching, see
+     zclient_batch_begin(). */
+  int batch;
+
   /* Redistribute information. */
   u_char redist_default; /* clients protocol */
   u_short instance;
@@ -198,6 +202,11 @@ extern void zclient_redistribute_default (int command, struct zclient *,
    Returns 0 for success or -1 on an I/O error. */
 extern int zclient_send_message(struct zclient *);
 
+/* Between these, messages are queued rather than written, and then
+   written together by zclient_batch_end().  Calls may nest. */
+extern void zclient_batch_begin (struct zclient *);
+extern int zclient_batch_end (struct zclient *);
+
 /* create header for command, length to be filled in by user later */
 extern void zclient_create_header (struct stream *, uint16_t, vrf_id_t);
 extern int zclient_read_header (struct stream *s, int sock, u_int16_t *size,
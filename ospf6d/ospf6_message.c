@@ -1465,35 +1465,42 @@ ospf6_lsack_recv (struct in6_addr *src, struct in6_addr *dst,
   assert (p == OSPF6_MESSAGE_END (oh));
 }
 
-static u_char *recvbuf = NULL;
+static u_char *recvbuf[OSPF6_READ_BATCH];
 static u_char *sendbuf = NULL;
 static unsigned int iobuflen = 0;
 
 int
 ospf6_iobuf_size (unsigned int size)
 {
-  u_char *recvnew, *sendnew;
+  u_char *recvnew[OSPF6_READ_BATCH], *sendnew;
+  int i, fail = 0;
 
   if (size <= iobuflen)
     return iobuflen;
 
-  recvnew = XMALLOC (MTYPE_OSPF6_MESSAGE, size);
+  for (i = 0; i < OSPF6_READ_BATCH; i++)
+    if ((recvnew[i] = XMALLOC (MTYPE_OSPF6_MESSAGE, size)) == NULL)
+      fail = 1;
   sendnew = XMALLOC (MTYPE_OSPF6_MESSAGE, size);
-  if (recvnew == NULL || sendnew == NULL)
+  if (fail || sendnew == NULL)
     {
-      if (recvnew)
-        XFREE (MTYPE_OSPF6_MESSAGE, recvnew);
+      for (i = 0; i < OSPF6_READ_BATCH; i++)
+        if (recvnew[i])
+          XFREE (MTYPE_OSPF6_MESSAGE, recvnew[i]);
       if (sendnew)
         XFREE (MTYPE_OSPF6_MESSAGE, sendnew);
       zlog_debug ("Could not allocate I/O buffer of size %d.", size);
       return iobuflen;
     }
 
-  if (recvbuf)
-    XFREE (MTYPE_OSPF6_MESSAGE, recvbuf);
+  for (i = 0; i < OSPF6_READ_BATCH; i++)
+    {
+      if (recvbuf[i])
+        XFREE (MTYPE_OSPF6_MESSAGE, recvbuf[i]);
+      recvbuf[i] = recvnew[i];
+    }
   if (sendbuf)
     XFREE (MTYPE_OSPF6_MESSAGE, sendbuf);
-  recvbuf = recvnew;
   sendbuf = sendnew;
   iobuflen = size;
 
@@ -1503,11 +1510,14 @@ ospf6_iobuf_size (unsigned int size)
 void
 ospf6_message_terminate (void)
 {
-  if (recvbuf)
-    {
-      XFREE (MTYPE_OSPF6_MESSAGE, recvbuf);
-      recvbuf = NULL;
-    }
+  int i;
+
+  for (i = 0; i < OSPF6_READ_BATCH; i++)
+    if (recvbuf[i])
+      {
+        XFREE (MTYPE_OSPF6_MESSAGE, recvbuf[i]);
+        recvbuf[i] = NULL;
+      }
 
   if (sendbuf)
     {
@@ -1518,57 +1528,32 @@ ospf6_message_terminate (void)
   iobuflen = 0;
 }
 
-int
-ospf6_receive (struct thread *thread)
+/* Process a message read from the socket. */
+static void
+ospf6_receive_message (struct in6_addr *src, struct in6_addr *dst,
+                       ifindex_t ifindex, u_char *buf, unsigned int len)
 {
-  int sockfd;
-  unsigned int len;
   char srcname[64], dstname[64];
-  struct in6_addr src, dst;
-  ifindex_t ifindex;
-  struct iovec iovector[2];
   struct ospf6_interface *oi;
   struct ospf6_header *oh;
 
-  /* add next read thread */
-  sockfd = THREAD_FD (thread);
-  thread_add_read (master, ospf6_receive, NULL, sockfd);
-
-  /* initialize */
-  memset (&src, 0, sizeof (src));
-  memset (&dst, 0, sizeof (dst));
-  ifindex = 0;
-  memset (recvbuf, 0, iobuflen);
-  iovector[0].iov_base = recvbuf;
-  iovector[0].iov_len = iobuflen;
-  iovector[1].iov_base = NULL;
-  iovector[1].iov_len = 0;
-
-  /* receive message */
-  len = ospf6_recvmsg (&src, &dst, &ifindex, iovector);
-  if (len > iobuflen)
-    {
-      zlog_err ("Excess message read");
-      return 0;
-    }
-
   oi = ospf6_interface_lookup_by_ifindex (ifindex);
   if (oi == NULL || oi->area == NULL || CHECK_FLAG(oi->flag, OSPF6_INTERFACE_DISABLE))
     {
       zlog_debug ("Message received on disabled interface");
-      return 0;
+      return;
     }
   if (CHECK_FLAG (oi->flag, OSPF6_INTERFACE_PASSIVE))
     {
       if (IS_OSPF6_DEBUG_MESSAGE (OSPF6_MESSAGE_TYPE_UNKNOWN, RECV))
         zlog_debug ("%s: Ignore message on passive interface %s",
                     __func__, oi->interface->name);
-      return 0;
+      return;
     }
 
-  oh = (struct ospf6_header *) recvbuf;
+  oh = (struct ospf6_header *) buf;
   if (ospf6_rxpacket_examin (oi, oh, len) != MSG_OK)
-    return 0;
+    return;
 
   /* Being here means, that no sizing/alignment issues were detected in
      the input packet. This renders the additional checks performed below
@@ -1578,8 +1563,8 @@ ospf6_receive (struct thread *thread)
   /* Log */
   if (IS_OSPF6_DEBUG_MESSAGE (oh->type, RECV))
     {
-      inet_ntop (AF_INET6, &src, srcname, sizeof (srcname));
-      inet_ntop (AF_INET6, &dst, dstname, sizeof (dstname));
+      inet_ntop (AF_INET6, src, srcname, sizeof (srcname));
+      inet_ntop (AF_INET6, dst, dstname, sizeof (dstname));
       zlog_debug ("%s received on %s",
                  LOOKUP (ospf6_message_type_str, oh->type), oi->interface->name);
       zlog_debug ("    src: %s", srcname);
@@ -1610,28 +1595,75 @@ ospf6_receive (struct thread *thread)
   switch (oh->type)
     {
       case OSPF6_MESSAGE_TYPE_HELLO:
-        ospf6_hello_recv (&src, &dst, oi, oh);
+        ospf6_hello_recv (src, dst, oi, oh);
         break;
 
       case OSPF6_MESSAGE_TYPE_DBDESC:
-        ospf6_dbdesc_recv (&src, &dst, oi, oh);
+        ospf6_dbdesc_recv (src, dst, oi, oh);
         break;
 
       case OSPF6_MESSAGE_TYPE_LSREQ:
-        ospf6_lsreq_recv (&src, &dst, oi, oh);
+        ospf6_lsreq_recv (src, dst, oi, oh);
         break;
 
       case OSPF6_MESSAGE_TYPE_LSUPDATE:
-        ospf6_lsupdate_recv (&src, &dst, oi, oh);
+        ospf6_lsupdate_recv (src, dst, oi, oh);
         break;
 
       case OSPF6_MESSAGE_TYPE_LSACK:
-        ospf6_lsack_recv (&src, &dst, oi, oh);
+        ospf6_lsack_recv (src, dst, oi, oh);
         break;
 
       default:
         assert (0);
     }
+}
+
+int
+ospf6_receive (struct thread *thread)
+{
+  int sockfd;
+  int i, count;
+  int len[OSPF6_READ_BATCH];
+  struct in6_addr src[OSPF6_READ_BATCH], dst[OSPF6_READ_BATCH];
+  ifindex_t ifindex[OSPF6_READ_BATCH];
+  struct iovec iovector[OSPF6_READ_BATCH + 1];
+
+  /* add next read thread */
+  sockfd = THREAD_FD (thread);
+  thread_add_read (master, ospf6_receive, NULL, sockfd);
+
+  /* initialize */
+  memset (src, 0, sizeof (src));
+  memset (dst, 0, sizeof (dst));
+  memset (ifindex, 0, sizeof (ifindex));
+  for (i = 0; i < OSPF6_READ_BATCH; i++)
+    {
+      iovector[i].iov_base = recvbuf[i];
+      iovector[i].iov_len = iobuflen;
+    }
+  iovector[OSPF6_READ_BATCH].iov_base = NULL;
+  iovector[OSPF6_READ_BATCH].iov_len = 0;
+
+  /* receive message */
+#ifdef HAVE_RECVMMSG
+  count = ospf6_recvmmsg (src, dst, ifindex, iovector, len, OSPF6_READ_BATCH);
+#else
+  count = 1;
+  len[0] = ospf6_recvmsg (&src[0], &dst[0], &ifindex[0], iovector);
+#endif /* HAVE_RECVMMSG */
+
+  for (i = 0; i < count; i++)
+    {
+      if ((unsigned int) len[i] > iobuflen)
+        {
+          zlog_err ("Excess message read");
+          continue;
+        }
+
+      memset (recvbuf[i] + len[i], 0, iobuflen - len[i]);
+      ospf6_receive_message (&src[i], &dst[i], ifindex[i], recvbuf[i], len[i]);
+    }
 
   return 0;
 }
@@ -25,6 +25,7 @@
 #include "memory.h"
 #include "sockunion.h"
 #include "sockopt.h"
+#include "network.h"
 #include "privs.h"
 
 #include "libospf.h"
@@ -302,4 +303,72 @@ ospf6_recvmsg (struct in6_addr *src, struct in6_addr *dst,
   return retval;
 }
 
+#ifdef HAVE_RECVMMSG
+/* Read up to count messages in a single system call, each into its own
+   iovec of message.  The length of each is returned in len, and the
+   number read as the result. */
+int
+ospf6_recvmmsg (struct in6_addr *src, struct in6_addr *dst,
+                ifindex_t *ifindex, struct iovec *message, int *len,
+                int count)
+{
+  int i, retval;
+  struct mmsghdr rmsgs[OSPF6_READ_BATCH];
+  struct cmsghdr *rcmsgp;
+  u_char cmsgbuf[OSPF6_READ_BATCH][CMSG_SPACE(sizeof (struct in6_pktinfo))];
+  struct in6_pktinfo *pktinfo;
+  struct sockaddr_in6 src_sin6[OSPF6_READ_BATCH];
+
+  assert (count <= OSPF6_READ_BATCH);
+
+  memset (rmsgs, 0, sizeof (rmsgs));
+  memset (src_sin6, 0, sizeof (src_sin6));
+  for (i = 0; i < count; i++)
+    {
+      /* receive control msg */
+      rcmsgp = (struct cmsghdr *)cmsgbuf[i];
+      rcmsgp->cmsg_level = IPPROTO_IPV6;
+      rcmsgp->cmsg_type = IPV6_PKTINFO;
+      rcmsgp->cmsg_len = CMSG_LEN (sizeof (struct in6_pktinfo));
+
+      /* receive msg hdr */
+      rmsgs[i].msg_hdr.msg_iov = &message[i];
+      rmsgs[i].msg_hdr.msg_iovlen = 1;
+      rmsgs[i].msg_hdr.msg_name = (caddr_t) &src_sin6[i];
+      rmsgs[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_in6);
+      rmsgs[i].msg_hdr.msg_control = (caddr_t) cmsgbuf[i];
+      rmsgs[i].msg_hdr.msg_controllen = sizeof (cmsgbuf[i]);
+    }
+
+  /* The socket is readable, so at least one message is waiting; do not
+     block for the others. */
+  retval = recvmmsg (ospf6_sock, rmsgs, count, MSG_DONTWAIT, NULL);
+  if (retval < 0)
+    {
+      if (!ERRNO_IO_RETRY (errno))
+        zlog_warn ("recvmmsg failed: %s", safe_strerror (errno));
+      return retval;
+    }
+
+  for (i = 0; i < retval; i++)
+    {
+      len[i] = rmsgs[i].msg_len;
+      if (rmsgs[i].msg_len == message[i].iov_len)
+        zlog_warn ("recvmsg read full buffer size: %d", len[i]);
+
+      /* source address */
+      memcpy (&src[i], &src_sin6[i].sin6_addr, sizeof (struct in6_addr));
+
+      /* destination address */
+      pktinfo = (struct in6_pktinfo *)(CMSG_DATA((struct cmsghdr *)cmsgbuf[i]));
+      if (ifindex)
+        ifindex[i] = pktinfo->ipi6_ifindex;
+      if (dst)
+        memcpy (&dst[i], &pktinfo->ipi6_addr, sizeof (struct in6_addr));
+    }
+
+  return retval;
+}
+#endif /* HAVE_RECVMMSG */
+
 
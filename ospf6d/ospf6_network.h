@@ -36,5 +36,14 @@ extern int ospf6_sendmsg (struct in6_addr *, struct in6_addr *,
 extern int ospf6_recvmsg (struct in6_addr *, struct in6_addr *,
                           ifindex_t *, struct iovec *);
 
+/* Messages read per thread invocation */
+#ifdef HAVE_RECVMMSG
+#define OSPF6_READ_BATCH  8
+extern int ospf6_recvmmsg (struct in6_addr *, struct in6_addr *,
+                           ifindex_t *, struct iovec *, int *, int);
+#else
+#define OSPF6_READ_BATCH  1
+#endif /* HAVE_RECVMMSG */
+
 #endif /* OSPF6_NETWORK_H */
 
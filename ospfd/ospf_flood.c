@@ -31,6 +31,8 @@
 #include "memory.h"
 #include "log.h"
 #include "zclient.h"
+#include "hash.h"
+#include "jhash.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_interface.h"
@@ -822,38 +824,132 @@ ospf_ls_request_new (struct lsa_header *lsah)
 
 
 /* Management functions for neighbor's ls-retransmit list. */
+static unsigned int
+ospf_ls_rxmt_hash_key (void *data)
+{
+  struct ospf_ls_rxmt *rxmt = data;
+
+  return jhash_3words (rxmt->lsa->data->type, rxmt->lsa->data->id.s_addr,
+		       rxmt->lsa->data->adv_router.s_addr, 0);
+}
+
+static int
+ospf_ls_rxmt_hash_cmp (const void *data1, const void *data2)
+{
+  const struct ospf_ls_rxmt *r1 = data1;
+  const struct ospf_ls_rxmt *r2 = data2;
+
+  return r1->lsa->data->type == r2->lsa->data->type
+    && IPV4_ADDR_SAME (&r1->lsa->data->id, &r2->lsa->data->id)
+    && IPV4_ADDR_SAME (&r1->lsa->data->adv_router,
+		       &r2->lsa->data->adv_router);
+}
+
+static struct ospf_ls_rxmt *
+ospf_ls_rxmt_lookup (struct ospf_neighbor *nbr, struct ospf_lsa *lsa)
+{
+  struct ospf_ls_rxmt key;
+
+  key.lsa = lsa;
+  return hash_lookup (nbr->ls_rxmt, &key);
+}
+
+/* Append an entry to the due-time ordered list.  An LSA is first due
+   RxmtInterval after it was received, or at once if that has already
+   passed.  Never go before the current tail, which keeps the list
+   sorted without searching it if RxmtInterval is reconfigured. */
+static void
+ospf_ls_rxmt_schedule (struct ospf_neighbor *nbr, struct ospf_ls_rxmt *rxmt,
+		       struct timeval from)
+{
+  rxmt->due = tv_add (from,
+		      int2tv (OSPF_IF_PARAM (nbr->oi, retransmit_interval)));
+  if (nbr->ls_rxmt_tail && tv_cmp (rxmt->due, nbr->ls_rxmt_tail->due) < 0)
+    rxmt->due = nbr->ls_rxmt_tail->due;
+
+  rxmt->next = NULL;
+  rxmt->prev = nbr->ls_rxmt_tail;
+  if (nbr->ls_rxmt_tail)
+    nbr->ls_rxmt_tail->next = rxmt;
+  else
+    nbr->ls_rxmt_head = rxmt;
+  nbr->ls_rxmt_tail = rxmt;
+}
+
+static void
+ospf_ls_rxmt_unlink (struct ospf_neighbor *nbr, struct ospf_ls_rxmt *rxmt)
+{
+  if (rxmt->prev)
+    rxmt->prev->next = rxmt->next;
+  else
+    nbr->ls_rxmt_head = rxmt->next;
+  if (rxmt->next)
+    rxmt->next->prev = rxmt->prev;
+  else
+    nbr->ls_rxmt_tail = rxmt->prev;
+}
+
+void
+ospf_ls_retransmit_init (struct ospf_neighbor *nbr)
+{
+  nbr->ls_rxmt = hash_create (ospf_ls_rxmt_hash_key, ospf_ls_rxmt_hash_cmp);
+  nbr->ls_rxmt_head = nbr->ls_rxmt_tail = NULL;
+}
+
+void
+ospf_ls_retransmit_finish (struct ospf_neighbor *nbr)
+{
+  ospf_ls_retransmit_clear (nbr);
+  hash_free (nbr->ls_rxmt);
+  nbr->ls_rxmt = NULL;
+}
+
 unsigned long
 ospf_ls_retransmit_count (struct ospf_neighbor *nbr)
 {
-  return ospf_lsdb_count_all (&nbr->ls_rxmt);
+  return hashcount (nbr->ls_rxmt);
 }
 
 unsigned long
 ospf_ls_retransmit_count_self (struct ospf_neighbor *nbr, int lsa_type)
 {
-  return ospf_lsdb_count_self (&nbr->ls_rxmt, lsa_type);
+  struct ospf_ls_rxmt *rxmt;
+  unsigned long count = 0;
+
+  for (rxmt = nbr->ls_rxmt_head; rxmt; rxmt = rxmt->next)
+    if (rxmt->lsa->data->type == lsa_type && IS_LSA_SELF (rxmt->lsa))
+      count++;
+
+  return count;
 }
 
 int
 ospf_ls_retransmit_isempty (struct ospf_neighbor *nbr)
 {
-  return ospf_lsdb_isempty (&nbr->ls_rxmt);
+  return nbr->ls_rxmt_head == NULL;
 }
 
 /* Add LSA to be retransmitted to neighbor's ls-retransmit list. */
 void
 ospf_ls_retransmit_add (struct ospf_neighbor *nbr, struct ospf_lsa *lsa)
 {
-  struct ospf_lsa *old;
+  struct ospf_ls_rxmt *rxmt;
 
-  old = ospf_ls_retransmit_lookup (nbr, lsa);
+  rxmt = ospf_ls_rxmt_lookup (nbr, lsa);
 
-  if (ospf_lsa_more_recent (old, lsa) < 0)
+  if (ospf_lsa_more_recent (rxmt ? rxmt->lsa : NULL, lsa) < 0)
     {
-      if (old)
+      if (rxmt)
 	{
-	  old->retransmit_counter--;
-	  ospf_lsdb_delete (&nbr->ls_rxmt, old);
+	  rxmt->lsa->retransmit_counter--;
+	  ospf_lsa_unlock (&rxmt->lsa);
+	  ospf_ls_rxmt_unlink (nbr, rxmt);
+	}
+      else
+	{
+	  rxmt = XCALLOC (MTYPE_OSPF_LS_RXMT, sizeof (struct ospf_ls_rxmt));
+	  rxmt->lsa = lsa;
+	  hash_get (nbr->ls_rxmt, rxmt, hash_alloc_intern);
 	}
       lsa->retransmit_counter++;
       /*
@@ -866,7 +962,9 @@ ospf_ls_retransmit_add (struct ospf_neighbor *nbr, struct ospf_lsa *lsa)
 	  zlog_debug ("RXmtL(%lu)++, NBR(%s), LSA[%s]",
                      ospf_ls_retransmit_count (nbr),
 		     inet_ntoa (nbr->router_id), dump_lsa_key (lsa));
-      ospf_lsdb_add (&nbr->ls_rxmt, lsa);
+      /* Same key, so the hash entry stays valid. */
+      rxmt->lsa = ospf_lsa_lock (lsa);
+      ospf_ls_rxmt_schedule (nbr, rxmt, lsa->tv_recv);
     }
 }
 
@@ -874,14 +972,19 @@ ospf_ls_retransmit_add (struct ospf_neighbor *nbr, struct ospf_lsa *lsa)
 void
 ospf_ls_retransmit_delete (struct ospf_neighbor *nbr, struct ospf_lsa *lsa)
 {
-  if (ospf_ls_retransmit_lookup (nbr, lsa))
+  struct ospf_ls_rxmt *rxmt;
+
+  if ((rxmt = ospf_ls_rxmt_lookup (nbr, lsa)) != NULL)
     {
       lsa->retransmit_counter--;  
       if (IS_DEBUG_OSPF (lsa, LSA_FLOODING))		/* -- endo. */
 	  zlog_debug ("RXmtL(%lu)--, NBR(%s), LSA[%s]",
                      ospf_ls_retransmit_count (nbr),
 		     inet_ntoa (nbr->router_id), dump_lsa_key (lsa));
-      ospf_lsdb_delete (&nbr->ls_rxmt, lsa);
+      hash_release (nbr->ls_rxmt, rxmt);
+      ospf_ls_rxmt_unlink (nbr, rxmt);
+      ospf_lsa_unlock (&rxmt->lsa);
+      XFREE (MTYPE_OSPF_LS_RXMT, rxmt);
     }
 }
 
@@ -889,21 +992,8 @@ ospf_ls_retransmit_delete (struct ospf_neighbor *nbr, struct ospf_lsa *lsa)
 void
 ospf_ls_retransmit_clear (struct ospf_neighbor *nbr)
 {
-  struct ospf_lsdb *lsdb;
-  int i;
-
-  lsdb = &nbr->ls_rxmt;
-
-  for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++)
-    {
-      struct route_table *table = lsdb->type[i].db;
-      struct route_node *rn;
-      struct ospf_lsa *lsa;
-
-      for (rn = route_top (table); rn; rn = route_next (rn))
-	if ((lsa = rn->info) != NULL)
-	  ospf_ls_retransmit_delete (nbr, lsa);
-    }
+  while (nbr->ls_rxmt_head)
+    ospf_ls_retransmit_delete (nbr, nbr->ls_rxmt_head->lsa);
 
   ospf_lsa_unlock (&nbr->ls_req_last);
   nbr->ls_req_last = NULL;
@@ -913,7 +1003,38 @@ ospf_ls_retransmit_clear (struct ospf_neighbor *nbr)
 struct ospf_lsa *
 ospf_ls_retransmit_lookup (struct ospf_neighbor *nbr, struct ospf_lsa *lsa)
 {
-  return ospf_lsdb_lookup (&nbr->ls_rxmt, lsa);
+  struct ospf_ls_rxmt *rxmt;
+
+  rxmt = ospf_ls_rxmt_lookup (nbr, lsa);
+  return rxmt ? rxmt->lsa : NULL;
+}
+
+/* Return the LSAs that are due for retransmission to the neighbor, and
+   schedule them again RxmtInterval from now.  Only the due entries at
+   the head of the list are looked at. */
+struct list *
+ospf_ls_retransmit_due (struct ospf_neighbor *nbr)
+{
+  struct list *update;
+  struct ospf_ls_rxmt *rxmt, *last;
+  struct timeval now;
+
+  update = list_new ();
+  now = recent_relative_time ();
+
+  /* Rescheduled entries go behind the current tail, so stop there. */
+  last = nbr->ls_rxmt_tail;
+  while ((rxmt = nbr->ls_rxmt_head) != NULL
+	 && tv_cmp (rxmt->due, now) <= 0)
+    {
+      listnode_add (update, rxmt->lsa);
+      ospf_ls_rxmt_unlink (nbr, rxmt);
+      ospf_ls_rxmt_schedule (nbr, rxmt, now);
+      if (rxmt == last)
+	break;
+    }
+
+  return update;
 }
 
 static void
@@ -23,6 +23,20 @@
 #ifndef _ZEBRA_OSPF_FLOOD_H
 #define _ZEBRA_OSPF_FLOOD_H
 
+/* Entry of a neighbor's ls-retransmit list.  Entries are appended with
+   non-decreasing due times, so the list stays sorted and the
+   retransmission timer only has to look at its head. */
+struct ospf_ls_rxmt
+{
+  struct ospf_ls_rxmt *prev;
+  struct ospf_ls_rxmt *next;
+
+  struct ospf_lsa *lsa;
+
+  /* When the LSA is next to be retransmitted. */
+  struct timeval due;
+};
+
 extern int ospf_flood (struct ospf *, struct ospf_neighbor *,
 		       struct ospf_lsa *, struct ospf_lsa *);
 extern int ospf_flood_through (struct ospf *, struct ospf_neighbor *,
@@ -55,6 +69,9 @@ extern void ospf_ls_retransmit_delete (struct ospf_neighbor *,
 extern void ospf_ls_retransmit_clear (struct ospf_neighbor *);
 extern struct ospf_lsa *ospf_ls_retransmit_lookup (struct ospf_neighbor *,
 						   struct ospf_lsa *);
+extern void ospf_ls_retransmit_init (struct ospf_neighbor *);
+extern void ospf_ls_retransmit_finish (struct ospf_neighbor *);
+extern struct list *ospf_ls_retransmit_due (struct ospf_neighbor *);
 extern void ospf_ls_retransmit_delete_nbr_area (struct ospf_area *,
 						struct ospf_lsa *);
 extern void ospf_ls_retransmit_delete_nbr_as (struct ospf *,
@@ -46,6 +46,31 @@
 #include "ospfd/ospf_ia.h"
 #include "ospfd/ospf_dump.h"
 
+/* The summary-LSAs ospf_ia_examine() looks at, when not all of them:
+   those of one type describing one destination. */
+struct ospf_ia_scope
+{
+  u_char type;
+  struct prefix_ipv4 p;
+};
+
+/* Destination described by a summary-LSA. */
+static void
+ospf_summary_lsa_prefix (struct ospf_lsa *lsa, struct prefix_ipv4 *p)
+{
+  struct summary_lsa *sl = (struct summary_lsa *) lsa->data;
+
+  p->family = AF_INET;
+  p->prefix = sl->header.id;
+
+  if (sl->header.type == OSPF_SUMMARY_LSA)
+    p->prefixlen = ip_masklen (sl->mask);
+  else
+    p->prefixlen = IPV4_MAX_BITLEN;
+
+  apply_mask_ipv4 (p);
+}
+
 static struct ospf_route *
 ospf_find_abr_route (struct route_table *rtrs, 
                      struct prefix_ipv4 *abr,
@@ -224,15 +249,7 @@ process_summary_lsa (struct ospf_area *area, struct route_table *rt,
   if (ospf_lsa_is_self_originated (area->ospf, lsa))
     return 0;
 
-  p.family = AF_INET;
-  p.prefix = sl->header.id;
-   
-  if (sl->header.type == OSPF_SUMMARY_LSA)
-    p.prefixlen = ip_masklen (sl->mask);
-  else
-    p.prefixlen = IPV4_MAX_BITLEN;
-      
-  apply_mask_ipv4 (&p);
+  ospf_summary_lsa_prefix (lsa, &p);
 
   if (sl->header.type == OSPF_SUMMARY_LSA &&
       (range = ospf_area_range_match_any (ospf, &p)) &&
@@ -569,15 +586,7 @@ process_transit_summary_lsa (struct ospf_area *area, struct route_table *rt,
       return 0;
     }
 
-  p.family = AF_INET;
-  p.prefix = sl->header.id;
-   
-  if (sl->header.type == OSPF_SUMMARY_LSA)
-    p.prefixlen = ip_masklen (sl->mask);
-  else
-    p.prefixlen = IPV4_MAX_BITLEN;
-      
-  apply_mask_ipv4 (&p);
+  ospf_summary_lsa_prefix (lsa, &p);
 
   if (sl->header.type == OSPF_SUMMARY_LSA)
     ospf_update_network_route (ospf, rt, rtrs, sl, &p, area);
@@ -600,10 +609,55 @@ ospf_examine_transit_summaries (struct ospf_area *area,
     process_transit_summary_lsa (area, rt, rtrs, lsa);
 }
 
-void
-ospf_ia_routing (struct ospf *ospf,
-		 struct route_table *rt,
-                 struct route_table *rtrs)
+/* Examine the summary-LSAs of an area, or with a scope only those for
+   its destination.  Their link state IDs all fall within the destination
+   (RFC 2328 Appendix E), so they lie in one subtree of the LSDB. */
+static void
+ospf_ia_examine (struct ospf_area *area, int transit, struct route_table *rt,
+                 struct route_table *rtrs, struct ospf_ia_scope *scope)
+{
+  struct route_node *rn, *start;
+  struct ospf_lsa *lsa;
+  struct prefix_ls lp;
+  struct prefix_ipv4 p;
+
+  if (scope == NULL && transit)
+    {
+      OSPF_EXAMINE_TRANSIT_SUMMARIES_ALL (area, rt, rtrs);
+      return;
+    }
+  if (scope == NULL)
+    {
+      OSPF_EXAMINE_SUMMARIES_ALL (area, rt, rtrs);
+      return;
+    }
+
+  memset (&lp, 0, sizeof (struct prefix_ls));
+  lp.prefixlen = scope->p.prefixlen;
+  lp.id = scope->p.prefix;
+
+  start = route_node_get (area->lsdb->type[scope->type].db,
+                          (struct prefix *) &lp);
+  route_lock_node (start);
+  for (rn = start; rn; rn = route_next_until (rn, start))
+    if ((lsa = rn->info))
+      {
+        ospf_summary_lsa_prefix (lsa, &p);
+        if (! prefix_same ((struct prefix *) &p,
+                           (struct prefix *) &scope->p))
+          continue;
+
+        if (transit)
+          process_transit_summary_lsa (area, rt, rtrs, lsa);
+        else
+          process_summary_lsa (area, rt, rtrs, lsa);
+      }
+  route_unlock_node (start);
+}
+
+static void
+ospf_ia_examine_areas (struct ospf *ospf, struct route_table *rt,
+                       struct route_table *rtrs, struct ospf_ia_scope *scope)
 {
   struct ospf_area * area;
 
@@ -631,12 +685,12 @@ ospf_ia_routing (struct ospf *ospf,
 		  zlog_debug ("ospf_ia_routing():examining summaries");
 		}
 
-              OSPF_EXAMINE_SUMMARIES_ALL (area, rt, rtrs);
+              ospf_ia_examine (area, 0, rt, rtrs, scope);
 
 	      for (ALL_LIST_ELEMENTS_RO (ospf->areas, node, area))
                 if (area != ospf->backbone)
                   if (ospf_area_is_transit (area))
-                    OSPF_EXAMINE_TRANSIT_SUMMARIES_ALL (area, rt, rtrs);
+                    ospf_ia_examine (area, 1, rt, rtrs, scope);
             }
           else
 	    if (IS_DEBUG_OSPF_EVENT)
@@ -657,12 +711,12 @@ ospf_ia_routing (struct ospf *ospf,
 		  zlog_debug ("ospf_ia_routing(): examining BB summaries");
 		}
 
-              OSPF_EXAMINE_SUMMARIES_ALL (area, rt, rtrs);
+              ospf_ia_examine (area, 0, rt, rtrs, scope);
 
 	      for (ALL_LIST_ELEMENTS_RO (ospf->areas, node, area))
                 if (area != ospf->backbone)
                   if (ospf_area_is_transit (area))
-                    OSPF_EXAMINE_TRANSIT_SUMMARIES_ALL (area, rt, rtrs);
+                    ospf_ia_examine (area, 1, rt, rtrs, scope);
             }
           else
             { /* No active BB connection--consider all areas */
@@ -670,7 +724,7 @@ ospf_ia_routing (struct ospf *ospf,
 		zlog_debug ("ospf_ia_routing(): "
 			   "Active BB connection not found");
 	      for (ALL_LIST_ELEMENTS_RO (ospf->areas, node, area))
-                OSPF_EXAMINE_SUMMARIES_ALL (area, rt, rtrs);
+                ospf_ia_examine (area, 0, rt, rtrs, scope);
             }
           break;
         case OSPF_ABR_SHORTCUT:
@@ -686,7 +740,7 @@ ospf_ia_routing (struct ospf *ospf,
 		  zlog_debug ("ospf_ia_routing(): backbone area found");
 		  zlog_debug ("ospf_ia_routing(): examining BB summaries");
 		}
-              OSPF_EXAMINE_SUMMARIES_ALL (area, rt, rtrs);
+              ospf_ia_examine (area, 0, rt, rtrs, scope);
             }
 
 	  for (ALL_LIST_ELEMENTS_RO (ospf->areas, node, area))
@@ -696,7 +750,7 @@ ospf_ia_routing (struct ospf *ospf,
                   ((ospf->backbone == NULL) ||
                   ((area->shortcut_configured == OSPF_SHORTCUT_ENABLE) &&
                   area->shortcut_capability))))
-                OSPF_EXAMINE_TRANSIT_SUMMARIES_ALL (area, rt, rtrs);
+                ospf_ia_examine (area, 1, rt, rtrs, scope);
           break;
         default:
           break;
@@ -710,6 +764,149 @@ ospf_ia_routing (struct ospf *ospf,
 	zlog_debug ("ospf_ia_routing():not ABR, considering all areas");
 
       for (ALL_LIST_ELEMENTS_RO (ospf->areas, node, area))
-        OSPF_EXAMINE_SUMMARIES_ALL (area, rt, rtrs);
+        ospf_ia_examine (area, 0, rt, rtrs, scope);
     }
 }
+
+void
+ospf_ia_routing (struct ospf *ospf,
+		 struct route_table *rt,
+                 struct route_table *rtrs)
+{
+  ospf_ia_examine_areas (ospf, rt, rtrs, NULL);
+}
+
+/* Redo the inter-area route to a network for one summary-LSA change.
+   Returns 1 if the route changed, 0 if not and -1 if only a full
+   calculation can tell. */
+static int
+ospf_ia_network_update (struct ospf *ospf, struct ospf_ia_scope *scope)
+{
+  struct route_table *rt;
+  struct route_node *rn;
+  struct ospf_route *or = NULL;
+
+  if ((rn = route_node_lookup (ospf->new_table, (struct prefix *) &scope->p)))
+    {
+      route_unlock_node (rn);
+      or = rn->info;
+    }
+
+  /* Intra-area routes and the discard routes for our own ranges take
+     precedence over summaries, but an ABR may have given an intra-area
+     route the nexthops of a transit area summary (16.3). */
+  if (or && or->type == OSPF_DESTINATION_DISCARD)
+    return 0;
+  if (or && or->path_type == OSPF_PATH_INTRA_AREA)
+    return IS_OSPF_ABR (ospf) ? -1 : 0;
+
+  rt = route_table_init ();
+  ospf_ia_examine_areas (ospf, rt, ospf->new_rtrs, scope);
+  ospf_prune_unreachable_networks (rt);
+
+  or = NULL;
+  if ((rn = route_node_lookup (rt, (struct prefix *) &scope->p)))
+    {
+      or = rn->info;
+      rn->info = NULL;
+      route_unlock_node (rn);
+      route_unlock_node (rn);
+    }
+  route_table_finish (rt);
+
+  return ospf_route_install_prefix (ospf, &scope->p, or);
+}
+
+/* Redo the inter-area routes to an AS boundary router for one
+   ASBR-summary-LSA change, in place in the router routing table. */
+static int
+ospf_ia_router_update (struct ospf *ospf, struct ospf_ia_scope *scope)
+{
+  struct route_node *rn;
+  struct ospf_route *or;
+  struct listnode *node, *nnode;
+  struct list *paths = NULL;
+
+  if ((rn = route_node_lookup (ospf->new_rtrs, (struct prefix *) &scope->p)))
+    {
+      route_unlock_node (rn);
+      paths = rn->info;
+    }
+
+  if (paths)
+    {
+      if (IS_OSPF_ABR (ospf))
+        for (ALL_LIST_ELEMENTS_RO (paths, node, or))
+          if (or->path_type == OSPF_PATH_INTRA_AREA)
+            return -1;
+
+      for (ALL_LIST_ELEMENTS (paths, node, nnode, or))
+        if (or->path_type == OSPF_PATH_INTER_AREA)
+          {
+            listnode_delete (paths, or);
+            ospf_route_free (or);
+          }
+    }
+
+  ospf_ia_examine_areas (ospf, NULL, ospf->new_rtrs, scope);
+  ospf_prune_unreachable_routers (ospf->new_rtrs);
+
+  return 1;
+}
+
+/* RFC 2328 16.5: a summary-LSA was installed or has reached MaxAge.
+   Work out the best route to its destination again against the
+   intra-area routes of the last SPF calculation instead of repeating
+   the calculation, which summary-LSAs cannot change. */
+void
+ospf_ia_incremental_update (struct ospf *ospf, struct ospf_lsa *lsa)
+{
+  struct ospf_ia_scope scope;
+  ospf_spf_reason_t reason;
+  int ret;
+
+  if (lsa->data->type == OSPF_SUMMARY_LSA)
+    reason = SPF_FLAG_SUMMARY_LSA_INSTALL;
+  else
+    reason = SPF_FLAG_ASBR_SUMMARY_LSA_INSTALL;
+
+  /* A pending calculation will pick the change up, and a Shortcut ABR
+     may turn intra-area routes into inter-area ones. */
+  if (ospf->t_spf_calc || ! ospf->new_table || ! ospf->new_rtrs
+      || (IS_OSPF_ABR (ospf) && ospf->abr_type == OSPF_ABR_SHORTCUT))
+    {
+      ospf_spf_calculate_schedule (ospf, reason);
+      return;
+    }
+
+  scope.type = lsa->data->type;
+  ospf_summary_lsa_prefix (lsa, &scope.p);
+
+  if (scope.type == OSPF_SUMMARY_LSA)
+    ret = ospf_ia_network_update (ospf, &scope);
+  else
+    ret = ospf_ia_router_update (ospf, &scope);
+
+  if (ret < 0)
+    {
+      ospf_spf_calculate_schedule (ospf, reason);
+      return;
+    }
+
+  ospf->prc_count++;
+
+  if (IS_DEBUG_OSPF_EVENT)
+    zlog_debug ("ospf_ia_incremental_update(): %s/%d %s",
+                inet_ntoa (scope.p.prefix), scope.p.prefixlen,
+                ret ? "changed" : "unchanged");
+
+  if (ret == 0)
+    return;
+
+  /* As after a full calculation: external routes may go through the
+     changed route, and an ABR summarises it into its other areas. */
+  ospf_ase_calculate_schedule (ospf);
+  ospf_ase_calculate_timer_add (ospf);
+  if (IS_OSPF_ABR (ospf))
+    ospf_schedule_abr_task (ospf);
+}
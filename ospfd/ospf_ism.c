@@ -38,6 +38,7 @@
 #include "ospfd/ospf_lsdb.h"
 #include "ospfd/ospf_neighbor.h"
 #include "ospfd/ospf_nsm.h"
+#include "ospfd/ospf_spf.h"
 #include "ospfd/ospf_network.h"
 #include "ospfd/ospf_dump.h"
 #include "ospfd/ospf_packet.h"
@@ -579,6 +580,9 @@ ism_change_state (struct ospf_interface *oi, int state)
   /* schedule router-LSA originate. */
   ospf_router_lsa_update_area (oi->area);
 
+  /* Nexthops through this interface must be worked out afresh. */
+  ospf_spf_invalidate (oi->area);
+
   /* Originate network-LSA. */
   if (old_state != ISM_DR && state == ISM_DR)
     ospf_network_lsa_update (oi);
@@ -48,6 +48,7 @@
 #include "ospfd/ospf_dump.h"
 #include "ospfd/ospf_route.h"
 #include "ospfd/ospf_ase.h"
+#include "ospfd/ospf_ia.h"
 #include "ospfd/ospf_zebra.h"
 
 
@@ -251,6 +252,8 @@ ospf_lsa_dup (struct ospf_lsa *lsa)
   new->lock = 1;
   new->retransmit_counter = 0;
   new->data = ospf_lsa_data_dup (lsa->data);
+  new->link_index = NULL;
+  new->link_index_count = 0;
 
   /* kevinm: Clear the refresh_list, otherwise there are going
      to be problems when we try to remove the LSA from the
@@ -276,6 +279,8 @@ ospf_lsa_free (struct ospf_lsa *lsa)
   /* Delete LSA data. */
   if (lsa->data != NULL)
     ospf_lsa_data_free (lsa->data);
+  if (lsa->link_index)
+    XFREE (MTYPE_OSPF_LSA_LINK_INDEX, lsa->link_index);
 
   assert (lsa->refresh_list < 0);
 
@@ -352,6 +357,139 @@ ospf_lsa_data_free (struct lsa_header *lsah)
   XFREE (MTYPE_OSPF_LSA_DATA, lsah);
 }
 
+/* The link index lets the SPF calculation check for the link back to a
+   vertex (16.1 (2)(b)) by a binary search, instead of scanning the LSA
+   of its neighbour for every link of the vertex. */
+static int
+ospf_lsa_link_key_cmp (const void *a, const void *b)
+{
+  const struct ospf_lsa_link_key *k1 = a, *k2 = b;
+
+  if (k1->type != k2->type)
+    return k1->type < k2->type ? -1 : 1;
+  if (k1->id.s_addr != k2->id.s_addr)
+    return k1->id.s_addr < k2->id.s_addr ? -1 : 1;
+  return 0;
+}
+
+static int
+ospf_lsa_link_key_pos_cmp (const void *a, const void *b)
+{
+  const struct ospf_lsa_link_key *k1 = a, *k2 = b;
+  int ret;
+
+  if ((ret = ospf_lsa_link_key_cmp (a, b)) != 0)
+    return ret;
+  return k1->pos - k2->pos;
+}
+
+static void
+ospf_lsa_link_index_free (struct ospf_lsa *lsa)
+{
+  if (lsa->link_index)
+    XFREE (MTYPE_OSPF_LSA_LINK_INDEX, lsa->link_index);
+  lsa->link_index = NULL;
+  lsa->link_index_count = 0;
+}
+
+/* Index the links of a router- or network-LSA, keeping the first link
+   to each router or transit network as ospf_lsa_has_link() finds it. */
+void
+ospf_lsa_link_index_build (struct ospf_lsa *lsa)
+{
+  struct lsa_header *lsah = lsa->data;
+  struct ospf_lsa_link_key *keys = NULL;
+  struct router_lsa *rl;
+  struct network_lsa *nl;
+  unsigned int i, length;
+  int n = 0, count;
+
+  ospf_lsa_link_index_free (lsa);
+
+  if (lsah->type == OSPF_NETWORK_LSA)
+    {
+      nl = (struct network_lsa *) lsah;
+      length = ntohs (lsah->length);
+      if (length < OSPF_LSA_HEADER_SIZE + 4)
+        return;
+      length = (length - OSPF_LSA_HEADER_SIZE - 4) / 4;
+      if (length == 0)
+        return;
+
+      keys = XMALLOC (MTYPE_OSPF_LSA_LINK_INDEX,
+                      length * sizeof (struct ospf_lsa_link_key));
+      for (i = 0; i < length; i++, n++)
+        {
+          keys[n].type = OSPF_ROUTER_LSA;
+          keys[n].id = nl->routers[i];
+          keys[n].pos = i;
+        }
+    }
+  else if (lsah->type == OSPF_ROUTER_LSA)
+    {
+      rl = (struct router_lsa *) lsah;
+      if (ntohs (rl->links) == 0)
+        return;
+
+      keys = XMALLOC (MTYPE_OSPF_LSA_LINK_INDEX,
+                      ntohs (rl->links) * sizeof (struct ospf_lsa_link_key));
+      length = ntohs (lsah->length);
+      for (i = 0;
+           i < ntohs (rl->links) && length >= sizeof (struct router_lsa);
+           i++, length -= 12)
+        {
+          switch (rl->link[i].type)
+            {
+            case LSA_LINK_TYPE_POINTOPOINT:
+            case LSA_LINK_TYPE_VIRTUALLINK:
+              keys[n].type = OSPF_ROUTER_LSA;
+              break;
+            case LSA_LINK_TYPE_TRANSIT:
+              keys[n].type = OSPF_NETWORK_LSA;
+              break;
+            default:
+              continue;
+            }
+          keys[n].id = rl->link[i].link_id;
+          keys[n].pos = i;
+          n++;
+        }
+    }
+  else
+    return;
+
+  if (n == 0)
+    {
+      XFREE (MTYPE_OSPF_LSA_LINK_INDEX, keys);
+      return;
+    }
+
+  qsort (keys, n, sizeof (struct ospf_lsa_link_key),
+         ospf_lsa_link_key_pos_cmp);
+  for (count = 1, i = 1; i < (unsigned int) n; i++)
+    if (ospf_lsa_link_key_cmp (&keys[count - 1], &keys[i]) != 0)
+      keys[count++] = keys[i];
+
+  lsa->link_index = keys;
+  lsa->link_index_count = count;
+}
+
+/* Position of the first link of an indexed LSA to the router or transit
+   network with the given LSA type and ID, or -1 if there is none. */
+int
+ospf_lsa_link_index_lookup (struct ospf_lsa *lsa, u_char type,
+                            struct in_addr id)
+{
+  struct ospf_lsa_link_key key, *found;
+
+  key.type = type;
+  key.id = id;
+  found = bsearch (&key, lsa->link_index, lsa->link_index_count,
+                   sizeof (struct ospf_lsa_link_key), ospf_lsa_link_key_cmp);
+
+  return found ? found->pos : -1;
+}
+
 
 /* LSA general functions. */
 
@@ -2447,6 +2585,8 @@ ospf_router_lsa_install (struct ospf *ospf, struct ospf_lsa *new,
 {
   struct ospf_area *area = new->area;
 
+  ospf_lsa_link_index_build (new);
+
   /* RFC 2328 Section 13.2 Router-LSAs and network-LSAs
      The entire routing table must be recalculated, starting with
      the shortest path calculations for each area (not just the
@@ -2469,7 +2609,10 @@ ospf_router_lsa_install (struct ospf *ospf, struct ospf_lsa *new,
       ospf_refresher_register_lsa (ospf, new);
     }
   if (rt_recalc)
-    ospf_spf_calculate_schedule (ospf, SPF_FLAG_ROUTER_LSA_INSTALL);
+    {
+      ospf_spf_lsa_changed (new);
+      ospf_spf_calculate_schedule (ospf, SPF_FLAG_ROUTER_LSA_INSTALL);
+    }
   return new;
 }
 
@@ -2484,6 +2627,7 @@ ospf_network_lsa_install (struct ospf *ospf,
 			  struct ospf_lsa *new,
 			  int rt_recalc)
 {
+  ospf_lsa_link_index_build (new);
 
   /* RFC 2328 Section 13.2 Router-LSAs and network-LSAs
      The entire routing table must be recalculated, starting with
@@ -2503,7 +2647,10 @@ ospf_network_lsa_install (struct ospf *ospf,
       ospf_refresher_register_lsa (ospf, new);
     }
   if (rt_recalc)
-    ospf_spf_calculate_schedule (ospf, SPF_FLAG_NETWORK_LSA_INSTALL);
+    {
+      ospf_spf_lsa_changed (new);
+      ospf_spf_calculate_schedule (ospf, SPF_FLAG_NETWORK_LSA_INSTALL);
+    }
 
   return new;
 }
@@ -2521,14 +2668,7 @@ ospf_summary_lsa_install (struct ospf *ospf, struct ospf_lsa *new,
 	 destination is an AS boundary router, it may also be
 	 necessary to re-examine all the AS-external-LSAs.
       */
-
-#if 0
-      /* This doesn't exist yet... */
-      ospf_summary_incremental_update(new); */
-#else /* #if 0 */
-      ospf_spf_calculate_schedule (ospf, SPF_FLAG_SUMMARY_LSA_INSTALL);
-#endif /* #if 0 */
- 
+      ospf_ia_incremental_update (ospf, new);
     }
 
   if (IS_LSA_SELF (new))
@@ -2550,15 +2690,7 @@ ospf_summary_asbr_lsa_install (struct ospf *ospf, struct ospf_lsa *new,
 	 destination is an AS boundary router, it may also be
 	 necessary to re-examine all the AS-external-LSAs.
       */
-#if 0
-      /* These don't exist yet... */
-      ospf_summary_incremental_update(new);
-      /* Isn't this done by the above call? 
-	 - RFC 2328 Section 16.5 implies it should be */
-      /* ospf_ase_calculate_schedule(); */
-#else  /* #if 0 */
-      ospf_spf_calculate_schedule (ospf, SPF_FLAG_ASBR_SUMMARY_LSA_INSTALL);
-#endif /* #if 0 */
+      ospf_ia_incremental_update (ospf, new);
     }
 
   /* register LSA to refresh-list. */
@@ -2719,6 +2851,13 @@ ospf_lsa_install (struct ospf *ospf, struct ospf_interface *oi,
   if (  old == NULL || ospf_lsa_different(old, lsa))
     rt_recalc = 1;
 
+  /* ospf_ia_incremental_update() only redoes the route to the
+     destination of the new instance, not to that of the old one. */
+  if (old && lsa->data->type == OSPF_SUMMARY_LSA
+      && ((struct summary_lsa *) old->data)->mask.s_addr
+         != ((struct summary_lsa *) lsa->data)->mask.s_addr)
+    ospf_spf_calculate_schedule (ospf, SPF_FLAG_SUMMARY_LSA_INSTALL);
+
   /*
      Sequence number check (Section 14.1 of rfc 2328)
      "Premature aging is used when it is time for a self-originated
@@ -3021,6 +3160,7 @@ ospf_lsa_maxage (struct ospf *ospf, struct ospf_lsa *lsa)
 	{
 	  rn->info = ospf_lsa_lock(lsa);
 	  SET_FLAG(lsa->flags, OSPF_LSA_IN_MAXAGE);
+	  ospf_spf_lsa_flushed (lsa);
 	}
     }
   else
@@ -3069,6 +3209,10 @@ ospf_lsa_maxage_walker_remover (struct ospf *ospf, struct ospf_lsa *lsa)
           case OSPF_AS_NSSA_LSA:
 	    ospf_ase_incremental_update (ospf, lsa);
             break;
+          case OSPF_SUMMARY_LSA:
+          case OSPF_ASBR_SUMMARY_LSA:
+            ospf_ia_incremental_update (ospf, lsa);
+            break;
           default:
 	    ospf_spf_calculate_schedule (ospf, SPF_FLAG_MAXAGE);
             break;
@@ -3681,6 +3825,14 @@ ospf_lsa_refresh (struct ospf *ospf, struct ospf_lsa *lsa)
   return new;
 }
 
+static unsigned int
+ospf_refresher_slot_count (struct ospf *ospf, u_int16_t index)
+{
+  struct list *refresh_list = ospf->lsa_refresh_queue.qs[index];
+
+  return refresh_list ? listcount (refresh_list) : 0;
+}
+
 void
 ospf_refresher_register_lsa (struct ospf *ospf, struct ospf_lsa *lsa)
 {
@@ -3707,6 +3859,20 @@ ospf_refresher_register_lsa (struct ospf *ospf, struct ospf_lsa *lsa)
       index = (current_index + delay/OSPF_LSA_REFRESHER_GRANULARITY)
 	      % (OSPF_LSA_REFRESHER_SLOTS);
 
+      /* Prefer the least loaded slot of the window, so that LSAs
+       * originated together are spread over it rather than clumped.
+       */
+      for (delay = min_delay; delay < max_delay;
+	   delay += OSPF_LSA_REFRESHER_GRANULARITY)
+	{
+	  u_int16_t slot = (current_index + delay/OSPF_LSA_REFRESHER_GRANULARITY)
+			   % (OSPF_LSA_REFRESHER_SLOTS);
+
+	  if (ospf_refresher_slot_count (ospf, slot)
+	      < ospf_refresher_slot_count (ospf, index))
+	    index = slot;
+	}
+
       if (IS_DEBUG_OSPF (lsa, LSA_REFRESH))
 	zlog_debug ("LSA[Refresh:Type%d:%s]: age %d, added to index %d",
 		    lsa->data->type, inet_ntoa (lsa->data->id), LS_AGE (lsa), index);
@@ -3752,7 +3918,11 @@ ospf_lsa_refresh_walker (struct thread *t)
   struct ospf *ospf = THREAD_ARG (t);
   struct ospf_lsa *lsa;
   int i;
+  u_int16_t index;
+  unsigned long limit, refreshed, deferred;
   struct list *lsa_to_refresh = list_new ();
+  struct list *next_list;
+  struct listnode *due = NULL;
 
   if (IS_DEBUG_OSPF (lsa, LSA_REFRESH))
     zlog_debug ("LSA[Refresh]: ospf_lsa_refresh_walker(): start");
@@ -3808,6 +3978,38 @@ ospf_lsa_refresh_walker (struct thread *t)
 					   ospf, ospf->lsa_refresh_interval);
   ospf->lsa_refresher_started = quagga_monotime ();
 
+  limit = ospf->lsa_refresh_rate * ospf->lsa_refresh_interval;
+  refreshed = deferred = 0;
+
+  /* Over the rate limit, hold LSAs back for the next run - unless waiting
+     would take them past the refresh interval. They were due before any
+     LSA already in the slot the next run starts with, so they go to its
+     head, in their order. This is done before any LSA is refreshed, as
+     refreshing may change that slot. */
+  index = ospf->lsa_refresh_queue.index;
+  for (ALL_LIST_ELEMENTS (lsa_to_refresh, node, nnode, lsa))
+    {
+      if (!limit || refreshed < limit
+	  || LS_AGE (lsa) + ospf->lsa_refresh_interval > OSPF_LS_REFRESH_TIME)
+	{
+	  refreshed++;
+	  continue;
+	}
+
+      if (!ospf->lsa_refresh_queue.qs[index])
+	ospf->lsa_refresh_queue.qs[index] = list_new ();
+      next_list = ospf->lsa_refresh_queue.qs[index];
+      if (!deferred)
+	due = listhead (next_list);
+
+      listnode_add_before (next_list, due, lsa); /* lsa_refresh_queue */
+      lsa->refresh_list = index;
+      list_delete_node (lsa_to_refresh, node);
+      deferred++;
+    }
+
+  /* All LSAs refreshed here are queued for flooding before any is sent,
+     so each interface packs them into as few LS Updates as it can. */
   for (ALL_LIST_ELEMENTS (lsa_to_refresh, node, nnode, lsa))
     {
       ospf_lsa_refresh (ospf, lsa);
@@ -3816,6 +4018,16 @@ ospf_lsa_refresh_walker (struct thread *t)
     }
   
   list_delete (lsa_to_refresh);
+
+  ospf->lsa_refresh_stats.refreshed = refreshed;
+  ospf->lsa_refresh_stats.deferred = deferred;
+  if (refreshed > ospf->lsa_refresh_stats.peak)
+    ospf->lsa_refresh_stats.peak = refreshed;
+  ospf->lsa_refresh_stats.total += refreshed;
+
+  if (IS_DEBUG_OSPF (lsa, LSA_REFRESH))
+    zlog_debug ("LSA[Refresh]: ospf_lsa_refresh_walker(): "
+		"refreshed %lu, deferred %lu", refreshed, deferred);
   
   if (IS_DEBUG_OSPF (lsa, LSA_REFRESH))
     zlog_debug ("LSA[Refresh]: ospf_lsa_refresh_walker(): end");
@@ -65,6 +65,14 @@ struct lsa_header
   u_int16_t length;
 };
 
+/* Entry of the link index of a router- or network-LSA. */
+struct ospf_lsa_link_key
+{
+  u_char type;                  /* LSA type at the far end of the link */
+  struct in_addr id;            /* and its Link State ID */
+  int pos;                      /* position of the first such link */
+};
+
 /* OSPF LSA. */
 struct ospf_lsa
 {
@@ -114,6 +122,11 @@ struct ospf_lsa
   
   /* For Type-9 Opaque-LSAs */
   struct ospf_interface *oi;
+
+  /* Routers and transit networks a router- or network-LSA links to,
+     sorted for ospf_lsa_link_index_lookup(). */
+  struct ospf_lsa_link_key *link_index;
+  int link_index_count;
 };
 
 /* OSPF LSA Link Type. */
@@ -259,6 +272,9 @@ extern int ospf_lsa_flush_schedule (struct ospf *, struct ospf_lsa *);
 extern struct lsa_header *ospf_lsa_data_new (size_t);
 extern struct lsa_header *ospf_lsa_data_dup (struct lsa_header *);
 extern void ospf_lsa_data_free (struct lsa_header *);
+extern void ospf_lsa_link_index_build (struct ospf_lsa *);
+extern int ospf_lsa_link_index_lookup (struct ospf_lsa *, u_char,
+                                       struct in_addr);
 
 /* Prototype for various LSAs */
 extern int ospf_router_lsa_update (struct ospf *);
@@ -26,6 +26,8 @@
 #include "table.h"
 #include "memory.h"
 #include "log.h"
+#include "hash.h"
+#include "jhash.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_asbr.h"
@@ -49,7 +51,10 @@ ospf_lsdb_init (struct ospf_lsdb *lsdb)
   int i;
   
   for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++)
-    lsdb->type[i].db = route_table_init ();
+    {
+      lsdb->type[i].db = route_table_init ();
+      lsdb->type[i].index = NULL;
+    }
 }
 
 void
@@ -69,7 +74,14 @@ ospf_lsdb_cleanup (struct ospf_lsdb *lsdb)
   ospf_lsdb_delete_all (lsdb);
   
   for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++)
-    route_table_finish (lsdb->type[i].db);
+    {
+      route_table_finish (lsdb->type[i].db);
+      if (lsdb->type[i].index)
+	{
+	  hash_free (lsdb->type[i].index);
+	  lsdb->type[i].index = NULL;
+	}
+    }
 }
 
 void
@@ -84,6 +96,44 @@ ls_prefix_set (struct prefix_ls *lp, struct ospf_lsa *lsa)
     }
 }
 
+static unsigned int
+ospf_lsdb_index_key (void *data)
+{
+  struct route_node *rn = data;
+  struct prefix_ls *lp = (struct prefix_ls *) &rn->p;
+
+  return jhash_2words (lp->id.s_addr, lp->adv_router.s_addr, 0);
+}
+
+static int
+ospf_lsdb_index_cmp (const void *data1, const void *data2)
+{
+  const struct prefix_ls *lp1 = (const struct prefix_ls *)
+    &((const struct route_node *) data1)->p;
+  const struct prefix_ls *lp2 = (const struct prefix_ls *)
+    &((const struct route_node *) data2)->p;
+
+  return IPV4_ADDR_SAME (&lp1->id, &lp2->id)
+    && IPV4_ADDR_SAME (&lp1->adv_router, &lp2->adv_router);
+}
+
+/* Find the node holding the LSA with the given key, without walking
+   the table. */
+static struct route_node *
+ospf_lsdb_index_lookup (struct ospf_lsdb *lsdb, u_char type,
+			struct in_addr id, struct in_addr adv_router)
+{
+  struct route_node key;
+  struct prefix_ls *lp = (struct prefix_ls *) &key.p;
+
+  if (lsdb->type[type].index == NULL)
+    return NULL;
+
+  lp->id = id;
+  lp->adv_router = adv_router;
+  return hash_lookup (lsdb->type[type].index, &key);
+}
+
 static void
 ospf_lsdb_delete_entry (struct ospf_lsdb *lsdb, struct route_node *rn)
 {
@@ -99,6 +149,7 @@ ospf_lsdb_delete_entry (struct ospf_lsdb *lsdb, struct route_node *rn)
   lsdb->type[lsa->data->type].count--;
   lsdb->type[lsa->data->type].checksum -= ntohs(lsa->data->checksum);
   lsdb->total--;
+  hash_release (lsdb->type[lsa->data->type].index, rn);
   rn->info = NULL;
   route_unlock_node (rn);
 #ifdef MONITOR_LSDB_CHANGE
@@ -118,19 +169,28 @@ ospf_lsdb_add (struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
   struct route_node *rn;
 
   table = lsdb->type[lsa->data->type].db;
-  ls_prefix_set (&lp, lsa);
-  rn = route_node_get (table, (struct prefix *)&lp);
+  rn = ospf_lsdb_index_lookup (lsdb, lsa->data->type,
+			       lsa->data->id, lsa->data->adv_router);
   
   /* nothing to do? */
-  if (rn->info && rn->info == lsa)
+  if (rn && rn->info == lsa)
+    return;
+  
+  /* purge old entry?  Its node is kept locked for the new one. */
+  if (rn)
     {
-      route_unlock_node (rn);
-      return;
+      route_lock_node (rn);
+      ospf_lsdb_delete_entry (lsdb, rn);
     }
-  
-  /* purge old entry? */
-  if (rn->info)
-    ospf_lsdb_delete_entry (lsdb, rn);
+  else
+    {
+      ls_prefix_set (&lp, lsa);
+      rn = route_node_get (table, (struct prefix *)&lp);
+    }
+
+  if (lsdb->type[lsa->data->type].index == NULL)
+    lsdb->type[lsa->data->type].index =
+      hash_create (ospf_lsdb_index_key, ospf_lsdb_index_cmp);
 
   if (IS_LSA_SELF (lsa))
     lsdb->type[lsa->data->type].count_self++;
@@ -143,13 +203,12 @@ ospf_lsdb_add (struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 #endif /* MONITOR_LSDB_CHANGE */
   lsdb->type[lsa->data->type].checksum += ntohs(lsa->data->checksum);
   rn->info = ospf_lsa_lock (lsa); /* lsdb */
+  hash_get (lsdb->type[lsa->data->type].index, rn, hash_alloc_intern);
 }
 
 void
 ospf_lsdb_delete (struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 {
-  struct route_table *table;
-  struct prefix_ls lp;
   struct route_node *rn;
 
   if (!lsdb)
@@ -169,14 +228,10 @@ ospf_lsdb_delete (struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
     }
   
   assert (lsa->data->type < OSPF_MAX_LSA);
-  table = lsdb->type[lsa->data->type].db;
-  ls_prefix_set (&lp, lsa);
-  if ((rn = route_node_lookup (table, (struct prefix *) &lp)))
-    {
-      if (rn->info == lsa)
-        ospf_lsdb_delete_entry (lsdb, rn);
-      route_unlock_node (rn); /* route_node_lookup */
-    }
+  rn = ospf_lsdb_index_lookup (lsdb, lsa->data->type,
+			       lsa->data->id, lsa->data->adv_router);
+  if (rn && rn->info == lsa)
+    ospf_lsdb_delete_entry (lsdb, rn);
 }
 
 void
@@ -215,48 +270,18 @@ ospf_lsdb_clean_stat (struct ospf_lsdb *lsdb)
 struct ospf_lsa *
 ospf_lsdb_lookup (struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 {
-  struct route_table *table;
-  struct prefix_ls lp;
-  struct route_node *rn;
-  struct ospf_lsa *find;
-
-  table = lsdb->type[lsa->data->type].db;
-  ls_prefix_set (&lp, lsa);
-  rn = route_node_lookup (table, (struct prefix *) &lp);
-  if (rn)
-    {
-      find = rn->info;
-      route_unlock_node (rn);
-      return find;
-    }
-  return NULL;
+  return ospf_lsdb_lookup_by_id (lsdb, lsa->data->type,
+				 lsa->data->id, lsa->data->adv_router);
 }
 
 struct ospf_lsa *
 ospf_lsdb_lookup_by_id (struct ospf_lsdb *lsdb, u_char type,
 		       struct in_addr id, struct in_addr adv_router)
 {
-  struct route_table *table;
-  struct prefix_ls lp;
   struct route_node *rn;
-  struct ospf_lsa *find;
-
-  table = lsdb->type[type].db;
-
-  memset (&lp, 0, sizeof (struct prefix_ls));
-  lp.family = 0;
-  lp.prefixlen = 64;
-  lp.id = id;
-  lp.adv_router = adv_router;
 
-  rn = route_node_lookup (table, (struct prefix *) &lp);
-  if (rn)
-    {
-      find = rn->info;
-      route_unlock_node (rn);
-      return find;
-    }
-  return NULL;
+  rn = ospf_lsdb_index_lookup (lsdb, type, id, adv_router);
+  return rn ? rn->info : NULL;
 }
 
 struct ospf_lsa *
@@ -265,24 +290,18 @@ ospf_lsdb_lookup_by_id_next (struct ospf_lsdb *lsdb, u_char type,
 			    int first)
 {
   struct route_table *table;
-  struct prefix_ls lp;
   struct route_node *rn;
   struct ospf_lsa *find;
 
   table = lsdb->type[type].db;
 
-  memset (&lp, 0, sizeof (struct prefix_ls));
-  lp.family = 0;
-  lp.prefixlen = 64;
-  lp.id = id;
-  lp.adv_router = adv_router;
-
   if (first)
       rn = route_top (table);
   else
     {
-      if ((rn = route_node_lookup (table, (struct prefix *) &lp)) == NULL)
+      if ((rn = ospf_lsdb_index_lookup (lsdb, type, id, adv_router)) == NULL)
         return NULL;
+      route_lock_node (rn); /* for route_next */
       rn = route_next (rn);
     }
 
@@ -32,6 +32,9 @@ struct ospf_lsdb
     unsigned long count_self;
     unsigned int checksum;
     struct route_table *db;
+    /* Nodes of db holding an LSA, hashed by LSA ID and advertising
+       router.  db itself is only walked when order matters. */
+    struct hash *index;
   } type[OSPF_MAX_LSA];
   unsigned long total;
 #define MONITOR_LSDB_CHANGE 1 /* XXX */
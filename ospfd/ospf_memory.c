@@ -38,7 +38,9 @@ DEFINE_MTYPE(OSPFD, OSPF_ROUTE,           "OSPF route")
 DEFINE_MTYPE(OSPFD, OSPF_TMP,             "OSPF tmp mem")
 DEFINE_MTYPE(OSPFD, OSPF_LSA,             "OSPF LSA")
 DEFINE_MTYPE(OSPFD, OSPF_LSA_DATA,        "OSPF LSA data")
+DEFINE_MTYPE(OSPFD, OSPF_LSA_LINK_INDEX,  "OSPF LSA link index")
 DEFINE_MTYPE(OSPFD, OSPF_LSDB,            "OSPF LSDB")
+DEFINE_MTYPE(OSPFD, OSPF_LS_RXMT,         "OSPF LS retransmit")
 DEFINE_MTYPE(OSPFD, OSPF_PACKET,          "OSPF packet")
 DEFINE_MTYPE(OSPFD, OSPF_FIFO,            "OSPF FIFO queue")
 DEFINE_MTYPE(OSPFD, OSPF_VERTEX,          "OSPF vertex")
@@ -37,7 +37,9 @@ DECLARE_MTYPE(OSPF_ROUTE)
 DECLARE_MTYPE(OSPF_TMP)
 DECLARE_MTYPE(OSPF_LSA)
 DECLARE_MTYPE(OSPF_LSA_DATA)
+DECLARE_MTYPE(OSPF_LSA_LINK_INDEX)
 DECLARE_MTYPE(OSPF_LSDB)
+DECLARE_MTYPE(OSPF_LS_RXMT)
 DECLARE_MTYPE(OSPF_PACKET)
 DECLARE_MTYPE(OSPF_FIFO)
 DECLARE_MTYPE(OSPF_VERTEX)
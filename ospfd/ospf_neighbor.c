@@ -96,7 +96,7 @@ ospf_nbr_new (struct ospf_interface *oi)
   nbr->nbr_nbma = NULL;
 
   ospf_lsdb_init (&nbr->db_sum);
-  ospf_lsdb_init (&nbr->ls_rxmt);
+  ospf_ls_retransmit_init (nbr);
   ospf_lsdb_init (&nbr->ls_req);
 
   nbr->crypt_seqnum = 0;
@@ -118,13 +118,11 @@ ospf_nbr_free (struct ospf_neighbor *nbr)
     ospf_ls_request_delete_all (nbr);
 
   /* Free retransmit list. */
-  if (ospf_ls_retransmit_count (nbr))
-    ospf_ls_retransmit_clear (nbr);
+  ospf_ls_retransmit_finish (nbr);
 
   /* Cleanup LSDBs. */
   ospf_lsdb_cleanup (&nbr->db_sum);
   ospf_lsdb_cleanup (&nbr->ls_req);
-  ospf_lsdb_cleanup (&nbr->ls_rxmt);
   
   /* Clear last send packet. */
   if (nbr->last_send)
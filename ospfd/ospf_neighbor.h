@@ -60,7 +60,9 @@ struct ospf_neighbor
   } last_recv;
 
   /* LSA data. */
-  struct ospf_lsdb ls_rxmt;
+  struct hash *ls_rxmt;			/* ls-retransmit list, by LSA key. */
+  struct ospf_ls_rxmt *ls_rxmt_head;	/* ... and in order of due time. */
+  struct ospf_ls_rxmt *ls_rxmt_tail;
   struct ospf_lsdb db_sum;
   struct ospf_lsdb ls_req;
   struct ospf_lsa *ls_req_last;
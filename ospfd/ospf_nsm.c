@@ -42,6 +42,7 @@
 #include "ospfd/ospf_lsdb.h"
 #include "ospfd/ospf_neighbor.h"
 #include "ospfd/ospf_nsm.h"
+#include "ospfd/ospf_spf.h"
 #include "ospfd/ospf_network.h"
 #include "ospfd/ospf_packet.h"
 #include "ospfd/ospf_dump.h"
@@ -736,6 +737,7 @@ nsm_change_state (struct ospf_neighbor *nbr, int state)
 		 LOOKUP(ospf_nsm_state_msg, state));
 
       ospf_router_lsa_update_area (oi->area);
+      ospf_spf_invalidate (oi->area);
 
       if (oi->type == OSPF_IFTYPE_VIRTUALLINK)
 	{
@@ -32,6 +32,7 @@
 #include "stream.h"
 #include "log.h"
 #include "sockopt.h"
+#include "network.h"
 #include "checksum.h"
 #include "md5.h"
 
@@ -502,37 +503,13 @@ ospf_ls_upd_timer (struct thread *thread)
   if (ospf_ls_retransmit_count (nbr) > 0)
     {
       struct list *update;
-      struct ospf_lsdb *lsdb;
-      int i;
-      int retransmit_interval;
 
-      retransmit_interval = OSPF_IF_PARAM (nbr->oi, retransmit_interval);
-
-      lsdb = &nbr->ls_rxmt;
-      update = list_new ();
-
-      for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++)
-	{
-	  struct route_table *table = lsdb->type[i].db;
-	  struct route_node *rn;
-	  
-	  for (rn = route_top (table); rn; rn = route_next (rn))
-	    {
-	      struct ospf_lsa *lsa;
-	      
-	      if ((lsa = rn->info) != NULL)
-		/* Don't retransmit an LSA if we received it within
-		  the last RxmtInterval seconds - this is to allow the
-		  neighbour a chance to acknowledge the LSA as it may
-		  have ben just received before the retransmit timer
-		  fired.  This is a small tweak to what is in the RFC,
-		  but it will cut out out a lot of retransmit traffic
-		  - MAG */
-		if (tv_cmp (tv_sub (recent_relative_time (), lsa->tv_recv), 
-			    int2tv (retransmit_interval)) >= 0)
-		  listnode_add (update, rn->info);
-	    }
-	}
+      /* An LSA is not due until RxmtInterval after it was received or
+	 last retransmitted - this gives the neighbour a chance to
+	 acknowledge an LSA it may have just received before the timer
+	 fired.  This is a small tweak to what is in the RFC, but it
+	 cuts out a lot of retransmit traffic - MAG */
+      update = ospf_ls_retransmit_due (nbr);
 
       if (listcount (update) > 0)
 	ospf_ls_upd_send (nbr, update, OSPF_SEND_PACKET_DIRECT);
@@ -2157,30 +2134,16 @@ ospf_ls_ack (struct ip *iph, struct ospf_header *ospfh,
   return;
 }
 
+/* Check a packet read from the raw socket, and look up the interface it
+   was received on. */
 static struct stream *
-ospf_recv_packet (int fd, struct interface **ifp, struct stream *ibuf)
+ospf_recv_packet_check (struct stream *ibuf, struct msghdr *msgh, int ret,
+                        struct interface **ifp)
 {
-  int ret;
   struct ip *iph;
   u_int16_t ip_len;
   ifindex_t ifindex = 0;
-  struct iovec iov;
-  /* Header and data both require alignment. */
-  char buff [CMSG_SPACE(SOPT_SIZE_CMSG_IFINDEX_IPV4())];
-  struct msghdr msgh;
 
-  memset (&msgh, 0, sizeof (struct msghdr));
-  msgh.msg_iov = &iov;
-  msgh.msg_iovlen = 1;
-  msgh.msg_control = (caddr_t) buff;
-  msgh.msg_controllen = sizeof (buff);
-  
-  ret = stream_recvmsg (ibuf, fd, &msgh, 0, OSPF_MAX_PACKET_SIZE+1);
-  if (ret < 0)
-    {
-      zlog_warn("stream_recvmsg failed: %s", safe_strerror(errno));
-      return NULL;
-    }
   if ((unsigned int)ret < sizeof(iph)) /* ret must be > 0 now */
     {
       zlog_warn("ospf_recv_packet: discarding runt packet of length %d "
@@ -2223,7 +2186,7 @@ ospf_recv_packet (int fd, struct interface **ifp, struct stream *ibuf)
   ip_len = ntohs(iph->ip_len) + (iph->ip_hl << 2);
 #endif
 
-  ifindex = getsockopt_ifindex (AF_INET, &msgh);
+  ifindex = getsockopt_ifindex (AF_INET, msgh);
   
   *ifp = if_lookup_by_index (ifindex);
 
@@ -2237,6 +2200,81 @@ ospf_recv_packet (int fd, struct interface **ifp, struct stream *ibuf)
   return ibuf;
 }
 
+static struct stream *
+ospf_recv_packet (int fd, struct interface **ifp, struct stream *ibuf)
+{
+  int ret;
+  struct iovec iov;
+  /* Header and data both require alignment. */
+  char buff [CMSG_SPACE(SOPT_SIZE_CMSG_IFINDEX_IPV4())];
+  struct msghdr msgh;
+
+  memset (&msgh, 0, sizeof (struct msghdr));
+  msgh.msg_iov = &iov;
+  msgh.msg_iovlen = 1;
+  msgh.msg_control = (caddr_t) buff;
+  msgh.msg_controllen = sizeof (buff);
+  
+  ret = stream_recvmsg (ibuf, fd, &msgh, 0, OSPF_MAX_PACKET_SIZE+1);
+  if (ret < 0)
+    {
+      zlog_warn("stream_recvmsg failed: %s", safe_strerror(errno));
+      return NULL;
+    }
+
+  return ospf_recv_packet_check (ibuf, &msgh, ret, ifp);
+}
+
+#ifdef HAVE_RECVMMSG
+/* Read the packets waiting on the raw socket, up to one per buffer, in
+   a single system call.  Buffers holding a packet that fails the checks
+   are set to NULL.  Returns the number of buffers used. */
+static int
+ospf_recv_packets (int fd, struct interface **ifp, struct stream **ibuf,
+                   int count)
+{
+  int i, ret;
+  struct iovec iov[OSPF_READ_BATCH];
+  /* Header and data both require alignment. */
+  char buff[OSPF_READ_BATCH][CMSG_SPACE(SOPT_SIZE_CMSG_IFINDEX_IPV4())];
+  struct mmsghdr msgs[OSPF_READ_BATCH];
+
+  assert (count <= OSPF_READ_BATCH);
+
+  memset (msgs, 0, sizeof (msgs));
+  for (i = 0; i < count; i++)
+    {
+      stream_reset (ibuf[i]);
+      iov[i].iov_base = STREAM_DATA (ibuf[i]);
+      iov[i].iov_len = OSPF_MAX_PACKET_SIZE+1;
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      msgs[i].msg_hdr.msg_control = (caddr_t) buff[i];
+      msgs[i].msg_hdr.msg_controllen = sizeof (buff[i]);
+    }
+
+  /* The socket is readable, so at least one packet is waiting; do not
+     block for the others. */
+  ret = recvmmsg (fd, msgs, count, MSG_DONTWAIT, NULL);
+  if (ret < 0)
+    {
+      if (!ERRNO_IO_RETRY (errno))
+        zlog_warn("recvmmsg failed: %s", safe_strerror(errno));
+      return -1;
+    }
+
+  for (i = 0; i < ret; i++)
+    {
+      ifp[i] = NULL;
+      stream_set_endp (ibuf[i], msgs[i].msg_len);
+      ibuf[i] = ospf_recv_packet_check (ibuf[i], &msgs[i].msg_hdr,
+                                        msgs[i].msg_len, &ifp[i]);
+    }
+
+  return ret;
+}
+#endif /* HAVE_RECVMMSG */
+
 static struct ospf_interface *
 ospf_associate_packet_vl (struct ospf *ospf, struct interface *ifp, 
 			  struct ip *iph, struct ospf_header *ospfh)
@@ -2760,28 +2798,17 @@ ospf_verify_header (struct stream *ibuf, struct ospf_interface *oi,
   return 0;
 }
 
-/* Starting point of packet process function. */
-int
-ospf_read (struct thread *thread)
+/* Process a packet read from the raw socket. */
+static int
+ospf_read_packet (struct ospf *ospf, struct stream *ibuf,
+                  struct interface *ifp)
 {
   int ret;
-  struct stream *ibuf;
-  struct ospf *ospf;
   struct ospf_interface *oi;
   struct ip *iph;
   struct ospf_header *ospfh;
   u_int16_t length;
-  struct interface *ifp;
-
-  /* first of all get interface pointer. */
-  ospf = THREAD_ARG (thread);
-
-  /* prepare for next packet. */
-  ospf->t_read = thread_add_read (master, ospf_read, ospf, ospf->fd);
 
-  stream_reset(ospf->ibuf);
-  if (!(ibuf = ospf_recv_packet (ospf->fd, &ifp, ospf->ibuf)))
-    return -1;
   /* This raw packet is known to be at least as big as its IP header. */
   
   /* Note that there should not be alignment problems with this assignment
@@ -2983,6 +3010,39 @@ ospf_read (struct thread *thread)
   return 0;
 }
 
+/* Starting point of packet process function. */
+int
+ospf_read (struct thread *thread)
+{
+  struct ospf *ospf;
+  struct stream *ibuf[OSPF_READ_BATCH];
+  struct interface *ifp[OSPF_READ_BATCH];
+  int i, count;
+
+  /* first of all get interface pointer. */
+  ospf = THREAD_ARG (thread);
+
+  /* prepare for next packet. */
+  ospf->t_read = thread_add_read (master, ospf_read, ospf, ospf->fd);
+
+  memcpy (ibuf, ospf->ibuf, sizeof (ibuf));
+
+#ifdef HAVE_RECVMMSG
+  count = ospf_recv_packets (ospf->fd, ifp, ibuf, OSPF_READ_BATCH);
+#else
+  count = 1;
+  stream_reset (ibuf[0]);
+  ibuf[0] = ospf_recv_packet (ospf->fd, &ifp[0], ibuf[0]);
+#endif /* HAVE_RECVMMSG */
+
+  /* Packets are processed in the order they were read. */
+  for (i = 0; i < count; i++)
+    if (ibuf[i])
+      ospf_read_packet (ospf, ibuf[i], ifp[i]);
+
+  return 0;
+}
+
 /* Make OSPF header. */
 static void
 ospf_make_header (int type, struct ospf_interface *oi, struct stream *s)
@@ -3300,10 +3360,12 @@ ls_age_increment (struct ospf_lsa *lsa, int delay)
 }
 
 static int
-ospf_make_ls_upd (struct ospf_interface *oi, struct list *update, struct stream *s)
+ospf_make_ls_upd (struct ospf_interface *oi, struct ospf_lsdb *update,
+                  struct stream *s)
 {
   struct ospf_lsa *lsa;
-  struct listnode *node;
+  struct route_node *rn;
+  int i;
   u_int16_t length = 0;
   unsigned int size_noauth;
   unsigned long delta = stream_get_endp (s);
@@ -3320,41 +3382,46 @@ ospf_make_ls_upd (struct ospf_interface *oi, struct list *update, struct stream
   /* Calculate amount of packet usable for data. */
   size_noauth = stream_get_size(s) - ospf_packet_authspace(oi);
 
-  while ((node = listhead (update)) != NULL)
-    {
-      struct lsa_header *lsah;
-      u_int16_t ls_age;
+  for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++)
+    for (rn = route_top (update->type[i].db); rn; rn = route_next (rn))
+      {
+        struct lsa_header *lsah;
+        u_int16_t ls_age;
 
-      if (IS_DEBUG_OSPF_EVENT)
-        zlog_debug ("ospf_make_ls_upd: List Iteration %d", count);
+        if ((lsa = rn->info) == NULL)
+          continue;
 
-      lsa = listgetdata (node);
+        if (IS_DEBUG_OSPF_EVENT)
+          zlog_debug ("ospf_make_ls_upd: List Iteration %d", count);
 
-      assert (lsa->data);
+        assert (lsa->data);
 
-      /* Will it fit? */
-      if (length + delta + ntohs (lsa->data->length) > size_noauth)
-        break;
+        /* Will it fit? */
+        if (length + delta + ntohs (lsa->data->length) > size_noauth)
+          {
+            route_unlock_node (rn);
+            goto full;
+          }
 
-      /* Keep pointer to LS age. */
-      lsah = (struct lsa_header *) (STREAM_DATA (s) + stream_get_endp (s));
+        /* Keep pointer to LS age. */
+        lsah = (struct lsa_header *) (STREAM_DATA (s) + stream_get_endp (s));
 
-      /* Put LSA to Link State Request. */
-      stream_put (s, lsa->data, ntohs (lsa->data->length));
+        /* Put LSA to Link State Request. */
+        stream_put (s, lsa->data, ntohs (lsa->data->length));
 
-      /* Set LS age. */
-      /* each hop must increment an lsa_age by transmit_delay 
-         of OSPF interface */
-      ls_age = ls_age_increment (lsa, OSPF_IF_PARAM (oi, transmit_delay));
-      lsah->ls_age = htons (ls_age);
+        /* Set LS age. */
+        /* each hop must increment an lsa_age by transmit_delay 
+           of OSPF interface */
+        ls_age = ls_age_increment (lsa, OSPF_IF_PARAM (oi, transmit_delay));
+        lsah->ls_age = htons (ls_age);
 
-      length += ntohs (lsa->data->length);
-      count++;
+        length += ntohs (lsa->data->length);
+        count++;
 
-      list_delete_node (update, node);
-      ospf_lsa_unlock (&lsa); /* oi->ls_upd_queue */
-    }
+        ospf_lsdb_delete (update, lsa); /* oi->ls_upd_queue */
+      }
 
+ full:
   /* Now set #LSAs. */
   stream_putl_at (s, pp, count);
 
@@ -3654,6 +3721,25 @@ ospf_ls_upd_send_lsa (struct ospf_neighbor *nbr, struct ospf_lsa *lsa,
   list_delete (update);
 }
 
+/* The LSA to be sent first from an update queue: ospf_make_ls_upd() takes
+ * them in the same order. */
+static struct ospf_lsa *
+ospf_ls_upd_queue_head (struct ospf_lsdb *update)
+{
+  struct route_node *rn;
+  int i;
+
+  for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++)
+    for (rn = route_top (update->type[i].db); rn; rn = route_next (rn))
+      if (rn->info != NULL)
+        {
+          route_unlock_node (rn);
+          return rn->info;
+        }
+
+  return NULL;
+}
+
 /* Determine size for packet. Must be at least big enough to accomodate next
  * LSA on list, which may be bigger than MTU size.
  *
@@ -3662,14 +3748,13 @@ ospf_ls_upd_send_lsa (struct ospf_neighbor *nbr, struct ospf_lsa *lsa,
  * on packet sizes (in which case offending LSA is deleted from update list)
  */
 static struct ospf_packet *
-ospf_ls_upd_packet_new (struct list *update, struct ospf_interface *oi)
+ospf_ls_upd_packet_new (struct ospf_lsdb *update, struct ospf_interface *oi)
 {
   struct ospf_lsa *lsa;
-  struct listnode *ln;
   size_t size;
   static char warned = 0;
 
-  lsa = listgetdata((ln = listhead (update)));
+  lsa = ospf_ls_upd_queue_head (update);
   assert (lsa->data);
 
   if ((OSPF_LS_UPD_MIN_SIZE + ntohs (lsa->data->length))
@@ -3708,7 +3793,7 @@ ospf_ls_upd_packet_new (struct list *update, struct ospf_interface *oi)
                  " OSPF routing is broken!",
                  inet_ntoa (lsa->data->id), ntohs (lsa->data->length),
                  (long int) size);
-      list_delete_node (update, ln);
+      ospf_lsdb_delete (update, lsa);
       return NULL;
     }
 
@@ -3725,17 +3810,19 @@ ospf_ls_upd_packet_new (struct list *update, struct ospf_interface *oi)
 }
 
 static void
-ospf_ls_upd_queue_send (struct ospf_interface *oi, struct list *update,
+ospf_ls_upd_queue_send (struct ospf_interface *oi, struct ospf_lsdb *update,
 			struct in_addr addr)
 {
   struct ospf_packet *op;
   u_int16_t length = OSPF_HEADER_SIZE;
 
   if (IS_DEBUG_OSPF_EVENT)
-    zlog_debug ("listcount = %d, [%s]dst %s", listcount (update), IF_NAME(oi),
-			    inet_ntoa(addr));
+    zlog_debug ("listcount = %lu, [%s]dst %s", ospf_lsdb_count_all (update),
+                IF_NAME(oi), inet_ntoa(addr));
   
   op = ospf_ls_upd_packet_new (update, oi);
+  if (op == NULL)
+    return;
 
   /* Prepare OSPF common header. */
   ospf_make_header (OSPF_MSG_LS_UPD, oi, op->s);
@@ -3770,7 +3857,7 @@ ospf_ls_upd_send_queue_event (struct thread *thread)
   struct ospf_interface *oi = THREAD_ARG(thread);
   struct route_node *rn;
   struct route_node *rnext;
-  struct list *update;
+  struct ospf_lsdb *update;
   char again = 0;
   
   oi->t_ls_upd_event = NULL;
@@ -3785,14 +3872,14 @@ ospf_ls_upd_send_queue_event (struct thread *thread)
       if (rn->info == NULL)
         continue;
       
-      update = (struct list *)rn->info;
+      update = (struct ospf_lsdb *)rn->info;
 
       ospf_ls_upd_queue_send (oi, update, rn->p.u.prefix4);
       
       /* list might not be empty. */
-      if (listcount(update) == 0)
+      if (ospf_lsdb_count_all (update) == 0)
         {
-          list_delete (rn->info);
+          ospf_lsdb_free (update);
           rn->info = NULL;
           route_unlock_node (rn);
         }
@@ -3854,12 +3941,20 @@ ospf_ls_upd_send (struct ospf_neighbor *nbr, struct list *update, int flag)
   rn = route_node_get (oi->ls_upd_queue, (struct prefix *) &p);
 
   if (rn->info == NULL)
-    rn->info = list_new ();
+    rn->info = ospf_lsdb_new ();
   else
     route_unlock_node (rn);
 
+  /* An LSA queued for the same destination more than once, e.g. when
+     several neighbours on the network request it, is sent once: only
+     the most recent instance is kept. */
   for (ALL_LIST_ELEMENTS_RO (update, node, lsa))
-    listnode_add (rn->info, ospf_lsa_lock (lsa)); /* oi->ls_upd_queue */
+    {
+      struct ospf_lsa *queued = ospf_lsdb_lookup (rn->info, lsa);
+
+      if (queued == NULL || ospf_lsa_more_recent (queued, lsa) <= 0)
+        ospf_lsdb_add (rn->info, lsa); /* oi->ls_upd_queue */
+    }
 
   if (oi->t_ls_upd_event == NULL)
     oi->t_ls_upd_event =
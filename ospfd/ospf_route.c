@@ -30,6 +30,7 @@
 #include "if.h"
 #include "command.h"
 #include "sockunion.h"
+#include "zclient.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_interface.h"
@@ -62,6 +63,22 @@ ospf_route_free (struct ospf_route *or)
   XFREE (MTYPE_OSPF_ROUTE, or);
 }
 
+/* Copy a route, with its own list of paths. */
+struct ospf_route *
+ospf_route_dup (struct ospf_route *or)
+{
+  struct ospf_route *new;
+  struct list *paths;
+
+  new = ospf_route_new ();
+  paths = new->paths;
+  memcpy (new, or, sizeof (struct ospf_route));
+  new->paths = paths;
+  ospf_route_copy_nexthops (new, or->paths);
+
+  return new;
+}
+
 struct ospf_path *
 ospf_path_new ()
 {
@@ -124,28 +141,37 @@ ospf_route_table_free (struct route_table *rt)
    route_table_finish (rt);
 }
 
-/* If a prefix exists in the new routing table, then return 1,
-   otherwise return 0. Since the ZEBRA-RIB does an implicit
-   withdraw, it is not necessary to send a delete, an add later
-   will act like an implicit delete. */
+/* If two routes to the same prefix have the same type, cost and
+   nexthops, then return 1, otherwise return 0. */
 static int
-ospf_route_exist_new_table (struct route_table *rt, struct prefix_ipv4 *prefix)
+ospf_route_same (struct ospf_route *or, struct ospf_route *newor)
 {
-  struct route_node *rn;
-
-  assert (rt);
-  assert (prefix);
-
-  rn = route_node_lookup (rt, (struct prefix *) prefix);
-  if (!rn) {
-    return 0;
-  }
-  route_unlock_node (rn);
+  struct ospf_path *op;
+  struct ospf_path *newop;
+  struct listnode *n1;
+  struct listnode *n2;
 
-  if (!rn->info) {
+  if (or->type != newor->type || or->cost != newor->cost)
     return 0;
-  }
 
+  if (or->type == OSPF_DESTINATION_NETWORK)
+    {
+      if (or->paths->count != newor->paths->count)
+	return 0;
+
+      /* Check each path. */
+      for (n1 = listhead (or->paths), n2 = listhead (newor->paths);
+	   n1 && n2; n1 = listnextnode (n1), n2 = listnextnode (n2))
+	{ 
+	  op = listgetdata (n1);
+	  newop = listgetdata (n2);
+
+	  if (! IPV4_ADDR_SAME (&op->nexthop, &newop->nexthop))
+	    return 0;
+	  if (op->ifindex != newop->ifindex)
+	    return 0;
+	}
+    }
   return 1;
 }
 
@@ -156,11 +182,6 @@ ospf_route_match_same (struct route_table *rt, struct prefix_ipv4 *prefix,
 		       struct ospf_route *newor)
 {
   struct route_node *rn;
-  struct ospf_route *or;
-  struct ospf_path *op;
-  struct ospf_path *newop;
-  struct listnode *n1;
-  struct listnode *n2;
 
   if (! rt || ! prefix)
     return 0;
@@ -171,32 +192,7 @@ ospf_route_match_same (struct route_table *rt, struct prefix_ipv4 *prefix,
  
    route_unlock_node (rn);
 
-   or = rn->info;
-   if (or->type == newor->type && or->cost == newor->cost)
-     {
-       if (or->type == OSPF_DESTINATION_NETWORK)
-	 {
-	   if (or->paths->count != newor->paths->count)
-	     return 0;
-
-	   /* Check each path. */
-	   for (n1 = listhead (or->paths), n2 = listhead (newor->paths);
-		n1 && n2; n1 = listnextnode (n1), n2 = listnextnode (n2))
-	     { 
-	       op = listgetdata (n1);
-	       newop = listgetdata (n2);
-
-	       if (! IPV4_ADDR_SAME (&op->nexthop, &newop->nexthop))
-		 return 0;
-	       if (op->ifindex != newop->ifindex)
-		 return 0;
-	     }
-	   return 1;
-	 }
-       else if (prefix_same (&rn->p, (struct prefix *) prefix))
-	 return 1;
-     }
-  return 0;
+   return ospf_route_same (rn->info, newor);
 }
 
 /* delete routes generated from AS-External routes if there is a inter/intra
@@ -232,37 +228,60 @@ ospf_route_delete_same_ext(struct route_table *external_routes,
     }
 }
 
-/* rt: Old, cmprt: New */
-static void
-ospf_route_delete_uniq (struct route_table *rt, struct route_table *cmprt)
+/* The first node from RN on, in table order, that holds a route. */
+static struct route_node *
+ospf_route_next_info (struct route_node *rn)
 {
-  struct route_node *rn;
-  struct ospf_route *or;
+  while (rn && ! rn->info)
+    rn = route_next (rn);
+  return rn;
+}
 
-  for (rn = route_top (rt); rn; rn = route_next (rn))
-    if ((or = rn->info) != NULL) 
-      if (or->path_type == OSPF_PATH_INTRA_AREA ||
-	  or->path_type == OSPF_PATH_INTER_AREA)
-	{
-	  if (or->type == OSPF_DESTINATION_NETWORK)
-	    {
-	      if (! ospf_route_exist_new_table (cmprt,
-					   (struct prefix_ipv4 *) &rn->p))
-		ospf_zebra_delete ((struct prefix_ipv4 *) &rn->p, or);
-	    }
-	  else if (or->type == OSPF_DESTINATION_DISCARD)
-	    if (! ospf_route_exist_new_table (cmprt,
-					 (struct prefix_ipv4 *) &rn->p))
-	      ospf_zebra_delete_discard ((struct prefix_ipv4 *) &rn->p);
-	}
+/* Withdraw a route of the old table that is not in the new one.  Since
+   the ZEBRA-RIB does an implicit withdraw, routes to prefixes that
+   are still reachable are simply added again instead. */
+static int
+ospf_route_withdraw (struct route_node *rn)
+{
+  struct ospf_route *or = rn->info;
+
+  if (or->path_type != OSPF_PATH_INTRA_AREA &&
+      or->path_type != OSPF_PATH_INTER_AREA)
+    return 0;
+
+  if (or->type == OSPF_DESTINATION_NETWORK)
+    ospf_zebra_delete ((struct prefix_ipv4 *) &rn->p, or);
+  else if (or->type == OSPF_DESTINATION_DISCARD)
+    ospf_zebra_delete_discard ((struct prefix_ipv4 *) &rn->p);
+  else
+    return 0;
+  return 1;
 }
 
-/* Install routes to table. */
-void
+static int
+ospf_route_announce (struct route_node *rn)
+{
+  struct ospf_route *or = rn->info;
+
+  if (or->type == OSPF_DESTINATION_NETWORK)
+    ospf_zebra_add ((struct prefix_ipv4 *) &rn->p, or);
+  else if (or->type == OSPF_DESTINATION_DISCARD)
+    ospf_zebra_add_discard ((struct prefix_ipv4 *) &rn->p);
+  else
+    return 0;
+  return 1;
+}
+
+/* Install routes to table.  The old and new tables are walked together
+   in prefix order, so only the routes that differ are looked at more
+   closely, and the messages for them are written to zebra together.
+   Returns the number of routes added, changed or withdrawn. */
+unsigned long
 ospf_route_install (struct ospf *ospf, struct route_table *rt)
 {
-  struct route_node *rn;
-  struct ospf_route *or;
+  struct route_node *rn, *old_rn;
+  unsigned long changes = 0;
+  int cmp;
 
   /* rt contains new routing table, new_table contains an old one.
      updating pointers */
@@ -272,27 +291,95 @@ ospf_route_install (struct ospf *ospf, struct route_table *rt)
   ospf->old_table = ospf->new_table;
   ospf->new_table = rt;
 
-  /* Delete old routes. */
-  if (ospf->old_table)
-    ospf_route_delete_uniq (ospf->old_table, rt);
+  zclient_batch_begin (zclient);
+
+  /* Delete routes to the new table's prefixes learnt from AS-external
+     routes before any of them is added. */
   if (ospf->old_external_route)
     ospf_route_delete_same_ext (ospf->old_external_route, rt);
 
-  /* Install new routes. */
-  for (rn = route_top (rt); rn; rn = route_next (rn))
-    if ((or = rn->info) != NULL)
-      {
-	if (or->type == OSPF_DESTINATION_NETWORK)
-	  {
-	    if (! ospf_route_match_same (ospf->old_table,
-					 (struct prefix_ipv4 *)&rn->p, or))
-	      ospf_zebra_add ((struct prefix_ipv4 *) &rn->p, or);
-	  }
-	else if (or->type == OSPF_DESTINATION_DISCARD)
-	  if (! ospf_route_match_same (ospf->old_table,
-				       (struct prefix_ipv4 *) &rn->p, or))
-	    ospf_zebra_add_discard ((struct prefix_ipv4 *) &rn->p);
-      }
+  rn = ospf_route_next_info (route_top (rt));
+  old_rn = NULL;
+  if (ospf->old_table)
+    old_rn = ospf_route_next_info (route_top (ospf->old_table));
+
+  while (rn || old_rn)
+    {
+      if (! rn)
+	cmp = -1;
+      else if (! old_rn)
+	cmp = 1;
+      else
+	cmp = route_table_prefix_iter_cmp (&old_rn->p, &rn->p);
+
+      if (cmp < 0)
+	changes += ospf_route_withdraw (old_rn);
+      else if (cmp > 0)
+	changes += ospf_route_announce (rn);
+      else if (! ospf_route_same (old_rn->info, rn->info))
+	changes += ospf_route_announce (rn);
+
+      if (cmp <= 0)
+	old_rn = ospf_route_next_info (route_next (old_rn));
+      if (cmp >= 0)
+	rn = ospf_route_next_info (route_next (rn));
+    }
+
+  zclient_batch_end (zclient);
+
+  return changes;
+}
+
+/* Replace the route to P in the current routing table with OR, or with
+   nothing if OR is NULL, and install the difference: ospf_route_install()
+   for a single prefix.  Returns 1 if the route changed. */
+int
+ospf_route_install_prefix (struct ospf *ospf, struct prefix_ipv4 *p,
+			   struct ospf_route *or)
+{
+  struct route_node *rn, *ext_rn;
+  struct ospf_route *old;
+  int changed;
+
+  rn = route_node_get (ospf->new_table, (struct prefix *) p);
+  old = rn->info;
+
+  if (or)
+    changed = ! ospf_route_match_same (ospf->new_table, p, or);
+  else
+    changed = (old != NULL);
+
+  if (or && changed)
+    {
+      /* As ospf_route_delete_same_ext(). */
+      if (ospf->old_external_route
+	  && (ext_rn = route_node_lookup (ospf->old_external_route,
+					  (struct prefix *) p)))
+	{
+	  if (ext_rn->info)
+	    {
+	      ospf_zebra_delete (p, ext_rn->info);
+	      ospf_route_free (ext_rn->info);
+	      ext_rn->info = NULL;
+	      route_unlock_node (ext_rn);
+	    }
+	  route_unlock_node (ext_rn);
+	}
+      ospf_zebra_add (p, or);
+    }
+  else if (old && ! or)
+    ospf_zebra_delete (p, old);
+
+  if (old)
+    {
+      ospf_route_free (old);
+      route_unlock_node (rn);
+    }
+  rn->info = or;
+  if (! or)
+    route_unlock_node (rn);
+
+  return changed;
 }
 
 /* RFC2328 16.1. (4). For "router". */
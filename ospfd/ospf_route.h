@@ -121,10 +121,13 @@ extern void ospf_path_free (struct ospf_path *);
 extern struct ospf_path *ospf_path_lookup (struct list *, struct ospf_path *);
 extern struct ospf_route *ospf_route_new (void);
 extern void ospf_route_free (struct ospf_route *);
+extern struct ospf_route *ospf_route_dup (struct ospf_route *);
 extern void ospf_route_delete (struct route_table *);
 extern void ospf_route_table_free (struct route_table *);
 
-extern void ospf_route_install (struct ospf *, struct route_table *);
+extern unsigned long ospf_route_install (struct ospf *, struct route_table *);
+extern int ospf_route_install_prefix (struct ospf *, struct prefix_ipv4 *,
+				      struct ospf_route *);
 extern void ospf_route_table_dump (struct route_table *);
 
 extern void ospf_intra_add_router (struct route_table *, struct vertex *,
@@ -23,6 +23,7 @@ Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
 #include "thread.h"
 #include "memory.h"
 #include "hash.h"
+#include "jhash.h"
 #include "linklist.h"
 #include "prefix.h"
 #include "if.h"
@@ -89,13 +90,6 @@ ospf_get_spf_reason_str (char *buf)
     }
 }
 
-static void ospf_vertex_free (void *);
-/* List of allocated vertices, to simplify cleanup of SPF.
- * Not thread-safe obviously. If it ever needs to be, it'd have to be
- * dynamically allocated at begin of ospf_spf_calculate
- */
-static struct list vertex_list = { .del = ospf_vertex_free };
-
 /* Heap related functions, for the managment of the candidates, to
  * be used with pqueue. */
 static int
@@ -146,37 +140,34 @@ vertex_nexthop_free (struct vertex_nexthop *nh)
   XFREE (MTYPE_OSPF_NEXTHOP, nh);
 }
 
-/* Free the canonical nexthop objects for an area, ie the nexthop objects
- * attached to the first-hop router vertices, and any intervening network
- * vertices.
+/* Free the canonical nexthop objects of a vertex, ie the nexthop objects
+ * made for it by ospf_nexthop_calculation() when its parent is the root, or
+ * a network attached to the root.  Any other nexthop of the vertex is
+ * inherited from its parents, which own it.
  */
 static void
-ospf_canonical_nexthops_free (struct vertex *root)
+ospf_vertex_nexthops_free (struct vertex *root, struct vertex *v)
 {
-  struct listnode *node, *nnode;
-  struct vertex *child;
-  
-  for (ALL_LIST_ELEMENTS (root->children, node, nnode, child))
+  struct listnode *node, *n2;
+  struct vertex_parent *vp, *pp;
+
+  for (ALL_LIST_ELEMENTS_RO (v->parents, node, vp))
     {
-      struct listnode *n2, *nn2;
-      struct vertex_parent *vp;
-      
-      /* router vertices through an attached network each
-       * have a distinct (canonical / not inherited) nexthop
-       * which must be freed.
-       *
-       * A network vertex can only have router vertices as its
-       * children, so only one level of recursion is possible.
-       */
-      if (child->type == OSPF_VERTEX_NETWORK)
-        ospf_canonical_nexthops_free (child);
-      
-      /* Free child nexthops pointing back to this root vertex */
-      for (ALL_LIST_ELEMENTS (child->parents, n2, nn2, vp))
-        if (vp->parent == root && vp->nexthop)
-          vertex_nexthop_free (vp->nexthop);
+      if (vp->parent == root)
+        vertex_nexthop_free (vp->nexthop);
+      else if (vp->parent->type == OSPF_VERTEX_NETWORK)
+        /* router vertices through an attached network each
+         * have a distinct (canonical / not inherited) nexthop
+         * which must be freed.
+         */
+        for (ALL_LIST_ELEMENTS_RO (vp->parent->parents, n2, pp))
+          if (pp->parent == root)
+            {
+              vertex_nexthop_free (vp->nexthop);
+              break;
+            }
     }
-}      
+}
 
 /* TODO: Parent list should be excised, in favour of maintaining only
  * vertex_nexthop, with refcounts.
@@ -215,12 +206,11 @@ ospf_vertex_new (struct ospf_lsa *lsa)
   new->type = lsa->data->type;
   new->id = lsa->data->id;
   new->lsa = lsa->data;
+  new->lsa_p = ospf_lsa_lock (lsa);
   new->children = list_new ();
   new->parents = list_new ();
   new->parents->del = vertex_parent_free;
   
-  listnode_add (&vertex_list, new);
-  
   if (IS_DEBUG_OSPF_EVENT)
     zlog_debug ("%s: Created %s vertex %s", __func__,
                 new->type == OSPF_VERTEX_ROUTER ? "Router" : "Network",
@@ -253,6 +243,7 @@ ospf_vertex_free (void *data)
   v->parents = NULL;
   
   v->lsa = NULL;
+  ospf_lsa_unlock (&v->lsa_p);
   
   XFREE (MTYPE_OSPF_VERTEX, v);
 }
@@ -320,29 +311,108 @@ ospf_vertex_add_parent (struct vertex *v)
     }
 }
 
+static unsigned int
+ospf_vertex_hash_key (void *data)
+{
+  struct vertex *v = data;
+
+  return jhash_2words (v->type, v->id.s_addr, 0);
+}
+
+static int
+ospf_vertex_hash_cmp (const void *data1, const void *data2)
+{
+  const struct vertex *v1 = data1;
+  const struct vertex *v2 = data2;
+
+  return v1->type == v2->type && IPV4_ADDR_SAME (&v1->id, &v2->id);
+}
+
+/* Find the vertex for an LSA in the shortest-path tree kept for an area. */
+static struct vertex *
+ospf_vertex_lookup (struct ospf_area *area, u_char type, struct in_addr id)
+{
+  struct vertex key;
+
+  key.type = type;
+  key.id = id;
+  return hash_lookup (area->spf_vertex_hash, &key);
+}
+
+/* Add a vertex to the shortest-path tree kept for an area. */
+static void
+ospf_spf_tree_add (struct ospf_area *area, struct vertex *v)
+{
+  listnode_add (area->spf_vertices, v);
+  hash_get (area->spf_vertex_hash, v, hash_alloc_intern);
+}
+
+static void
+ospf_spf_tree_free (struct ospf_area *area)
+{
+  struct listnode *node;
+  struct vertex *v;
+
+  if (area->spf_vertices == NULL)
+    return;
+
+  /* Nexthops first, as freeing them looks at the parents of parents. */
+  for (ALL_LIST_ELEMENTS_RO (area->spf_vertices, node, v))
+    ospf_vertex_nexthops_free (area->spf, v);
+
+  hash_clean (area->spf_vertex_hash, NULL);
+  hash_free (area->spf_vertex_hash);
+  area->spf_vertex_hash = NULL;
+
+  list_delete (area->spf_vertices);
+  area->spf_vertices = NULL;
+  area->spf = NULL;
+}
+
+static void
+ospf_spf_changes_clear (struct ospf_area *area)
+{
+  struct listnode *node, *nnode;
+  struct ospf_lsa *lsa;
+
+  if (area->spf_changes == NULL)
+    return;
+
+  for (ALL_LIST_ELEMENTS (area->spf_changes, node, nnode, lsa))
+    ospf_lsa_unlock (&lsa);
+  list_delete_all_node (area->spf_changes);
+}
+
 static void
 ospf_spf_init (struct ospf_area *area)
 {
   struct vertex *v;
   
+  area->spf_vertices = list_new ();
+  area->spf_vertices->del = ospf_vertex_free;
+  area->spf_vertex_hash = hash_create (ospf_vertex_hash_key,
+                                       ospf_vertex_hash_cmp);
+
   /* Create root node. */
   v = ospf_vertex_new (area->router_lsa_self);
   
   area->spf = v;
-
-  /* Reset ABR and ASBR router counts. */
-  area->abr_count = 0;
-  area->asbr_count = 0;
+  ospf_spf_tree_add (area, v);
 }
 
 /* return index of link back to V from W, or -1 if no link found */
 static int
-ospf_lsa_has_link (struct lsa_header *w, struct lsa_header *v)
+ospf_lsa_has_link (struct ospf_lsa *w_lsa, struct lsa_header *v)
 {
+  struct lsa_header *w = w_lsa->data;
   unsigned int i, length;
   struct router_lsa *rl;
   struct network_lsa *nl;
 
+  /* Installed router- and network-LSAs have their links indexed. */
+  if (w_lsa->link_index)
+    return ospf_lsa_link_index_lookup (w_lsa, v->type, v->id);
+
   /* In case of W is Network LSA. */
   if (w->type == OSPF_NETWORK_LSA)
     {
@@ -513,7 +583,7 @@ ospf_spf_add_parent (struct vertex *v, struct vertex *w,
         }
     }
 
-  vp = vertex_parent_new (v, ospf_lsa_has_link (w->lsa, v->lsa), newhop);
+  vp = vertex_parent_new (v, ospf_lsa_has_link (w->lsa_p, v->lsa), newhop);
   listnode_add (w->parents, vp);
 
   return;
@@ -906,7 +976,7 @@ ospf_spf_next (struct vertex *v, struct ospf_area *area,
           continue;
         }
 
-      if (ospf_lsa_has_link (w_lsa->data, v->lsa) < 0 )
+      if (ospf_lsa_has_link (w_lsa, v->lsa) < 0 )
         {
           if (IS_DEBUG_OSPF_EVENT)
             zlog_debug ("The LSA doesn't have a link back");
@@ -943,8 +1013,12 @@ ospf_spf_next (struct vertex *v, struct ospf_area *area,
           /* Calculate nexthop to W. */
           if (ospf_nexthop_calculation (area, v, w, l, distance, lsa_pos))
             pqueue_enqueue (w, candidate);
-          else if (IS_DEBUG_OSPF_EVENT)
-            zlog_debug ("Nexthop Calc failed");
+          else
+            {
+              if (IS_DEBUG_OSPF_EVENT)
+                zlog_debug ("Nexthop Calc failed");
+              ospf_vertex_free (w);
+            }
 	}
       else if (w_lsa->stat >= 0)
 	{
@@ -1174,6 +1248,302 @@ ospf_rtrs_print (struct route_table *rtrs)
 }
 #endif
 
+/* The LSA of a vertex, as ospf_spf_next() would find it. */
+static struct ospf_lsa *
+ospf_spf_lsa_lookup (struct ospf_area *area, u_char type, struct in_addr id)
+{
+  struct ospf_lsa *lsa;
+
+  lsa = ospf_lsa_lookup_by_id (area, type, id);
+  if (lsa == NULL || IS_LSA_MAXAGE (lsa))
+    return NULL;
+  return lsa;
+}
+
+static struct router_lsa_link *
+ospf_spf_transit_next (u_char **p, u_char *lim)
+{
+  struct router_lsa_link *l;
+
+  while (*p < lim)
+    {
+      l = (struct router_lsa_link *) *p;
+      *p += (OSPF_ROUTER_LSA_LINK_SIZE +
+             (l->m[0].tos_count * OSPF_ROUTER_LSA_TOS_SIZE));
+      if (l->m[0].type != LSA_LINK_TYPE_STUB)
+        return l;
+    }
+  return NULL;
+}
+
+/* Whether two instances of a router- or network-LSA have the same links
+ * to other vertices, in which case the tree through them is the same.
+ * Links to stub networks only matter to the second stage.
+ */
+static int
+ospf_spf_transit_same (struct lsa_header *l1, struct lsa_header *l2)
+{
+  u_char *p1, *p2, *lim1, *lim2;
+  struct router_lsa_link *k1, *k2;
+
+  if (l1->type == OSPF_NETWORK_LSA)
+    return l1->length == l2->length
+           && memcmp ((u_char *) l1 + OSPF_LSA_HEADER_SIZE,
+                      (u_char *) l2 + OSPF_LSA_HEADER_SIZE,
+                      ntohs (l1->length) - OSPF_LSA_HEADER_SIZE) == 0;
+
+  p1 = (u_char *) l1 + OSPF_LSA_HEADER_SIZE + 4;
+  lim1 = (u_char *) l1 + ntohs (l1->length);
+  p2 = (u_char *) l2 + OSPF_LSA_HEADER_SIZE + 4;
+  lim2 = (u_char *) l2 + ntohs (l2->length);
+
+  for (;;)
+    {
+      k1 = ospf_spf_transit_next (&p1, lim1);
+      k2 = ospf_spf_transit_next (&p2, lim2);
+      if (k1 == NULL || k2 == NULL)
+        return k1 == k2;
+
+      if (k1->m[0].type != k2->m[0].type
+          || k1->m[0].metric != k2->m[0].metric
+          || !IPV4_ADDR_SAME (&k1->link_id, &k2->link_id)
+          || !IPV4_ADDR_SAME (&k1->link_data, &k2->link_data))
+        return 0;
+    }
+}
+
+/* Move a vertex over to a new instance of its LSA. */
+static void
+ospf_vertex_relink (struct vertex *v, struct ospf_lsa *lsa)
+{
+  struct listnode *node;
+  struct vertex_parent *vp;
+
+  ospf_lsa_unlock (&v->lsa_p);
+  v->lsa_p = ospf_lsa_lock (lsa);
+  v->lsa = lsa->data;
+  v->stat = &lsa->stat;
+
+  /* Stub links may have moved the links back to the parents. */
+  for (ALL_LIST_ELEMENTS_RO (v->parents, node, vp))
+    vp->backlink = ospf_lsa_has_link (v->lsa_p, vp->parent->lsa);
+}
+
+/* Return the distance of the closest vertex of the kept tree at the far
+ * end of a link in an LSA, setting flag on each of them.
+ */
+static u_int32_t
+ospf_spf_neighbours (struct ospf_area *area, struct lsa_header *lsa,
+                     u_char flag)
+{
+  u_char *p;
+  u_char *lim;
+  struct router_lsa_link *l;
+  struct vertex *w;
+  u_int32_t distance = UINT32_MAX;
+
+  p = ((u_char *) lsa) + OSPF_LSA_HEADER_SIZE + 4;
+  lim = ((u_char *) lsa) + ntohs (lsa->length);
+
+  while (p < lim)
+    {
+      if (lsa->type == OSPF_ROUTER_LSA)
+        {
+          l = (struct router_lsa_link *) p;
+          p += (OSPF_ROUTER_LSA_LINK_SIZE +
+                (l->m[0].tos_count * OSPF_ROUTER_LSA_TOS_SIZE));
+
+          switch (l->m[0].type)
+            {
+            case LSA_LINK_TYPE_POINTOPOINT:
+            case LSA_LINK_TYPE_VIRTUALLINK:
+              w = ospf_vertex_lookup (area, OSPF_VERTEX_ROUTER, l->link_id);
+              break;
+            case LSA_LINK_TYPE_TRANSIT:
+              w = ospf_vertex_lookup (area, OSPF_VERTEX_NETWORK, l->link_id);
+              break;
+            default:
+              continue;
+            }
+        }
+      else
+        {
+          w = ospf_vertex_lookup (area, OSPF_VERTEX_ROUTER,
+                                  *(struct in_addr *) p);
+          p += sizeof (struct in_addr);
+        }
+
+      if (w == NULL)
+        continue;
+
+      if (w->distance < distance)
+        distance = w->distance;
+      SET_FLAG (w->flags, flag);
+    }
+
+  return distance;
+}
+
+/* Return the distance from the root below which no vertex of the kept
+ * tree can have moved since it was built.
+ *
+ * A new instance of W's LSA may move W and whatever is reached through
+ * it, and may give W a shorter path through any vertex it links to, so
+ * W's distance and theirs are bounds.  If the new instance only changes
+ * stub links, W keeps its place and is moved over to it.  An LSA which
+ * was not on the tree can only bring in paths through the vertices it
+ * links to.  Returns 0 if the whole tree must be recomputed.
+ */
+static u_int32_t
+ospf_spf_change_bound (struct ospf_area *area)
+{
+  struct listnode *node;
+  struct vertex *v;
+  struct ospf_lsa *lsa, *cur;
+  u_int32_t bound = UINT32_MAX;
+  u_int32_t distance;
+
+  for (ALL_LIST_ELEMENTS_RO (area->spf_vertices, node, v))
+    {
+      if (!CHECK_FLAG (v->lsa_p->flags, OSPF_LSA_DISCARD)
+          && !IS_LSA_MAXAGE (v->lsa_p))
+        continue;
+
+      /* Interfaces are looked up by position in our router-LSA. */
+      if (v == area->spf)
+        return 0;
+
+      cur = ospf_spf_lsa_lookup (area, v->type, v->id);
+      if (cur && ospf_spf_transit_same (v->lsa, cur->data))
+        {
+          ospf_vertex_relink (v, cur);
+          continue;
+        }
+
+      if (v->distance < bound)
+        bound = v->distance;
+      if (cur)
+        {
+          distance = ospf_spf_neighbours (area, cur->data, 0);
+          if (distance < bound)
+            bound = distance;
+        }
+    }
+
+  if (area->spf_changes)
+    for (ALL_LIST_ELEMENTS_RO (area->spf_changes, node, lsa))
+      {
+        cur = ospf_spf_lsa_lookup (area, lsa->data->type, lsa->data->id);
+        if (cur == NULL
+            || ospf_vertex_lookup (area, cur->data->type, cur->data->id))
+          continue;
+
+        distance = ospf_spf_neighbours (area, cur->data, 0);
+        if (distance < bound)
+          bound = distance;
+      }
+
+  return bound;
+}
+
+/* Start the calculation from the tree kept from the last one, rather than
+ * from the root alone (RFC2328 16.1 (1) and (2)).  Vertices closer to the
+ * root than any change keep their distance, parents and nexthops, so they
+ * are put back on the tree as they are; the rest are dropped, and the
+ * vertices they and the changed LSAs link to are examined again to find
+ * the new candidates.  Returns 0 if the tree must be built from scratch.
+ */
+static int
+ospf_spf_tree_reuse (struct ospf_area *area, struct pqueue *candidate,
+                     struct route_table *new_table,
+                     struct route_table *new_rtrs)
+{
+  struct listnode *node, *next, *pnode;
+  struct vertex *v;
+  struct vertex_parent *vp;
+  struct ospf_lsa *lsa, *cur;
+  u_int32_t bound;
+
+  if (!CHECK_FLAG (area->ospf->config, OSPF_SPF_INCREMENTAL)
+      || area->spf_vertices == NULL || area->spf_invalid)
+    return 0;
+
+  /* Virtual links take their nexthops from the transit areas. */
+  if (OSPF_IS_AREA_BACKBONE (area) && listcount (area->ospf->vlinks))
+    return 0;
+
+  bound = ospf_spf_change_bound (area);
+  if (bound == 0)
+    return 0;
+
+  /* The tree is in order of distance, so what is dropped is its tail. */
+  for (node = listhead (area->spf_vertices); node; node = listnextnode (node))
+    if (((struct vertex *) listgetdata (node))->distance >= bound)
+      break;
+
+  for (next = node; next; next = listnextnode (next))
+    {
+      v = listgetdata (next);
+      ospf_vertex_nexthops_free (area->spf, v);
+      for (ALL_LIST_ELEMENTS_RO (v->parents, pnode, vp))
+        listnode_delete (vp->parent->children, v);
+      hash_release (area->spf_vertex_hash, v);
+    }
+
+  for (; node; node = next)
+    {
+      next = listnextnode (node);
+      v = listgetdata (node);
+
+      if ((cur = ospf_spf_lsa_lookup (area, v->type, v->id)) != NULL)
+        ospf_spf_neighbours (area, cur->data, OSPF_VERTEX_SEED);
+
+      list_delete_node (area->spf_vertices, node);
+      ospf_vertex_free (v);
+    }
+
+  if (area->spf_changes)
+    for (ALL_LIST_ELEMENTS_RO (area->spf_changes, node, lsa))
+      {
+        cur = ospf_spf_lsa_lookup (area, lsa->data->type, lsa->data->id);
+        if (cur
+            && !ospf_vertex_lookup (area, cur->data->type, cur->data->id))
+          ospf_spf_neighbours (area, cur->data, OSPF_VERTEX_SEED);
+      }
+
+  if (IS_DEBUG_OSPF_EVENT)
+    zlog_debug ("%s: area %s keeps %d vertices closer than %u", __func__,
+                inet_ntoa (area->area_id), listcount (area->spf_vertices),
+                bound);
+
+  for (ALL_LIST_ELEMENTS_RO (area->spf_vertices, node, v))
+    {
+      *(v->stat) = LSA_SPF_IN_SPFTREE;
+      UNSET_FLAG (v->flags, OSPF_VERTEX_PROCESSED);
+
+      if (v == area->spf)
+        continue;
+
+      if (v->type == OSPF_VERTEX_ROUTER)
+        {
+          if (IS_ROUTER_LSA_VIRTUAL ((struct router_lsa *) v->lsa))
+            area->transit = OSPF_TRANSIT_TRUE;
+          ospf_intra_add_router (new_rtrs, v, area);
+        }
+      else
+        ospf_intra_add_transit (new_table, v, area);
+    }
+
+  for (ALL_LIST_ELEMENTS_RO (area->spf_vertices, node, v))
+    if (CHECK_FLAG (v->flags, OSPF_VERTEX_SEED))
+      {
+        UNSET_FLAG (v->flags, OSPF_VERTEX_SEED);
+        ospf_spf_next (v, area, candidate);
+      }
+
+  return 1;
+}
+
 /* Calculating the shortest-path tree for an area. */
 static void
 ospf_spf_calculate (struct ospf_area *area, struct route_table *new_table,
@@ -1197,6 +1567,8 @@ ospf_spf_calculate (struct ospf_area *area, struct route_table *new_table,
         zlog_debug ("ospf_spf_calculate: "
                    "Skip area %s's calculation due to empty router_lsa_self",
                    inet_ntoa (area->area_id));
+      ospf_spf_tree_free (area);
+      ospf_spf_changes_clear (area);
       return;
     }
 
@@ -1211,30 +1583,40 @@ ospf_spf_calculate (struct ospf_area *area, struct route_table *new_table,
   candidate->cmp = cmp;
   candidate->update = update_stat;
 
-  /* Initialize the shortest-path tree to only the root (which is the
-     router doing the calculation). */
-  ospf_spf_init (area);
-  v = area->spf;
-  /* Set LSA position to LSA_SPF_IN_SPFTREE. This vertex is the root of the
-   * spanning tree. */
-  *(v->stat) = LSA_SPF_IN_SPFTREE;
-
   /* Set Area A's TransitCapability to FALSE. */
   area->transit = OSPF_TRANSIT_FALSE;
   area->shortcut_capability = 1;
-  
-  for (;;)
+
+  /* Reset ABR and ASBR router counts. */
+  area->abr_count = 0;
+  area->asbr_count = 0;
+
+  if (ospf_spf_tree_reuse (area, candidate, new_table, new_rtrs))
+    area->spf_incremental++;
+  else
     {
+      ospf_spf_tree_free (area);
+      area->spf_invalid = 0;
+
+      /* Initialize the shortest-path tree to only the root (which is the
+         router doing the calculation). */
+      ospf_spf_init (area);
+      v = area->spf;
+      /* Set LSA position to LSA_SPF_IN_SPFTREE. This vertex is the root of
+       * the spanning tree. */
+      *(v->stat) = LSA_SPF_IN_SPFTREE;
+
       /* RFC2328 16.1. (2). */
       ospf_spf_next (v, area, candidate);
+    }
+  ospf_spf_changes_clear (area);
 
-      /* RFC2328 16.1. (3). */
-      /* If at this step the candidate list is empty, the shortest-
-         path tree (of transit vertices) has been completely built and
-         this stage of the procedure terminates. */
-      if (candidate->size == 0)
-        break;
-
+  /* RFC2328 16.1. (3). */
+  /* If at this step the candidate list is empty, the shortest-
+     path tree (of transit vertices) has been completely built and
+     this stage of the procedure terminates. */
+  while (candidate->size > 0)
+    {
       /* Otherwise, choose the vertex belonging to the candidate list
          that is closest to the root, and add it to the shortest-path
          tree (removing it from the candidate list in the
@@ -1245,6 +1627,7 @@ ospf_spf_calculate (struct ospf_area *area, struct route_table *new_table,
       *(v->stat) = LSA_SPF_IN_SPFTREE;
 
       ospf_vertex_add_parent (v);
+      ospf_spf_tree_add (area, v);
 
       /* RFC2328 16.1. (4). */
       if (v->type == OSPF_VERTEX_ROUTER)
@@ -1254,6 +1637,7 @@ ospf_spf_calculate (struct ospf_area *area, struct route_table *new_table,
 
       /* RFC2328 16.1. (5). */
       /* Iterate the algorithm by returning to Step 2. */
+      ospf_spf_next (v, area, candidate);
 
     } /* end loop until no more candidate vertices */
 
@@ -1270,11 +1654,6 @@ ospf_spf_calculate (struct ospf_area *area, struct route_table *new_table,
   pqueue_delete (candidate);
 
   ospf_vertex_dump (__func__, area->spf, 0, 1);
-  /* Free nexthop information, canonical versions of which are attached
-   * the first level of router vertices attached to the root vertex, see
-   * ospf_nexthop_calculation.
-   */
-  ospf_canonical_nexthops_free (area->spf);
 
   /* Increment SPF Calculation Counter. */
   area->spf_calculation++;
@@ -1286,10 +1665,254 @@ ospf_spf_calculate (struct ospf_area *area, struct route_table *new_table,
     zlog_debug ("ospf_spf_calculate: Stop. %zd vertices",
                 mtype_stats_alloc(MTYPE_OSPF_VERTEX));
 
-  /* Free SPF vertices, but not the list. List has ospf_vertex_free
-   * as deconstructor.
+  /* Free SPF vertices and the nexthop information attached to them,
+   * unless the tree is kept for the next calculation.
    */
-  list_delete_all_node (&vertex_list);
+  if (!CHECK_FLAG (area->ospf->config, OSPF_SPF_INCREMENTAL))
+    ospf_spf_tree_free (area);
+}
+
+/* Note a new instance of a router- or network-LSA, for the next
+ * calculation to work out how much of the kept tree it may reuse.
+ */
+void
+ospf_spf_lsa_changed (struct ospf_lsa *lsa)
+{
+  struct ospf_area *area = lsa->area;
+
+  if (area == NULL)
+    return;
+
+  area->spf_pending = 1;
+
+  if (area->spf_vertices == NULL || area->spf_invalid)
+    return;
+
+  if (area->spf_changes == NULL)
+    area->spf_changes = list_new ();
+
+  /* Past this many changes, recomputing the lot is no slower. */
+  if (listcount (area->spf_changes) >= listcount (area->spf_vertices))
+    {
+      ospf_spf_invalidate (area);
+      return;
+    }
+
+  listnode_add (area->spf_changes, ospf_lsa_lock (lsa));
+}
+
+/* Make the next calculation for an area start from scratch, when the
+ * nexthops on the kept tree may no longer hold: the interfaces and
+ * neighbours they use are not described by the LSAs.
+ */
+void
+ospf_spf_invalidate (struct ospf_area *area)
+{
+  if (area == NULL)
+    return;
+
+  area->spf_invalid = 1;
+  area->spf_pending = 1;
+  ospf_spf_changes_clear (area);
+}
+
+/* Note a router- or network-LSA reaching MaxAge.  The kept tree checks
+ * the age of the LSAs it reuses, but the area's routes must be worked
+ * out again.
+ */
+void
+ospf_spf_lsa_flushed (struct ospf_lsa *lsa)
+{
+  if (lsa->area == NULL)
+    return;
+
+  if (lsa->data->type == OSPF_ROUTER_LSA
+      || lsa->data->type == OSPF_NETWORK_LSA)
+    lsa->area->spf_pending = 1;
+}
+
+static void
+ospf_spf_area_routes_free (struct ospf_area *area)
+{
+  if (area->spf_table)
+    ospf_route_table_free (area->spf_table);
+  if (area->spf_rtrs)
+    ospf_rtrs_free (area->spf_rtrs);
+  area->spf_table = NULL;
+  area->spf_rtrs = NULL;
+}
+
+void
+ospf_spf_area_free (struct ospf_area *area)
+{
+  ospf_spf_tree_free (area);
+  ospf_spf_changes_clear (area);
+  if (area->spf_changes)
+    list_delete (area->spf_changes);
+  area->spf_changes = NULL;
+  ospf_spf_area_routes_free (area);
+}
+
+/* Calculate the routes of an area into tables of its own, unless it
+ * has not changed since they were last calculated.
+ */
+static int
+ospf_spf_area_calculate (struct ospf_area *area)
+{
+  if (area->spf_table && !area->spf_pending)
+    {
+      if (IS_DEBUG_OSPF_EVENT)
+        zlog_debug ("SPF: area %s unchanged, reusing its routes",
+                    inet_ntoa (area->area_id));
+      return 0;
+    }
+
+  /* Cleared first: the calculation may itself change the area, e.g. by
+     bringing up a virtual link. */
+  area->spf_pending = 0;
+
+  ospf_spf_area_routes_free (area);
+  area->spf_table = route_table_init ();
+  area->spf_rtrs = route_table_init ();
+
+  ospf_spf_calculate (area, area->spf_table, area->spf_rtrs);
+
+  return 1;
+}
+
+/* Whether a network route of another area replaces the current one, as
+ * the second stage of the calculation decides within an area.  The Link
+ * State Origin tells which rule applies: a transit network found again
+ * (ospf_intra_add_transit) replaces an entry that is no cheaper and has
+ * no higher Link State ID, without merging nexthops.  A stub network
+ * (ospf_intra_add_stub) replaces a dearer entry; at equal cost its
+ * nexthops are added to the entry, whose origin moves to the router-LSA
+ * with the higher Link State ID.
+ */
+static int
+ospf_spf_area_route_replaces (struct ospf_route *cur_or,
+                              struct ospf_route *or)
+{
+  struct lsa_header *origin = or->u.std.origin;
+
+  if (or->cost > cur_or->cost)
+    return 0;
+
+  if (origin->type == OSPF_NETWORK_LSA)
+    return IPV4_ADDR_CMP (&cur_or->u.std.origin->id, &origin->id) <= 0;
+
+  if (or->cost < cur_or->cost)
+    return 1;
+
+  ospf_route_copy_nexthops (cur_or, or->paths);
+  if (IPV4_ADDR_CMP (&cur_or->u.std.origin->id, &origin->id) < 0)
+    cur_or->u.std.origin = origin;
+  return 0;
+}
+
+/* Add the routes of an area to the routing table.  Routes to the same
+ * network from more than one area are merged as the second stage of the
+ * calculation merges them within an area, so the result depends only on
+ * the order in which the areas are added.
+ */
+static void
+ospf_spf_area_merge (struct ospf_area *area, struct route_table *new_table,
+                     struct route_table *new_rtrs)
+{
+  struct route_node *rn, *rn2;
+  struct ospf_route *or;
+  struct listnode *node;
+
+  for (rn = route_top (area->spf_table); rn; rn = route_next (rn))
+    if ((or = rn->info) != NULL)
+      {
+        rn2 = route_node_get (new_table, &rn->p);
+        if (rn2->info)
+          {
+            route_unlock_node (rn2);
+
+            if (!ospf_spf_area_route_replaces (rn2->info, or))
+              continue;
+
+            ospf_route_free (rn2->info);
+          }
+        rn2->info = ospf_route_dup (or);
+      }
+
+  /* Note that we keep all routes to ABRs and ASBRs, not only the best */
+  for (rn = route_top (area->spf_rtrs); rn; rn = route_next (rn))
+    if (rn->info != NULL)
+      {
+        rn2 = route_node_get (new_rtrs, &rn->p);
+        if (rn2->info == NULL)
+          rn2->info = list_new ();
+        else
+          route_unlock_node (rn2);
+
+        for (ALL_LIST_ELEMENTS_RO ((struct list *) rn->info, node, or))
+          listnode_add (rn2->info, ospf_route_dup (or));
+      }
+}
+
+/* Calculate the intra-area routes of all areas.  Returns the number of
+ * areas whose shortest-path tree had to be calculated.
+ */
+static int
+ospf_spf_calculate_areas (struct ospf *ospf, struct route_table *new_table,
+                          struct route_table *new_rtrs)
+{
+  struct ospf_area *area;
+  struct listnode *node, *nnode;
+  int areas_processed = 0;
+
+  /* The kept trees only account for changes to the LSAs. */
+  if (spf_reason_flags & ((1 << SPF_FLAG_CONFIG_CHANGE)
+                          | (1 << SPF_FLAG_ABR_STATUS_CHANGE)))
+    for (ALL_LIST_ELEMENTS (ospf->areas, node, nnode, area))
+      ospf_spf_invalidate (area);
+
+  /* A single area has nearly always changed when it is calculated:
+     keeping its routes apart would only cost a copy of them. */
+  if (listcount (ospf->areas) == 1)
+    {
+      area = listgetdata (listhead (ospf->areas));
+      ospf_spf_area_routes_free (area);
+      area->spf_pending = 0;
+      ospf_spf_calculate (area, new_table, new_rtrs);
+      return 1;
+    }
+
+  /* Virtual links are approved as their transit areas are calculated,
+     and the backbone's routes depend on them. */
+  if (listcount (ospf->vlinks))
+    for (ALL_LIST_ELEMENTS (ospf->areas, node, nnode, area))
+      area->spf_pending = 1;
+
+  /* Calculate SPF for each area. */
+  for (ALL_LIST_ELEMENTS (ospf->areas, node, nnode, area))
+    {
+      /* Do backbone last, so as to first discover intra-area paths
+       * for any back-bone virtual-links
+       */
+      if (ospf->backbone && ospf->backbone == area)
+        continue;
+
+      areas_processed += ospf_spf_area_calculate (area);
+    }
+
+  /* SPF for backbone, if required */
+  if (ospf->backbone)
+    areas_processed += ospf_spf_area_calculate (ospf->backbone);
+
+  /* Merge in the same order. */
+  for (ALL_LIST_ELEMENTS (ospf->areas, node, nnode, area))
+    if (area != ospf->backbone)
+      ospf_spf_area_merge (area, new_table, new_rtrs);
+
+  if (ospf->backbone)
+    ospf_spf_area_merge (ospf->backbone, new_table, new_rtrs);
+
+  return areas_processed;
 }
 
 /* Timer for SPF calculation. */
@@ -1298,8 +1921,6 @@ ospf_spf_calculate_timer (struct thread *thread)
 {
   struct ospf *ospf = THREAD_ARG (thread);
   struct route_table *new_table, *new_rtrs;
-  struct ospf_area *area;
-  struct listnode *node, *nnode;
   struct timeval start_time, stop_time, spf_start_time;
   int areas_processed = 0;
   unsigned long ia_time, prune_time, rt_time;
@@ -1318,25 +1939,7 @@ ospf_spf_calculate_timer (struct thread *thread)
 
   ospf_vl_unapprove (ospf);
 
-  /* Calculate SPF for each area. */
-  for (ALL_LIST_ELEMENTS (ospf->areas, node, nnode, area))
-    {
-      /* Do backbone last, so as to first discover intra-area paths
-       * for any back-bone virtual-links
-       */
-      if (ospf->backbone && ospf->backbone == area)
-        continue;
-
-      ospf_spf_calculate (area, new_table, new_rtrs);
-      areas_processed++;
-    }
-
-  /* SPF for backbone, if required */
-  if (ospf->backbone)
-    {
-      ospf_spf_calculate (ospf->backbone, new_table, new_rtrs);
-      areas_processed++;
-    }
+  areas_processed = ospf_spf_calculate_areas (ospf, new_table, new_rtrs);
 
   quagga_gettime (QUAGGA_CLK_MONOTONIC, &stop_time);
   spf_time = timeval_elapsed (stop_time, spf_start_time);
@@ -1368,7 +1971,7 @@ ospf_spf_calculate_timer (struct thread *thread)
   quagga_gettime (QUAGGA_CLK_MONOTONIC, &start_time);
 
   /* Update routing table. */
-  ospf_route_install (ospf, new_table);
+  ospf->spf_route_changes = ospf_route_install (ospf, new_table);
 
   quagga_gettime (QUAGGA_CLK_MONOTONIC, &stop_time);
   rt_time = timeval_elapsed (stop_time, start_time);
@@ -1395,6 +1998,18 @@ ospf_spf_calculate_timer (struct thread *thread)
   ospf->ts_spf_duration.tv_sec = total_spf_time/1000000;
   ospf->ts_spf_duration.tv_usec = total_spf_time % 1000000;
 
+  ospf->spf_times.spf = spf_time;
+  ospf->spf_times.ia = ia_time;
+  ospf->spf_times.prune = prune_time;
+  ospf->spf_times.install = rt_time;
+  ospf->spf_times.abr = abr_time;
+  ospf->spf_times_total.spf += spf_time;
+  ospf->spf_times_total.ia += ia_time;
+  ospf->spf_times_total.prune += prune_time;
+  ospf->spf_times_total.install += rt_time;
+  ospf->spf_times_total.abr += abr_time;
+  ospf->spf_count++;
+
   ospf_get_spf_reason_str (rbuf);
 
   if (IS_DEBUG_OSPF_EVENT)
@@ -1403,7 +2018,8 @@ ospf_spf_calculate_timer (struct thread *thread)
       zlog_info ("\t    SPF Time: %ld", spf_time);
       zlog_info ("\t   InterArea: %ld", ia_time);
       zlog_info ("\t       Prune: %ld", prune_time);
-      zlog_info ("\tRouteInstall: %ld", rt_time);
+      zlog_info ("\tRouteInstall: %ld (%lu routes changed)",
+                 rt_time, ospf->spf_route_changes);
       if (IS_OSPF_ABR (ospf))
         zlog_info ("\t         ABR: %ld (%d areas)",
                    abr_time, areas_processed);
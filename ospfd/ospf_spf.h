@@ -29,6 +29,7 @@
 
 /* values for vertex->flags */
 #define OSPF_VERTEX_PROCESSED      0x01
+#define OSPF_VERTEX_SEED           0x02  /* links to recompute from */
 
 /* The "root" is the node running the SPF calculation */
 
@@ -39,6 +40,7 @@ struct vertex
   u_char type;		/* copied from LSA header */
   struct in_addr id;	/* copied from LSA header */
   struct lsa_header *lsa; /* Router or Network LSA */
+  struct ospf_lsa *lsa_p; /* the LSA itself, locked by the vertex */
   int *stat;		/* Link to LSA status. */
   u_int32_t distance;	/* from root to this vertex */  
   struct list *parents;		/* list of parents in SPF tree */
@@ -73,6 +75,10 @@ typedef enum {
 
 extern void ospf_spf_calculate_schedule (struct ospf *, ospf_spf_reason_t);
 extern void ospf_rtrs_free (struct route_table *);
+extern void ospf_spf_lsa_changed (struct ospf_lsa *);
+extern void ospf_spf_lsa_flushed (struct ospf_lsa *);
+extern void ospf_spf_invalidate (struct ospf_area *);
+extern void ospf_spf_area_free (struct ospf_area *);
 
 /* void ospf_spf_calculate_timer_add (); */
 #endif /* _QUAGGA_OSPF_SPF_H */
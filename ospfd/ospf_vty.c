@@ -2438,6 +2438,35 @@ DEFUN (no_ospf_compatible_rfc1583,
   return CMD_SUCCESS;
 }
 
+DEFUN (ospf_ispf,
+       ospf_ispf_cmd,
+       "ispf",
+       "Enable incremental SPF\n")
+{
+  struct ospf *ospf = vty->index;
+
+  if (!ospf)
+    return CMD_SUCCESS;
+
+  SET_FLAG (ospf->config, OSPF_SPF_INCREMENTAL);
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_ospf_ispf,
+       no_ospf_ispf_cmd,
+       "no ispf",
+       NO_STR
+       "Enable incremental SPF\n")
+{
+  struct ospf *ospf = vty->index;
+
+  if (!ospf)
+    return CMD_SUCCESS;
+
+  UNSET_FLAG (ospf->config, OSPF_SPF_INCREMENTAL);
+  return CMD_SUCCESS;
+}
+
 ALIAS (ospf_compatible_rfc1583,
        ospf_rfc1583_flag_cmd,
        "ospf rfc1583compatibility",
@@ -2894,6 +2923,48 @@ ALIAS (no_ospf_refresh_timer,
        "Adjust refresh parameters\n"
        "Unset refresh timer\n")
 
+DEFUN (ospf_refresh_rate_limit, ospf_refresh_rate_limit_cmd,
+       "refresh rate-limit <1-1000000>",
+       "Adjust refresh parameters\n"
+       "Limit the rate of self-originated LSA refreshes\n"
+       "LSAs per second\n")
+{
+  struct ospf *ospf = vty->index;
+  u_int32_t rate;
+
+  if (!ospf)
+    return CMD_SUCCESS;
+
+  VTY_GET_INTEGER_RANGE ("refresh rate-limit", rate, argv[0], 1, 1000000);
+  ospf->lsa_refresh_rate = rate;
+
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_ospf_refresh_rate_limit, no_ospf_refresh_rate_limit_cmd,
+       "no refresh rate-limit",
+       NO_STR
+       "Adjust refresh parameters\n"
+       "Limit the rate of self-originated LSA refreshes\n")
+{
+  struct ospf *ospf = vty->index;
+
+  if (!ospf)
+    return CMD_SUCCESS;
+
+  ospf->lsa_refresh_rate = 0;
+
+  return CMD_SUCCESS;
+}
+
+ALIAS (no_ospf_refresh_rate_limit,
+       no_ospf_refresh_rate_limit_val_cmd,
+       "no refresh rate-limit <1-1000000>",
+       NO_STR
+       "Adjust refresh parameters\n"
+       "Limit the rate of self-originated LSA refreshes\n"
+       "LSAs per second\n")
+
 DEFUN (ospf_auto_cost_reference_bandwidth,
        ospf_auto_cost_reference_bandwidth_cmd,
        "auto-cost reference-bandwidth <1-4294967>",
@@ -3216,6 +3287,7 @@ show_ip_ospf_area (struct vty *vty, struct ospf_area *area, json_object *json_ar
 
       /* Show SPF calculation times. */
       json_object_int_add(json_area, "spfExecutedCounter", area->spf_calculation);
+      json_object_int_add(json_area, "spfIncrementalCounter", area->spf_incremental);
       json_object_int_add(json_area, "lsaNumber", area->lsdb->total);
       json_object_int_add(json_area, "lsaRouterNumber", ospf_lsdb_count (area->lsdb, OSPF_ROUTER_LSA));
       json_object_int_add(json_area, "lsaRouterChecksum", ospf_lsdb_checksum (area->lsdb, OSPF_ROUTER_LSA));
@@ -3250,6 +3322,9 @@ show_ip_ospf_area (struct vty *vty, struct ospf_area *area, json_object *json_ar
       /* Show SPF calculation times. */
       vty_out (vty, "   SPF algorithm executed %d times%s",
                area->spf_calculation, VTY_NEWLINE);
+      if (area->spf_incremental)
+        vty_out (vty, "   SPF reused the previous tree %d times%s",
+                 area->spf_incremental, VTY_NEWLINE);
 
       /* Show number of LSA. */
       vty_out (vty, "   Number of LSA %ld%s", area->lsdb->total, VTY_NEWLINE);
@@ -3293,6 +3368,30 @@ show_ip_ospf_area (struct vty *vty, struct ospf_area *area, json_object *json_ar
     vty_out (vty, "%s", VTY_NEWLINE);
 }
 
+static void
+show_ip_ospf_spf_times (struct vty *vty, const char *header,
+                        struct ospf_spf_times *times)
+{
+  vty_out (vty, "%s intra-area %lu, inter-area %lu, prune %lu,"
+                " install %lu, ABR %lu%s",
+           header, times->spf, times->ia, times->prune, times->install,
+           times->abr, VTY_NEWLINE);
+}
+
+static json_object *
+show_ip_ospf_spf_times_json (struct ospf_spf_times *times)
+{
+  json_object *json_times = json_object_new_object();
+
+  json_object_int_add(json_times, "intraArea", times->spf);
+  json_object_int_add(json_times, "interArea", times->ia);
+  json_object_int_add(json_times, "prune", times->prune);
+  json_object_int_add(json_times, "install", times->install);
+  json_object_int_add(json_times, "abr", times->abr);
+
+  return json_times;
+}
+
 static int
 show_ip_ospf_common (struct vty *vty, struct ospf *ospf, u_char use_json)
 {
@@ -3417,6 +3516,8 @@ show_ip_ospf_common (struct vty *vty, struct ospf *ospf, u_char use_json)
       json_object_int_add(json, "holdtimeMinMsecs", ospf->spf_holdtime);
       json_object_int_add(json, "holdtimeMaxMsecs", ospf->spf_max_holdtime);
       json_object_int_add(json, "holdtimeMultplier", ospf->spf_hold_multiplier);
+      if (CHECK_FLAG (ospf->config, OSPF_SPF_INCREMENTAL))
+        json_object_boolean_true_add(json, "spfIncremental");
     }
   else
     {
@@ -3428,6 +3529,8 @@ show_ip_ospf_common (struct vty *vty, struct ospf *ospf, u_char use_json)
                ospf->spf_holdtime, VTY_NEWLINE,
                ospf->spf_max_holdtime, VTY_NEWLINE,
                ospf->spf_hold_multiplier, VTY_NEWLINE);
+      if (CHECK_FLAG (ospf->config, OSPF_SPF_INCREMENTAL))
+        vty_out (vty, " Incremental SPF is enabled%s", VTY_NEWLINE);
     }
 
   if (use_json)
@@ -3443,9 +3546,17 @@ show_ip_ospf_common (struct vty *vty, struct ospf *ospf, u_char use_json)
 
           time_store = (1000 * ospf->ts_spf_duration.tv_sec) + (ospf->ts_spf_duration.tv_usec / 1000);
           json_object_int_add(json, "spfLastDurationMsecs", time_store);
+
+          json_object_object_add(json, "spfLastPhasesUsecs",
+                                 show_ip_ospf_spf_times_json (&ospf->spf_times));
+          json_object_object_add(json, "spfTotalPhasesUsecs",
+                                 show_ip_ospf_spf_times_json (&ospf->spf_times_total));
+          json_object_int_add(json, "spfCounter", ospf->spf_count);
+          json_object_int_add(json, "spfLastRouteChanges", ospf->spf_route_changes);
         }
       else
         json_object_boolean_true_add(json, "spfHasNotRun");
+      json_object_int_add(json, "spfPartialCounter", ospf->prc_count);
     }
   else
     {
@@ -3459,9 +3570,18 @@ show_ip_ospf_common (struct vty *vty, struct ospf *ospf, u_char use_json)
           vty_out (vty, " Last SPF duration %s%s",
                    ospf_timeval_dump (&ospf->ts_spf_duration, timebuf, sizeof (timebuf)),
                    VTY_NEWLINE);
+          show_ip_ospf_spf_times (vty, " Last SPF phases (usecs):",
+                                  &ospf->spf_times);
+          vty_out (vty, " Last SPF changed %lu routes%s",
+                   ospf->spf_route_changes, VTY_NEWLINE);
+          vty_out (vty, " Total of %lu SPF runs (usecs):", ospf->spf_count);
+          show_ip_ospf_spf_times (vty, "", &ospf->spf_times_total);
         }
       else
         vty_out (vty, "has not been run%s", VTY_NEWLINE);
+      if (ospf->prc_count)
+        vty_out (vty, " Summary-LSA changes handled without SPF %lu%s",
+                 ospf->prc_count, VTY_NEWLINE);
     }
 
   if (use_json)
@@ -3482,6 +3602,12 @@ show_ip_ospf_common (struct vty *vty, struct ospf *ospf, u_char use_json)
       json_object_int_add(json, "writeMultiplier", ospf->write_oi_count);
       /* Show refresh parameters. */
       json_object_int_add(json, "refreshTimerMsecs", ospf->lsa_refresh_interval * 1000);
+      if (ospf->lsa_refresh_rate)
+        json_object_int_add(json, "refreshRateLimit", ospf->lsa_refresh_rate);
+      json_object_int_add(json, "refreshLastRunLsas", ospf->lsa_refresh_stats.refreshed);
+      json_object_int_add(json, "refreshLastRunDeferred", ospf->lsa_refresh_stats.deferred);
+      json_object_int_add(json, "refreshPeakRunLsas", ospf->lsa_refresh_stats.peak);
+      json_object_int_add(json, "refreshTotalLsas", ospf->lsa_refresh_stats.total);
     }
   else
     {
@@ -3502,6 +3628,15 @@ show_ip_ospf_common (struct vty *vty, struct ospf *ospf, u_char use_json)
       /* Show refresh parameters. */
       vty_out (vty, " Refresh timer %d secs%s",
                ospf->lsa_refresh_interval, VTY_NEWLINE);
+      if (ospf->lsa_refresh_rate)
+        vty_out (vty, " Refresh rate limited to %u LSAs per second%s",
+                 ospf->lsa_refresh_rate, VTY_NEWLINE);
+      vty_out (vty, " Refreshed %lu LSAs in the last run, %lu deferred,"
+               " peak %lu, total %lu%s",
+               ospf->lsa_refresh_stats.refreshed,
+               ospf->lsa_refresh_stats.deferred,
+               ospf->lsa_refresh_stats.peak,
+               ospf->lsa_refresh_stats.total, VTY_NEWLINE);
     }
 
   /* Show ABR/ASBR flags. */
@@ -9879,6 +10014,9 @@ ospf_config_write (struct vty *vty)
       if (CHECK_FLAG (ospf->config, OSPF_RFC1583_COMPATIBLE))
 	vty_out (vty, " compatible rfc1583%s", VTY_NEWLINE);
 
+      if (CHECK_FLAG (ospf->config, OSPF_SPF_INCREMENTAL))
+	vty_out (vty, " ispf%s", VTY_NEWLINE);
+
       /* auto-cost reference-bandwidth configuration.  */
       if (ospf->ref_bandwidth != OSPF_DEFAULT_REF_BANDWIDTH)
         {
@@ -9916,6 +10054,9 @@ ospf_config_write (struct vty *vty)
       if (ospf->lsa_refresh_interval != OSPF_LSA_REFRESH_INTERVAL_DEFAULT)
 	vty_out (vty, " refresh timer %d%s",
 		 ospf->lsa_refresh_interval, VTY_NEWLINE);
+      if (ospf->lsa_refresh_rate)
+	vty_out (vty, " refresh rate-limit %u%s",
+		 ospf->lsa_refresh_rate, VTY_NEWLINE);
 
       /* Redistribute information print. */
       config_write_ospf_redistribute (vty, ospf);
@@ -10398,6 +10539,8 @@ ospf_vty_init (void)
   install_element (OSPF_NODE, &ospf_timers_throttle_spf_cmd);
   install_element (OSPF_NODE, &no_ospf_timers_throttle_spf_cmd);
   install_element (OSPF_NODE, &no_ospf_timers_throttle_spf_val_cmd);
+  install_element (OSPF_NODE, &ospf_ispf_cmd);
+  install_element (OSPF_NODE, &no_ospf_ispf_cmd);
   
   /* LSA timers commands */
   install_element (OSPF_NODE, &ospf_timers_min_ls_interval_cmd);
@@ -10414,6 +10557,9 @@ ospf_vty_init (void)
   install_element (OSPF_NODE, &ospf_refresh_timer_cmd);
   install_element (OSPF_NODE, &no_ospf_refresh_timer_val_cmd);
   install_element (OSPF_NODE, &no_ospf_refresh_timer_cmd);
+  install_element (OSPF_NODE, &ospf_refresh_rate_limit_cmd);
+  install_element (OSPF_NODE, &no_ospf_refresh_rate_limit_cmd);
+  install_element (OSPF_NODE, &no_ospf_refresh_rate_limit_val_cmd);
   
   /* max-metric commands */
   install_element (OSPF_NODE, &ospf_max_metric_router_lsa_admin_cmd);
@@ -284,12 +284,13 @@ ospf_new (u_short instance)
   if (IS_DEBUG_OSPF (zebra, ZEBRA_INTERFACE))
     zlog_debug ("%s: starting with OSPF send buffer size %u",
       __func__, new->maxsndbuflen);
-  if ((new->ibuf = stream_new(OSPF_MAX_PACKET_SIZE+1)) == NULL)
-    {
-      zlog_err("ospf_new: fatal error: stream_new(%u) failed allocating ibuf",
-	       OSPF_MAX_PACKET_SIZE+1);
-      exit(1);
-    }
+  for (i = 0; i < OSPF_READ_BATCH; i++)
+    if ((new->ibuf[i] = stream_new(OSPF_MAX_PACKET_SIZE+1)) == NULL)
+      {
+        zlog_err("ospf_new: fatal error: stream_new(%u) failed allocating ibuf",
+                 OSPF_MAX_PACKET_SIZE+1);
+        exit(1);
+      }
   new->t_read = thread_add_read (master, ospf_read, new, new->fd);
   new->oi_write_q = list_new ();
   new->write_oi_count = OSPF_WRITE_INTERFACE_COUNT_DEFAULT;
@@ -608,7 +609,8 @@ ospf_finish_final (struct ospf *ospf)
   OSPF_TIMER_OFF (ospf->t_opaque_lsa_self);
 
   close (ospf->fd);
-  stream_free(ospf->ibuf);
+  for (i = 0; i < OSPF_READ_BATCH; i++)
+    stream_free(ospf->ibuf[i]);
    
   LSDB_LOOP (OPAQUE_AS_LSDB (ospf), rn, lsa)
     ospf_discard_from_db (ospf, ospf->lsdb, lsa);
@@ -740,6 +742,8 @@ ospf_area_free (struct ospf_area *area)
   struct route_node *rn;
   struct ospf_lsa *lsa;
 
+  ospf_spf_area_free (area);
+
   /* Free LSDBs. */
   LSDB_LOOP (ROUTER_LSDB (area), rn, lsa)
     ospf_discard_from_db (area->ospf, area->lsdb, lsa);
@@ -1187,18 +1191,15 @@ void
 ospf_ls_upd_queue_empty (struct ospf_interface *oi)
 {
   struct route_node *rn;
-  struct listnode *node, *nnode;
-  struct list *lst;
-  struct ospf_lsa *lsa;
+  struct ospf_lsdb *lsdb;
 
   /* empty ls update queue */
   for (rn = route_top (oi->ls_upd_queue); rn;
        rn = route_next (rn))
-    if ((lst = (struct list *) rn->info))
+    if ((lsdb = (struct ospf_lsdb *) rn->info))
       {
-	for (ALL_LIST_ELEMENTS (lst, node, nnode, lsa))
-          ospf_lsa_unlock (&lsa); /* oi->ls_upd_queue */
-	list_free (lst);
+	ospf_lsdb_delete_all (lsdb); /* oi->ls_upd_queue */
+	ospf_lsdb_free (lsdb);
 	rn->info = NULL;
       }
   
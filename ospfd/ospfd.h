@@ -128,6 +128,16 @@ struct ospf_redist
 #define ROUTEMAP(R)        (R->route_map.map)
 };
 
+/* Time spent in the phases of an SPF calculation, in usecs. */
+struct ospf_spf_times
+{
+  unsigned long spf;			/* Intra-area, all areas. */
+  unsigned long ia;			/* Inter-area routes. */
+  unsigned long prune;			/* Pruning unreachable routes. */
+  unsigned long install;		/* Routing table installation. */
+  unsigned long abr;			/* ABR task. */
+};
+
 /* OSPF instance structure. */
 struct ospf
 {
@@ -164,6 +174,7 @@ struct ospf
 #define OSPF_OPAQUE_CAPABLE		(1 << 2)
 #define OSPF_LOG_ADJACENCY_CHANGES	(1 << 3)
 #define OSPF_LOG_ADJACENCY_DETAIL	(1 << 4)
+#define OSPF_SPF_INCREMENTAL		(1 << 5)
 
   /* Opaque-LSA administrative flags. */
   u_char opaque;
@@ -228,6 +239,12 @@ struct ospf
   /* Time stamps */
   struct timeval ts_spf;		/* SPF calculation time stamp. */
   struct timeval ts_spf_duration;	/* Execution time of last SPF */
+  struct ospf_spf_times spf_times;	/* Phases of the last SPF */
+  struct ospf_spf_times spf_times_total; /* Phases of all SPFs */
+  unsigned long spf_count;		/* SPF calculations run */
+  unsigned long spf_route_changes;	/* Routes changed by the last SPF */
+  unsigned long prc_count;		/* Summary-LSA changes handled
+					   without an SPF calculation */
 
   struct route_table *maxage_lsa;       /* List of MaxAge LSA for deletion. */
   int redistribute;                     /* Num of redistributed protocols. */
@@ -253,7 +270,12 @@ struct ospf
   struct thread *t_read;
   int fd;
   unsigned int maxsndbuflen;
-  struct stream *ibuf;
+#ifdef HAVE_RECVMMSG
+#define OSPF_READ_BATCH    8
+#else
+#define OSPF_READ_BATCH    1
+#endif /* HAVE_RECVMMSG */
+  struct stream *ibuf[OSPF_READ_BATCH];	/* Packets read per thread invocation */
   struct list *oi_write_q;
   
   /* Distribute lists out of other route sources. */
@@ -286,6 +308,16 @@ struct ospf
   time_t lsa_refresher_started;
 #define OSPF_LSA_REFRESH_INTERVAL_DEFAULT 10
   u_int16_t lsa_refresh_interval;
+  u_int32_t lsa_refresh_rate;	/* LSAs per second, 0 for no limit. */
+
+  /* LSA refresher statistics. */
+  struct
+  {
+    unsigned long refreshed;	/* By the last run. */
+    unsigned long deferred;	/* Left for the next run by the rate limit. */
+    unsigned long peak;		/* Most refreshed by a single run. */
+    unsigned long total;
+  } lsa_refresh_stats;
   
   /* Distance parameter. */
   u_char distance_all;
@@ -402,12 +434,25 @@ struct ospf_area
   /* Shortest Path Tree. */
   struct vertex *spf;
 
+  /* Kept between calculations for incremental SPF. */
+  struct list *spf_vertices;		/* SPT vertices, by distance. */
+  struct hash *spf_vertex_hash;		/* SPT vertices, by type and ID. */
+  struct list *spf_changes;		/* Router/network-LSAs installed. */
+  int spf_invalid;			/* Tree may not be reused. */
+
+  /* Intra-area routes found by the last calculation, reused while
+     neither the LSDB nor the interfaces of the area have changed. */
+  struct route_table *spf_table;
+  struct route_table *spf_rtrs;
+  int spf_pending;			/* Area changed since. */
+
   /* Threads. */
   struct thread *t_stub_router;    /* Stub-router timer */
   struct thread *t_opaque_lsa_self;	/* Type-10 Opaque-LSAs origin. */
 
   /* Statistics field. */
   u_int32_t spf_calculation;	/* SPF Calculation Count. */
+  u_int32_t spf_incremental;	/* ... of which reused the tree. */
 
   /* Time stamps. */
   struct timeval ts_spf;		/* SPF calculation time stamp. */
@@ -0,0 +1,320 @@
+/*
+ * BGP RIB snapshot unit test.  Saves the paths of one BGP view with
+ * bgp_snapshot_save(), loads them into another with bgp_snapshot_load()
+ * and checks what was restored.  Then feeds the loader snapshots whose
+ * records are cut short or corrupted, which must be rejected without
+ * tripping the stream bounds checks, and must not be loaded again.
+ *
+ * This file is part of Quagga
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <zebra.h>
+
+#include "qobj.h"
+#include "vty.h"
+#include "stream.h"
+#include "privs.h"
+#include "memory.h"
+#include "sockunion.h"
+#include "prefix.h"
+#include "vrf.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_table.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_snapshot.h"
+
+#define SNAPSHOT_FILE   "bgp_snapshot_test.snap"
+
+/* need these to link in libbgp */
+struct thread_master *master = NULL;
+struct zebra_privs_t bgpd_privs =
+{
+  .user = NULL,
+  .group = NULL,
+  .vty_group = NULL,
+};
+
+static int failed = 0;
+
+static const char *peer_addrs[] = { "192.0.2.1", "192.0.2.2", "192.0.2.3" };
+#define NPEERS (sizeof (peer_addrs) / sizeof (peer_addrs[0]))
+
+/* Paths each peer of the saved view has: the last peer has none. */
+static const int peer_paths[NPEERS] = { 3, 2, 0 };
+
+static as_t asn = 100;
+
+static struct bgp *
+view_create (const char *name, struct peer **peers)
+{
+  struct bgp *bgp;
+  union sockunion su;
+  as_t as = asn;
+  unsigned int i;
+
+  if (bgp_get (&bgp, &as, name, BGP_INSTANCE_TYPE_VIEW))
+    return NULL;
+
+  bgp->snapshot_file = XSTRDUP (MTYPE_BGP, SNAPSHOT_FILE);
+
+  for (i = 0; i < NPEERS; i++)
+    {
+      str2sockunion (peer_addrs[i], &su);
+      as = asn;
+      if (peer_remote_as (bgp, &su, NULL, &as, AS_SPECIFIED,
+                          AFI_IP, SAFI_UNICAST))
+        return NULL;
+      peers[i] = peer_lookup (bgp, &su);
+      peers[i]->status = Established;
+    }
+
+  return bgp;
+}
+
+static void
+path_add (struct peer *peer, int n)
+{
+  struct attr attr;
+  struct prefix p;
+  char buf[PREFIX_STRLEN];
+
+  snprintf (buf, sizeof (buf), "10.%u.%d.0/24",
+            ntohl (peer->su.sin.sin_addr.s_addr) & 0xff, n);
+  str2prefix (buf, &p);
+
+  memset (&attr, 0, sizeof (struct attr));
+  bgp_attr_default_set (&attr, BGP_ORIGIN_IGP);
+  attr.extra->mp_nexthop_len = 0;
+  attr.nexthop = peer->su.sin.sin_addr;
+  attr.flag |= ATTR_FLAG_BIT (BGP_ATTR_NEXT_HOP);
+  attr.med = n;
+  attr.flag |= ATTR_FLAG_BIT (BGP_ATTR_MULTI_EXIT_DISC);
+
+  bgp_update (peer, &p, 0, &attr, AFI_IP, SAFI_UNICAST, ZEBRA_ROUTE_BGP,
+              BGP_ROUTE_NORMAL, NULL, NULL, 0);
+
+  aspath_unintern (&attr.aspath);
+  bgp_attr_extra_free (&attr);
+}
+
+/* Stale paths of the peer in the view, and whether their MEDs are the
+ * ones path_add() gave them. */
+static int
+stale_paths (struct bgp *bgp, struct peer *peer, int *meds_ok)
+{
+  struct bgp_node *rn;
+  struct bgp_info *ri;
+  int count = 0;
+
+  *meds_ok = 1;
+  for (rn = bgp_table_top (bgp->rib[AFI_IP][SAFI_UNICAST]); rn;
+       rn = bgp_route_next (rn))
+    for (ri = rn->info; ri; ri = ri->next)
+      if (ri->peer == peer && CHECK_FLAG (ri->flags, BGP_INFO_STALE))
+        {
+          if (ri->attr->med != ((ntohl (rn->p.u.prefix4.s_addr) >> 8) & 0xff))
+            *meds_ok = 0;
+          count++;
+        }
+
+  return count;
+}
+
+static int
+file_exists (const char *path)
+{
+  struct stat st;
+
+  return stat (path, &st) == 0;
+}
+
+static u_char *
+file_read (const char *path, size_t *size)
+{
+  struct stat st;
+  u_char *buf;
+  FILE *f;
+
+  if (stat (path, &st) < 0 || !(f = fopen (path, "r")))
+    return NULL;
+
+  buf = malloc (st.st_size);
+  *size = fread (buf, 1, st.st_size, f);
+  fclose (f);
+  return buf;
+}
+
+static void
+file_write (const char *path, const u_char *buf, size_t size)
+{
+  FILE *f = fopen (path, "w");
+
+  fwrite (buf, 1, size, f);
+  fclose (f);
+}
+
+static void
+result (const char *name, int ok)
+{
+  printf ("%s: %s\n", name, ok ? "OK" : "failed");
+  if (!ok)
+    failed++;
+}
+
+/* Offset of the first route record, whose length is its first two
+ * octets. */
+static size_t
+first_route (const u_char *buf)
+{
+  size_t off = BGP_SNAPSHOT_HEADER_SIZE;
+  unsigned int i, npeers = (buf[6] << 8) | buf[7];
+
+  for (i = 0; i < npeers; i++)
+    off += 1 + (buf[off] == AFI_IP ? IPV4_MAX_BYTELEN : IPV6_MAX_BYTELEN);
+  return off;
+}
+
+int
+main (void)
+{
+  struct bgp *saved, *loaded;
+  struct peer *speers[NPEERS], *lpeers[NPEERS];
+  u_char *snap, *bad;
+  size_t size, route, len, cut;
+  unsigned int i;
+  int n, ok, meds_ok, rejected, kept;
+
+  qobj_init ();
+  master = thread_master_create ();
+  bgp_master_init ();
+  vrf_init ();
+  bgp_option_set (BGP_OPT_NO_LISTEN);
+  bgp_option_set (BGP_OPT_MULTIPLE_INSTANCE);
+  bgp_attr_init ();
+
+  unlink (SNAPSHOT_FILE);
+
+  saved = view_create ("saved", speers);
+  loaded = view_create ("loaded", lpeers);
+  if (!saved || !loaded)
+    {
+      printf ("can't create BGP views\n");
+      return 1;
+    }
+
+  for (i = 0; i < NPEERS; i++)
+    for (n = 0; n < peer_paths[i]; n++)
+      path_add (speers[i], n);
+
+  /* Save, and keep a copy of the file to corrupt below. */
+  ok = bgp_snapshot_save (saved) == 0;
+  snap = file_read (SNAPSHOT_FILE, &size);
+  if (!snap || size <= first_route (snap) + 2)
+    ok = 0;
+  result ("save", ok);
+  if (!ok)
+    {
+      printf ("failures: %d\n", failed);
+      return failed;
+    }
+
+  /* Load: every path comes back as a stale path of the same peer. */
+  ok = bgp_snapshot_load (loaded) == 0;
+  for (i = 0; i < NPEERS; i++)
+    {
+      if (stale_paths (loaded, lpeers[i], &meds_ok) != peer_paths[i]
+          || !meds_ok)
+        ok = 0;
+    }
+  result ("load", ok);
+
+  /* Only peers with restored paths are treated as restarting. */
+  ok = 1;
+  for (i = 0; i < NPEERS; i++)
+    {
+      int restarting = peer_paths[i] > 0;
+
+      if (!!lpeers[i]->nsf[AFI_IP][SAFI_UNICAST] != restarting
+          || !!lpeers[i]->t_gr_stale != restarting)
+        ok = 0;
+    }
+  result ("stale timer for peers with restored paths only", ok);
+
+  /* The snapshot is consumed. */
+  result ("snapshot removed once loaded",
+          !file_exists (SNAPSHOT_FILE) && !file_exists (SNAPSHOT_FILE ".load"));
+
+  /* A snapshot cut short between records. */
+  route = first_route (snap);
+  file_write (SNAPSHOT_FILE, snap, route + 2 + ((snap[route] << 8)
+                                                | snap[route + 1]));
+  ok = bgp_snapshot_load (loaded) < 0 && !file_exists (SNAPSHOT_FILE)
+       && !file_exists (SNAPSHOT_FILE ".load");
+  result ("truncated snapshot", ok);
+
+  /* The first record cut short at every length, with its length field
+   * telling the truth, so that only the record parser can catch it. */
+  len = (snap[route] << 8) | snap[route + 1];
+  bad = malloc (size);
+  rejected = kept = 0;
+  for (cut = 0; cut < len; cut++)
+    {
+      memcpy (bad, snap, route);
+      bad[route] = cut >> 8;
+      bad[route + 1] = cut & 0xff;
+      memcpy (bad + route + 2, snap + route + 2, cut);
+      file_write (SNAPSHOT_FILE, bad, route + 2 + cut);
+
+      if (bgp_snapshot_load (loaded) < 0)
+        rejected++;
+      if (file_exists (SNAPSHOT_FILE) || file_exists (SNAPSHOT_FILE ".load"))
+        kept++;
+    }
+  result ("short records", rejected == (int) len && !kept);
+
+  /* Every octet of the first record set to each of a few values: the
+   * loader may accept some of these, but must survive all of them. */
+  kept = 0;
+  for (cut = 0; cut < len; cut++)
+    {
+      static const u_char vals[] = { 0x00, 0x01, 0x7f, 0x80, 0xff };
+
+      for (i = 0; i < sizeof (vals); i++)
+        {
+          memcpy (bad, snap, size);
+          bad[route + 2 + cut] = vals[i];
+          file_write (SNAPSHOT_FILE, bad, size);
+
+          bgp_snapshot_load (loaded);
+          if (file_exists (SNAPSHOT_FILE)
+              || file_exists (SNAPSHOT_FILE ".load"))
+            kept++;
+        }
+    }
+  result ("corrupt records", !kept);
+
+  free (bad);
+  free (snap);
+  unlink (SNAPSHOT_FILE);
+
+  printf ("failures: %d\n", failed);
+  return failed;
+}
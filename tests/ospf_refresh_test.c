@@ -0,0 +1,300 @@
+/*
+ * OSPF LSA refresher unit test.  Registers self-originated LSAs with
+ * ospf_refresher_register_lsa() and checks which refresh slots they land
+ * in: only slots of the jitter window before OSPF_LS_REFRESH_TIME, and
+ * spread evenly over them, wherever the refresher is in its slot ring.
+ * Then runs ospf_lsa_refresh_walker() over a slot with more LSAs than
+ * 'refresh rate-limit' allows, and checks which of them are held back.
+ *
+ * This file is part of Quagga
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <zebra.h>
+
+#include "linklist.h"
+#include "prefix.h"
+#include "table.h"
+#include "thread.h"
+#include "memory.h"
+#include "privs.h"
+
+#include "ospfd/ospfd.h"
+#include "ospfd/ospf_asbr.h"
+#include "ospfd/ospf_lsa.h"
+
+/* Slots of the window LSAs are refreshed in: between OSPF_LS_REFRESH_TIME
+ * less twice the jitter and less the jitter, in seconds from now. */
+#define WINDOW_FIRST    ((OSPF_LS_REFRESH_TIME - 2 * OSPF_LS_REFRESH_JITTER) \
+                         / OSPF_LSA_REFRESHER_GRANULARITY)
+#define WINDOW_SLOTS    (OSPF_LS_REFRESH_JITTER / OSPF_LSA_REFRESHER_GRANULARITY)
+
+#define LSAS            6000
+
+/* LSAs per second for the walker test, and how many of its LSAs are too
+ * old to be held back. */
+#define RATE            100
+#define OLD             10
+
+/* need these to link in libospf */
+struct thread_master *master = NULL;
+struct zebra_privs_t ospfd_privs =
+{
+  .user = NULL,
+  .group = NULL,
+  .vty_group = NULL,
+};
+
+static int failed = 0;
+
+static struct ospf_lsa *lsas[LSAS];
+
+static void
+result (const char *name, int ok)
+{
+  printf ("%s: %s\n", name, ok ? "OK" : "failed");
+  if (!ok)
+    failed++;
+}
+
+/* AS-external LSAs translated from NSSA LSAs, which are refreshed with
+ * the NSSA LSA: ospf_lsa_refresh() leaves them alone. */
+static struct ospf_lsa *
+lsa_self_new (int n)
+{
+  struct ospf_lsa *lsa;
+
+  lsa = ospf_lsa_new ();
+  lsa->data = ospf_lsa_data_new (OSPF_LSA_HEADER_SIZE);
+  lsa->data->type = OSPF_AS_EXTERNAL_LSA;
+  lsa->data->id.s_addr = htonl (n);
+  SET_FLAG (lsa->flags, OSPF_LSA_SELF | OSPF_LSA_LOCAL_XLT);
+  return lsa;
+}
+
+static unsigned int
+slot_count (struct ospf *ospf, int slot)
+{
+  struct list *list = ospf->lsa_refresh_queue.qs[slot];
+
+  return list ? listcount (list) : 0;
+}
+
+/* Register LSAs [from, to) with the refresher sitting at the given slot
+ * of its ring, and check that each of them went to a slot of the
+ * window. */
+static int
+register_range (struct ospf *ospf, u_int16_t at, int from, int to)
+{
+  int i, slot, ok = 1;
+
+  ospf->lsa_refresh_queue.index = at;
+  ospf->lsa_refresher_started = quagga_monotime ();
+
+  for (i = from; i < to; i++)
+    {
+      ospf_refresher_register_lsa (ospf, lsas[i]);
+
+      slot = (lsas[i]->refresh_list - at - WINDOW_FIRST
+              + OSPF_LSA_REFRESHER_SLOTS) % OSPF_LSA_REFRESHER_SLOTS;
+      if (lsas[i]->refresh_list < 0 || slot >= WINDOW_SLOTS)
+        ok = 0;
+    }
+
+  return ok;
+}
+
+/* The slots of the window seen from the given slot hold n LSAs between
+ * them, and differ by at most one LSA. */
+static int
+window_even (struct ospf *ospf, u_int16_t at, unsigned int n)
+{
+  unsigned int count, least = UINT_MAX, most = 0, total = 0;
+  int i;
+
+  for (i = 0; i < WINDOW_SLOTS; i++)
+    {
+      count = slot_count (ospf, (at + WINDOW_FIRST + i)
+                                % OSPF_LSA_REFRESHER_SLOTS);
+      least = MIN (least, count);
+      most = MAX (most, count);
+      total += count;
+    }
+
+  return total == n && most - least <= 1;
+}
+
+/* Queue LSAs [from, to) in a slot by hand, as registering them would
+ * have. */
+static void
+slot_fill (struct ospf *ospf, int slot, int from, int to)
+{
+  int i;
+
+  if (!ospf->lsa_refresh_queue.qs[slot])
+    ospf->lsa_refresh_queue.qs[slot] = list_new ();
+  for (i = from; i < to; i++)
+    {
+      listnode_add (ospf->lsa_refresh_queue.qs[slot], ospf_lsa_lock (lsas[i]));
+      lsas[i]->refresh_list = slot;
+    }
+}
+
+/* Run the walker one slot on from slot 0, with a rate limit of RATE. */
+static void
+walk (struct ospf *ospf)
+{
+  struct thread thread;
+
+  ospf->lsa_refresh_rate = RATE;
+  ospf->lsa_refresh_interval = OSPF_LSA_REFRESHER_GRANULARITY;
+  ospf->lsa_refresh_queue.index = 0;
+  ospf->lsa_refresher_started = quagga_monotime ()
+                                - OSPF_LSA_REFRESHER_GRANULARITY;
+
+  memset (&thread, 0, sizeof (thread));
+  thread.arg = ospf;
+  ospf_lsa_refresh_walker (&thread);
+  thread_cancel (ospf->t_lsa_refresher);
+  ospf->t_lsa_refresher = NULL;
+}
+
+static int
+unregister_all (struct ospf *ospf)
+{
+  int i, ok = 1;
+
+  for (i = 0; i < LSAS; i++)
+    {
+      ospf_refresher_unregister_lsa (ospf, lsas[i]);
+      if (lsas[i]->refresh_list != -1 || lsas[i]->lock != 1)
+        ok = 0;
+    }
+  for (i = 0; i < OSPF_LSA_REFRESHER_SLOTS; i++)
+    if (ospf->lsa_refresh_queue.qs[i])
+      ok = 0;
+
+  return ok;
+}
+
+int
+main (void)
+{
+  struct ospf *ospf;
+  u_int16_t at;
+  struct listnode *node;
+  struct ospf_lsa *lsa;
+  struct timeval now;
+  int i, ok, moved;
+  unsigned int per_slot, limit;
+
+  master = thread_master_create ();
+  ospf = XCALLOC (MTYPE_OSPF_TOP, sizeof (struct ospf));
+  srandom (1);
+
+  /* The LSAs' age counts from the thread library's clock. */
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
+  for (i = 0; i < LSAS; i++)
+    lsas[i] = lsa_self_new (i);
+
+  /* A few LSAs take a window slot each. */
+  ok = register_range (ospf, 0, 0, WINDOW_SLOTS);
+  for (i = 0; i < WINDOW_SLOTS; i++)
+    if (slot_count (ospf, lsas[i]->refresh_list) != 1)
+      ok = 0;
+  result ("one LSA per slot", ok);
+  result ("unregister", unregister_all (ospf));
+
+  /* A burst of originations is spread evenly over the window. */
+  result ("burst spread over the window",
+          register_range (ospf, 0, 0, LSAS) && window_even (ospf, 0, LSAS));
+
+  /* An LSA is only registered once. */
+  moved = 0;
+  for (i = 0; i < LSAS; i++)
+    {
+      int slot = lsas[i]->refresh_list;
+
+      ospf_refresher_register_lsa (ospf, lsas[i]);
+      if (lsas[i]->refresh_list != slot || lsas[i]->lock != 2)
+        moved++;
+    }
+  result ("registered once", !moved);
+  unregister_all (ospf);
+
+  /* The window is taken from where the refresher is, wrapping around the
+   * end of its ring. */
+  at = OSPF_LSA_REFRESHER_SLOTS - WINDOW_FIRST - 2;
+  result ("window wraps around the ring",
+          register_range (ospf, at, 0, LSAS) && window_even (ospf, at, LSAS));
+  unregister_all (ospf);
+
+  /* Two slots later, the window has two slots the earlier LSAs are not
+   * in: new LSAs fill those before the others. */
+  per_slot = LSAS / 2 / WINDOW_SLOTS;
+  register_range (ospf, 0, 0, LSAS / 2);
+  ok = register_range (ospf, 2, LSAS / 2, LSAS / 2 + 2 * per_slot)
+       && window_even (ospf, 2, WINDOW_SLOTS * per_slot);
+  result ("emptier slots filled first", ok);
+  unregister_all (ospf);
+
+  /* Over the rate limit, the LSAs of a slot are held back for the next
+   * run, ahead of the LSAs it already has. */
+  limit = RATE * OSPF_LSA_REFRESHER_GRANULARITY;
+  slot_fill (ospf, 0, 0, 3 * limit);
+  slot_fill (ospf, 1, 3 * limit, 4 * limit);
+  walk (ospf);
+
+  ok = (ospf->lsa_refresh_stats.refreshed == limit
+        && ospf->lsa_refresh_stats.deferred == 2 * limit
+        && !ospf->lsa_refresh_queue.qs[0]
+        && slot_count (ospf, 1) == 3 * limit);
+  for (i = 0; i < limit; i++)
+    if (lsas[i]->refresh_list != -1 || lsas[i]->lock != 1)
+      ok = 0;
+  result ("rate limit", ok);
+
+  i = limit;
+  for (ALL_LIST_ELEMENTS_RO (ospf->lsa_refresh_queue.qs[1], node, lsa))
+    if (lsa != lsas[i++] || lsa->refresh_list != 1)
+      ok = 0;
+  result ("held back LSAs first in the next slot, in order", ok);
+  unregister_all (ospf);
+
+  /* An LSA that could not wait for the next run without passing the
+   * refresh interval is refreshed regardless of the limit. */
+  for (i = 2 * limit - OLD; i < 2 * limit; i++)
+    lsas[i]->data->ls_age = htons (OSPF_LS_REFRESH_TIME
+                                   - OSPF_LSA_REFRESHER_GRANULARITY + 1);
+  slot_fill (ospf, 0, 0, 2 * limit);
+  walk (ospf);
+
+  ok = (ospf->lsa_refresh_stats.refreshed == limit + OLD
+        && ospf->lsa_refresh_stats.deferred == limit - OLD);
+  for (i = 2 * limit - OLD; i < 2 * limit; i++)
+    if (lsas[i]->refresh_list != -1)
+      ok = 0;
+  result ("no LSA held back past the refresh interval", ok);
+  unregister_all (ospf);
+
+  for (i = 0; i < LSAS; i++)
+    ospf_lsa_discard (lsas[i]);
+  XFREE (MTYPE_OSPF_TOP, ospf);
+
+  printf ("failures: %d\n", failed);
+  return failed;
+}
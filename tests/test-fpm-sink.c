@@ -0,0 +1,597 @@
+/*
+ * FPM sink test. Runs zebra's FPM client (zebra_fpm.c and the netlink
+ * encoder in zebra_fpm_netlink.c) against an FPM that listens on the
+ * loopback in the same process, over a table of routes set up here, and
+ * checks what reaches the FPM: the sequence numbers and pid of the
+ * route messages, the packing of route messages into FPM messages with
+ * 'fpm batch', the acknowledgement of sequence numbers, and incremental
+ * and full resyncs.  It also reports how many routes per second reach
+ * the FPM in a full resync, with and without 'fpm batch'.
+ *
+ * This file is part of Quagga
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <zebra.h>
+
+#include "thread.h"
+#include "command.h"
+#include "vty.h"
+#include "buffer.h"
+#include "memory.h"
+#include "privs.h"
+#include "prefix.h"
+#include "table.h"
+#include "nexthop.h"
+#include "fpm/fpm.h"
+
+#include "zebra/rib.h"
+#include "zebra/zserv.h"
+#include "zebra/zebra_vrf.h"
+#include "zebra/zebra_fpm.h"
+
+#define ROUTES          10000
+#define CHANGED         200
+#define IO_BUF_SIZE     65536
+
+/* What the rest of zebra would provide. */
+struct zebra_t zebrad;
+struct zebra_privs_t zserv_privs;
+unsigned int multipath_num = MULTIPATH_NUM;
+u_int32_t nl_rcvbufsize = 4194304;
+
+struct thread_master *master;
+
+int
+netlink_interface_addr (struct sockaddr_nl *snl, struct nlmsghdr *h,
+                        ns_id_t ns_id, int startup)
+{
+  return 0;
+}
+
+int
+netlink_link_change (struct sockaddr_nl *snl, struct nlmsghdr *h,
+                     ns_id_t ns_id, int startup)
+{
+  return 0;
+}
+
+int
+netlink_route_change (struct sockaddr_nl *snl, struct nlmsghdr *h,
+                      ns_id_t ns_id, int startup)
+{
+  return 0;
+}
+
+int
+netlink_neigh_change (struct sockaddr_nl *snl, struct nlmsghdr *h,
+                      ns_id_t ns_id)
+{
+  return 0;
+}
+
+/* The RIB: one IPv4 unicast table of /32 routes in the default VRF. */
+static struct zebra_vrf zvrf;
+static rib_table_info_t table_info;
+static struct route_table *table;
+static struct route_node *nodes[ROUTES];
+static struct rib ribs[ROUTES];
+static struct nexthop nexthops[ROUTES];
+
+struct route_table *
+rib_tables_iter_next (rib_tables_iter_t *iter)
+{
+  if (iter->state == RIB_TABLES_ITER_S_INIT)
+    {
+      iter->state = RIB_TABLES_ITER_S_ITERATING;
+      return table;
+    }
+  iter->state = RIB_TABLES_ITER_S_DONE;
+  return NULL;
+}
+
+int
+rib_gc_dest (struct route_node *rn)
+{
+  rib_dest_t *dest = rib_dest_from_rnode (rn);
+
+  if (!dest || dest->routes
+      || CHECK_FLAG (dest->flags, RIB_DEST_UPDATE_FPM)
+      || CHECK_FLAG (dest->flags, RIB_DEST_SENT_TO_FPM))
+    return 0;
+
+  zfpm_dest_deleted (rn);
+  XFREE (MTYPE_TMP, dest);
+  rn->info = NULL;
+  route_unlock_node (rn);
+  return 1;
+}
+
+static void
+rib_setup (void)
+{
+  struct prefix p;
+  rib_dest_t *dest;
+  int i;
+
+  table = route_table_init ();
+  table_info.zvrf = &zvrf;
+  table_info.afi = AFI_IP;
+  table_info.safi = SAFI_UNICAST;
+  table->info = &table_info;
+
+  memset (&p, 0, sizeof (p));
+  p.family = AF_INET;
+  p.prefixlen = IPV4_MAX_BITLEN;
+
+  for (i = 0; i < ROUTES; i++)
+    {
+      p.u.prefix4.s_addr = htonl (0x0a000000 | i);
+      nodes[i] = route_node_get (table, &p);
+      /* kept, so that the node outlives a dest freed by rib_gc_dest() */
+      route_lock_node (nodes[i]);
+
+      nexthops[i].type = NEXTHOP_TYPE_IPV4_IFINDEX;
+      nexthops[i].gate.ipv4.s_addr = htonl (0xc0000201);
+      nexthops[i].ifindex = 2;
+      SET_FLAG (nexthops[i].flags, NEXTHOP_FLAG_ACTIVE);
+      SET_FLAG (nexthops[i].flags, NEXTHOP_FLAG_FIB);
+
+      ribs[i].type = ZEBRA_ROUTE_STATIC;
+      ribs[i].metric = i;
+      ribs[i].status = RIB_ENTRY_SELECTED_FIB;
+      ribs[i].nexthop = &nexthops[i];
+
+      dest = XCALLOC (MTYPE_TMP, sizeof (rib_dest_t));
+      dest->rnode = nodes[i];
+      dest->routes = &ribs[i];
+      nodes[i]->info = dest;
+    }
+}
+
+/* The FPM end of the connection. */
+struct sink
+{
+  int lsock;
+  int sock;
+  char buf[IO_BUF_SIZE];
+  size_t len;
+
+  unsigned long frames;
+  unsigned long adds;
+  unsigned long dels;
+  unsigned long dones;
+  int done_full;
+  uint32_t done_seq;
+  uint32_t last_seq;
+  unsigned int max_per_frame;
+  int errors;
+  unsigned int seen[ROUTES];
+};
+
+static struct sink sink;
+
+static void
+sink_reset_counts (void)
+{
+  sink.frames = sink.adds = sink.dels = sink.dones = 0;
+  sink.done_full = -1;
+  sink.max_per_frame = 0;
+  memset (sink.seen, 0, sizeof (sink.seen));
+}
+
+static void
+sink_route (struct nlmsghdr *nlh)
+{
+  struct rtmsg *rtm = NLMSG_DATA (nlh);
+  struct rtattr *rta;
+  int len;
+  uint32_t i;
+
+  len = RTM_PAYLOAD (nlh);
+  for (rta = RTM_RTA (rtm); RTA_OK (rta, len); rta = RTA_NEXT (rta, len))
+    if (rta->rta_type == RTA_DST)
+      {
+        i = ntohl (*(uint32_t *) RTA_DATA (rta)) & 0xffffff;
+        if (i < ROUTES)
+          sink.seen[i]++;
+        return;
+      }
+  printf ("route message without a destination\n");
+  sink.errors++;
+}
+
+static void
+sink_netlink (char *buf, size_t buf_len)
+{
+  struct nlmsghdr *nlh;
+  unsigned int in_frame = 0;
+  int len = buf_len;
+
+  for (nlh = (struct nlmsghdr *) buf; NLMSG_OK (nlh, len);
+       nlh = NLMSG_NEXT (nlh, len))
+    {
+      if (nlh->nlmsg_pid != (uint32_t) getpid ())
+        {
+          printf ("message with pid %u\n", nlh->nlmsg_pid);
+          sink.errors++;
+        }
+
+      switch (nlh->nlmsg_type)
+        {
+        case RTM_NEWROUTE:
+        case RTM_DELROUTE:
+          if (nlh->nlmsg_type == RTM_NEWROUTE)
+            sink.adds++;
+          else
+            sink.dels++;
+          if (nlh->nlmsg_seq <= sink.last_seq)
+            {
+              printf ("sequence number %u after %u\n", nlh->nlmsg_seq,
+                      sink.last_seq);
+              sink.errors++;
+            }
+          sink.last_seq = nlh->nlmsg_seq;
+          sink_route (nlh);
+          in_frame++;
+          break;
+
+        case NLMSG_DONE:
+          sink.dones++;
+          sink.done_full = (*(int *) NLMSG_DATA (nlh) == FPM_RESYNC_FULL);
+          sink.done_seq = nlh->nlmsg_seq;
+          break;
+
+        default:
+          printf ("unexpected netlink message type %u\n", nlh->nlmsg_type);
+          sink.errors++;
+          break;
+        }
+    }
+
+  /* An FPM message carries whole netlink messages only. */
+  if (len)
+    {
+      printf ("%d stray octets at the end of an FPM message\n", len);
+      sink.errors++;
+    }
+  if (in_frame > sink.max_per_frame)
+    sink.max_per_frame = in_frame;
+}
+
+static int
+sink_read (struct thread *t)
+{
+  fpm_msg_hdr_t *hdr;
+  size_t off = 0;
+  ssize_t n;
+
+  n = read (sink.sock, sink.buf + sink.len, sizeof (sink.buf) - sink.len);
+  if (n <= 0)
+    {
+      printf ("zebra closed the connection\n");
+      sink.errors++;
+      return 0;
+    }
+  sink.len += n;
+
+  while (sink.len - off >= FPM_MSG_HDR_LEN)
+    {
+      hdr = (fpm_msg_hdr_t *) (sink.buf + off);
+      if (!fpm_msg_hdr_ok (hdr) || hdr->msg_type != FPM_MSG_TYPE_NETLINK)
+        {
+          printf ("bad FPM message header\n");
+          sink.errors++;
+          return 0;
+        }
+      if (!fpm_msg_ok (hdr, sink.len - off))
+        break;
+
+      sink.frames++;
+      sink_netlink ((char *) fpm_msg_data (hdr), fpm_msg_data_len (hdr));
+      off += fpm_msg_len (hdr);
+    }
+
+  memmove (sink.buf, sink.buf + off, sink.len - off);
+  sink.len -= off;
+
+  thread_add_read (master, sink_read, NULL, sink.sock);
+  return 0;
+}
+
+static int
+sink_accept (struct thread *t)
+{
+  sink.sock = accept (sink.lsock, NULL, NULL);
+  if (sink.sock < 0)
+    {
+      perror ("accept");
+      exit (1);
+    }
+  thread_add_read (master, sink_read, NULL, sink.sock);
+  return 0;
+}
+
+static uint16_t
+sink_listen (void)
+{
+  struct sockaddr_in sin;
+  socklen_t slen = sizeof (sin);
+
+  sink.sock = -1;
+  sink.lsock = socket (AF_INET, SOCK_STREAM, 0);
+  memset (&sin, 0, sizeof (sin));
+  sin.sin_family = AF_INET;
+  sin.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  if (sink.lsock < 0
+      || bind (sink.lsock, (struct sockaddr *) &sin, sizeof (sin)) < 0
+      || listen (sink.lsock, 1) < 0
+      || getsockname (sink.lsock, (struct sockaddr *) &sin, &slen) < 0)
+    {
+      perror ("listen");
+      exit (1);
+    }
+  thread_add_read (master, sink_accept, NULL, sink.lsock);
+  return ntohs (sin.sin_port);
+}
+
+/* A netlink message to zebra, in an FPM message of its own. */
+static void
+sink_send (uint16_t type, uint32_t pid, uint32_t seq)
+{
+  char buf[FPM_MSG_HDR_LEN + NLMSG_SPACE (sizeof (struct nlmsgerr))];
+  fpm_msg_hdr_t *hdr = (fpm_msg_hdr_t *) buf;
+  struct nlmsghdr *nlh;
+  size_t data_len;
+
+  memset (buf, 0, sizeof (buf));
+  nlh = (struct nlmsghdr *) fpm_msg_data (hdr);
+  if (type == NLMSG_ERROR)
+    data_len = NLMSG_SPACE (sizeof (struct nlmsgerr));
+  else
+    data_len = NLMSG_SPACE (sizeof (struct rtmsg));
+
+  nlh->nlmsg_len = data_len;
+  nlh->nlmsg_type = type;
+  nlh->nlmsg_flags = NLM_F_REQUEST;
+  nlh->nlmsg_seq = seq;
+  nlh->nlmsg_pid = pid;
+
+  hdr->version = FPM_PROTO_VERSION;
+  hdr->msg_type = FPM_MSG_TYPE_NETLINK;
+  hdr->msg_len = htons (fpm_data_len_to_msg_len (data_len));
+  if (write (sink.sock, buf, fpm_msg_len (hdr)) != fpm_msg_len (hdr))
+    {
+      perror ("write");
+      exit (1);
+    }
+}
+
+/* Run the event loop for the given time. */
+static int timer_expired;
+
+static int
+timer_cb (struct thread *t)
+{
+  timer_expired = 1;
+  return 0;
+}
+
+static void
+run (long msecs)
+{
+  struct thread thread;
+
+  timer_expired = 0;
+  thread_add_timer_msec (master, timer_cb, NULL, msecs);
+  while (!timer_expired && thread_fetch (master, &thread))
+    thread_call (&thread);
+}
+
+/* Run the event loop until the FPM has seen the end of a resync, or for
+ * at most the given time. */
+static void
+run_until_done (long msecs)
+{
+  struct thread thread, *timer;
+
+  timer_expired = 0;
+  timer = thread_add_timer_msec (master, timer_cb, NULL, msecs);
+  while (!sink.dones && !timer_expired && thread_fetch (master, &thread))
+    thread_call (&thread);
+  if (!timer_expired)
+    thread_cancel (timer);
+}
+
+static struct vty *vty;
+
+static void
+command (int node, const char *line)
+{
+  vector vline;
+
+  vty->node = node;
+  vline = cmd_make_strvec (line);
+  if (cmd_execute_command (vline, vty, NULL, 0) != CMD_SUCCESS)
+    {
+      printf ("command '%s' failed\n", line);
+      exit (1);
+    }
+  cmd_free_strvec (vline);
+}
+
+static int
+check_ack (uint32_t seq)
+{
+  char expect[64];
+  char *out;
+  int ok;
+
+  buffer_reset (vty->obuf);
+  command (ENABLE_NODE, "show zebra fpm stats");
+  out = buffer_getstr (vty->obuf);
+  snprintf (expect, sizeof (expect), "last acknowledged: %u", seq);
+  ok = (strstr (out, expect) != NULL);
+  XFREE (MTYPE_TMP, out);
+  return ok;
+}
+
+static int failed;
+
+static void
+check (const char *step, int ok)
+{
+  printf ("%-50s %s\n", step, ok ? "ok" : "FAILED");
+  if (!ok || sink.errors)
+    failed = 1;
+  sink.errors = 0;
+}
+
+/* Time a full resync, which the FPM asks for under a pid other than
+ * zebra's, and report the rate at which its routes arrive. */
+static void
+throughput (const char *step, uint32_t pid, unsigned long routes)
+{
+  struct timeval start, stop;
+  long usecs;
+
+  sink_reset_counts ();
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  sink_send (RTM_GETROUTE, pid + 1, sink.last_seq);
+  run_until_done (5000);
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &stop);
+
+  usecs = 1000000 * (stop.tv_sec - start.tv_sec);
+  usecs += stop.tv_usec - start.tv_usec;
+
+  check (step, sink.adds == routes && sink.dones == 1
+         && sink.done_full == 1);
+  printf ("  %lu routes in %lu FPM messages took %ld.%06ld seconds",
+          sink.adds, sink.frames, usecs / 1000000, usecs % 1000000);
+  if (usecs)
+    printf (", %.0f routes per second", sink.adds * 1e6 / usecs);
+  printf ("\n");
+}
+
+/* Each route in [from, to) was seen once, and no other route. */
+static int
+seen_once (int from, int to)
+{
+  int i;
+
+  for (i = 0; i < ROUTES; i++)
+    if (sink.seen[i] != (i >= from && i < to))
+      return 0;
+  return 1;
+}
+
+int
+main (void)
+{
+  uint32_t pid = getpid ();
+  uint32_t before_changes, before_delete;
+  uint16_t port;
+  int i;
+
+  master = thread_master_create ();
+  cmd_init (1);
+  vty_init (master);
+  vty = vty_new ();
+  vty->type = VTY_TERM;
+
+  rib_setup ();
+  port = sink_listen ();
+  zfpm_init (master, 1, port, "netlink");
+
+  /* On connecting, zebra sends the whole table, one route per message. */
+  sink_reset_counts ();
+  run (1000);
+  check ("full table on connect",
+         sink.adds == ROUTES && sink.frames == ROUTES
+         && seen_once (0, ROUTES) && sink.last_seq == ROUTES
+         && sink.dones == 0);
+
+  sink_send (NLMSG_ERROR, pid, sink.last_seq);
+  run (100);
+  check ("acknowledgement", check_ack (sink.last_seq));
+
+  /* With 'fpm batch', changes are packed into as few messages as fit. */
+  command (CONFIG_NODE, "fpm batch");
+  before_changes = sink.last_seq;
+  sink_reset_counts ();
+  for (i = 0; i < CHANGED; i++)
+    {
+      ribs[i].metric += ROUTES;
+      zfpm_trigger_update (nodes[i], NULL);
+    }
+  run (200);
+  check ("batched changes",
+         sink.adds == CHANGED && seen_once (0, CHANGED)
+         && sink.frames > 1 && sink.frames < CHANGED / 10
+         && sink.last_seq == before_changes + CHANGED);
+
+  /* A resync from before the changes resends only the changed routes. */
+  sink_reset_counts ();
+  sink_send (RTM_GETROUTE, pid, before_changes);
+  run (200);
+  check ("incremental resync",
+         sink.adds == CHANGED && seen_once (0, CHANGED)
+         && sink.dones == 1 && sink.done_full == 0
+         && sink.done_seq == sink.last_seq);
+
+  /* A route is withdrawn, and its dest freed once the FPM knows. */
+  before_delete = sink.last_seq;
+  sink_reset_counts ();
+  rib_dest_from_rnode (nodes[ROUTES - 1])->routes = NULL;
+  zfpm_trigger_update (nodes[ROUTES - 1], NULL);
+  run (100);
+  check ("route withdrawn",
+         sink.dels == 1 && sink.adds == 0 && seen_once (ROUTES - 1, ROUTES)
+         && nodes[ROUTES - 1]->info == NULL);
+
+  /* The FPM has everything up to the withdrawal: nothing to resend. */
+  sink_reset_counts ();
+  sink_send (RTM_GETROUTE, pid, sink.last_seq);
+  run (200);
+  check ("incremental resync with no changes",
+         sink.adds == 0 && sink.dels == 0 && sink.dones == 1
+         && sink.done_full == 0);
+
+  /* From before the withdrawal, only a full copy can be right. */
+  sink_reset_counts ();
+  sink_send (RTM_GETROUTE, pid, before_delete);
+  run (500);
+  check ("full resync across a withdrawal",
+         sink.adds == ROUTES - 1 && sink.dels == 0
+         && seen_once (0, ROUTES - 1) && sink.dones == 1
+         && sink.done_full == 1 && sink.frames < ROUTES / 10);
+
+  /* A resync request from another zebra process also gets a full copy. */
+  sink_reset_counts ();
+  sink_send (RTM_GETROUTE, pid + 1, sink.last_seq);
+  run (500);
+  check ("full resync for another pid",
+         sink.adds == ROUTES - 1 && seen_once (0, ROUTES - 1)
+         && sink.dones == 1 && sink.done_full == 1);
+
+  /* Routes per second over the FPM stream, batched and not. */
+  throughput ("full resync throughput with 'fpm batch'", pid, ROUTES - 1);
+  command (CONFIG_NODE, "no fpm batch");
+  throughput ("full resync throughput without 'fpm batch'", pid, ROUTES - 1);
+
+  return failed;
+}
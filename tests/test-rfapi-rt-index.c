@@ -0,0 +1,214 @@
+/*
+ * Test program which measures the cost of selecting the VNC import
+ * tables that an update must be offered to, by scanning every table
+ * and by way of the route-target index, and checks that both select
+ * the same tables.
+ *
+ * This file is part of Quagga
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+
+#include "prefix.h"
+#include "table.h"
+#include "vty.h"
+#include "memory.h"
+#include "hash.h"
+#include "linklist.h"
+#include "skiplist.h"
+#include "workqueue.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_ecommunity.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/rfapi/rfapi.h"
+#include "bgpd/rfapi/rfapi_import.h"
+#include "bgpd/rfapi/rfapi_private.h"
+
+/* need these to link in libbgp */
+struct zebra_privs_t *bgpd_privs = NULL;
+struct thread_master *master = NULL;
+
+#define IMPORT_TABLES   5000
+#define NVE_ROUTES      10000
+#define SHARED_RTS      50
+
+static void
+rt_make (struct ecommunity_val *eval, uint32_t n)
+{
+  memset (eval, 0, sizeof (*eval));
+  eval->val[0] = ECOMMUNITY_ENCODE_AS;
+  eval->val[1] = ECOMMUNITY_ROUTE_TARGET;
+  eval->val[2] = 0xfd;
+  eval->val[3] = 0xe8;
+  eval->val[4] = (n >> 24) & 0xff;
+  eval->val[5] = (n >> 16) & 0xff;
+  eval->val[6] = (n >> 8) & 0xff;
+  eval->val[7] = n & 0xff;
+}
+
+static int
+rt_intersect (struct ecommunity *e1, struct ecommunity *e2)
+{
+  int i, j;
+
+  for (i = 0; i < e1->size; ++i)
+    for (j = 0; j < e2->size; ++j)
+      if (!memcmp (e1->val + (i * ECOMMUNITY_SIZE),
+                   e2->val + (j * ECOMMUNITY_SIZE), ECOMMUNITY_SIZE))
+        return 1;
+  return 0;
+}
+
+/* what rfapiProcessUpdate() effectively did before the index */
+static unsigned int
+linear_match (struct rfapi *h, struct ecommunity *ecom)
+{
+  struct rfapi_import_table *it;
+  unsigned int count = 0;
+
+  for (it = h->imports; it; it = it->next)
+    if (rt_intersect (it->rt_import_list, ecom))
+      ++count;
+  return count;
+}
+
+static unsigned int
+index_match (struct rfapi *h, struct ecommunity *ecom)
+{
+  struct list *matched;
+  unsigned int count;
+
+  matched = rfapiImportTableIndexMatch (h, ecom);
+  if (!matched)
+    return 0;
+  count = listcount (matched);
+  list_delete (matched);
+  return count;
+}
+
+int
+main (int argc, char **argv)
+{
+  struct rfapi *h;
+  struct rfapi_import_table *it;
+  struct ecommunity **routes;
+  struct ecommunity_val eval;
+  struct timeval tv_start, tv_lap, tv_stop;
+  unsigned long t_linear, t_index;
+  unsigned long sum_linear = 0, sum_index = 0;
+  int i;
+
+  h = XCALLOC (MTYPE_RFAPI, sizeof (struct rfapi));
+
+  /*
+   * Each import table imports a private RT and one of SHARED_RTS
+   * RTs shared with the other tables in its group.
+   */
+  for (i = 0; i < IMPORT_TABLES; i++)
+    {
+      it = XCALLOC (MTYPE_RFAPI_IMPORTTABLE,
+                    sizeof (struct rfapi_import_table));
+      it->rt_import_list = ecommunity_new ();
+      rt_make (&eval, i);
+      ecommunity_add_val (it->rt_import_list, &eval);
+      rt_make (&eval, 1000000 + (i % SHARED_RTS));
+      ecommunity_add_val (it->rt_import_list, &eval);
+      it->next = h->imports;
+      h->imports = it;
+      rfapiImportTableIndexAdd (h, it);
+    }
+
+  /*
+   * Each NVE advertises its group's private RT; every tenth one also
+   * carries a shared RT and an RT no table imports.
+   */
+  routes = calloc (NVE_ROUTES, sizeof (*routes));
+  for (i = 0; i < NVE_ROUTES; i++)
+    {
+      routes[i] = ecommunity_new ();
+      rt_make (&eval, i % IMPORT_TABLES);
+      ecommunity_add_val (routes[i], &eval);
+      if (i % 10 == 0)
+        {
+          rt_make (&eval, 1000000 + (i % SHARED_RTS));
+          ecommunity_add_val (routes[i], &eval);
+          rt_make (&eval, 2000000 + i);
+          ecommunity_add_val (routes[i], &eval);
+        }
+    }
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &tv_start);
+
+  for (i = 0; i < NVE_ROUTES; i++)
+    sum_linear += linear_match (h, routes[i]);
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &tv_lap);
+
+  for (i = 0; i < NVE_ROUTES; i++)
+    sum_index += index_match (h, routes[i]);
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &tv_stop);
+
+  t_linear = 1000000 * (tv_lap.tv_sec - tv_start.tv_sec);
+  t_linear += tv_lap.tv_usec - tv_start.tv_usec;
+
+  t_index = 1000000 * (tv_stop.tv_sec - tv_lap.tv_sec);
+  t_index += tv_stop.tv_usec - tv_lap.tv_usec;
+
+  printf ("Matching %d routes against %d import tables (%lu matches):\n",
+          NVE_ROUTES, IMPORT_TABLES, sum_linear);
+  printf ("  scanning all tables took %lu.%06lu seconds.\n",
+          t_linear / 1000000, t_linear % 1000000);
+  printf ("  RT index took %lu.%06lu seconds.\n",
+          t_index / 1000000, t_index % 1000000);
+
+  /* removing every table must leave the index empty */
+  for (it = h->imports; it; it = it->next)
+    rfapiImportTableIndexDel (h, it);
+  if (h->rt_import_index && hashcount (h->rt_import_index))
+    {
+      printf ("%lu RT index entries left after removing all tables\n",
+              hashcount (h->rt_import_index));
+      return 1;
+    }
+  fflush (stdout);
+
+  if (sum_linear != sum_index)
+    {
+      printf ("RT index matched %lu tables, expected %lu\n",
+              sum_index, sum_linear);
+      return 1;
+    }
+
+  for (i = 0; i < NVE_ROUTES; i++)
+    ecommunity_free (&routes[i]);
+  free (routes);
+  while ((it = h->imports))
+    {
+      h->imports = it->next;
+      ecommunity_free (&it->rt_import_list);
+      XFREE (MTYPE_RFAPI_IMPORTTABLE, it);
+    }
+  rfapiImportTableIndexFree (h);
+  XFREE (MTYPE_RFAPI, h);
+  return 0;
+}
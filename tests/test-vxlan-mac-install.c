@@ -0,0 +1,402 @@
+/*
+ * VXLAN remote MAC install benchmark. Feeds zebra's EVPN code
+ * (zebra_vxlan.c) the ZAPI messages bgpd sends for 100k remote MACs
+ * spread over 4k VNIs, and times how long zebra takes to add them to its
+ * tables and program them into the kernel through the netlink FDB code
+ * (rt_netlink.c and kernel_netlink.c).
+ *
+ * The VxLAN interfaces of the VNIs exist only in zebra: the FDB updates
+ * name interfaces the kernel does not have, so it rejects them and no
+ * kernel state is left behind, while zebra still makes every netlink
+ * request and reads every ack.
+ *
+ * This file is part of Quagga
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <zebra.h>
+
+#include "thread.h"
+#include "vty.h"
+#include "buffer.h"
+#include "memory.h"
+#include "privs.h"
+#include "prefix.h"
+#include "stream.h"
+#include "if.h"
+#include "vrf.h"
+#include "log.h"
+#include "qobj.h"
+
+#include "zebra/rib.h"
+#include "zebra/zserv.h"
+#include "zebra/zebra_ns.h"
+#include "zebra/zebra_vrf.h"
+#include "zebra/interface.h"
+#include "zebra/zebra_l2.h"
+#include "zebra/zebra_vxlan.h"
+#include "zebra/rt.h"
+
+#define MACS            100000
+#define VNIS            4000
+#define MACS_PER_VNI    (MACS / VNIS)
+
+/* Interface indexes the kernel does not have. */
+#define NO_IFINDEX      0x7f000000
+
+/* What the rest of zebra would provide. */
+struct zebra_t zebrad;
+struct zebra_privs_t zserv_privs;
+unsigned int multipath_num = MULTIPATH_NUM;
+u_int32_t nl_rcvbufsize = 4194304;
+
+static struct zebra_ns zns;
+static struct zebra_vrf zvrf;
+
+struct zebra_ns *
+zebra_ns_lookup (ns_id_t ns_id)
+{
+  return &zns;
+}
+
+/* No interface is known by its kernel index, so the kernel's FDB and
+ * neighbor notifications are ignored. */
+struct interface *
+if_lookup_by_index_per_ns (struct zebra_ns *ns, u_int32_t ifindex)
+{
+  return NULL;
+}
+
+/* BGP is not connected: nothing is sent back to it. */
+struct zserv *
+zebra_find_client (u_char proto)
+{
+  return NULL;
+}
+
+int
+zebra_server_send_message (struct zserv *client)
+{
+  return 0;
+}
+
+void
+zserv_create_header (struct stream *s, uint16_t cmd, vrf_id_t vrf_id)
+{
+}
+
+/* The kernel's notifications are not read, and the flood list of a
+ * VNI's remote VTEPs is not part of what is measured. */
+int
+netlink_interface_addr (struct sockaddr_nl *snl, struct nlmsghdr *h,
+                        ns_id_t ns_id, int startup)
+{
+  return 0;
+}
+
+int
+netlink_link_change (struct sockaddr_nl *snl, struct nlmsghdr *h,
+                     ns_id_t ns_id, int startup)
+{
+  return 0;
+}
+
+int
+netlink_vxlan_flood_list_update (struct interface *ifp, struct prefix *vtep,
+                                 int cmd)
+{
+  return 0;
+}
+
+/* Nor are kernel routes, which would go to the RIB. */
+int
+is_zebra_valid_kernel_table (u_int32_t table_id)
+{
+  return 0;
+}
+
+int
+is_zebra_main_routing_table (u_int32_t table_id)
+{
+  return 0;
+}
+
+int
+rib_add (afi_t afi, safi_t safi, vrf_id_t vrf_id, int type, u_short instance,
+         int flags, struct prefix *p, union g_addr *gate, union g_addr *src,
+         ifindex_t ifindex, u_int32_t table_id, u_int32_t metric,
+         u_int32_t mtu, u_char distance)
+{
+  return 0;
+}
+
+int
+rib_add_multipath (afi_t afi, safi_t safi, struct prefix *p, struct rib *rib)
+{
+  return 0;
+}
+
+int
+rib_delete (afi_t afi, safi_t safi, vrf_id_t vrf_id, int type,
+            u_short instance, int flags, struct prefix *p, union g_addr *gate,
+            ifindex_t ifindex, u_int32_t table_id)
+{
+  return 0;
+}
+
+struct nexthop *
+rib_nexthop_ifindex_add (struct rib *rib, ifindex_t ifindex)
+{
+  return NULL;
+}
+
+struct nexthop *
+rib_nexthop_ipv4_add (struct rib *rib, struct in_addr *ipv4,
+                      struct in_addr *src)
+{
+  return NULL;
+}
+
+struct nexthop *
+rib_nexthop_ipv4_ifindex_add (struct rib *rib, struct in_addr *ipv4,
+                              struct in_addr *src, ifindex_t ifindex)
+{
+  return NULL;
+}
+
+struct nexthop *
+rib_nexthop_ipv6_add (struct rib *rib, struct in6_addr *ipv6)
+{
+  return NULL;
+}
+
+struct nexthop *
+rib_nexthop_ipv6_ifindex_add (struct rib *rib, struct in6_addr *ipv6,
+                              ifindex_t ifindex)
+{
+  return NULL;
+}
+
+void
+zserv_nexthop_num_warn (const char *caller, const struct prefix *p,
+                        const unsigned int nexthop_num)
+{
+}
+
+/* There are no local MACs or neighbors to read. */
+void
+macfdb_read (struct zebra_ns *zns)
+{
+}
+
+void
+macfdb_read_for_bridge (struct zebra_ns *zns, struct interface *ifp,
+                        struct interface *br_if)
+{
+}
+
+void
+neigh_read (struct zebra_ns *zns)
+{
+}
+
+void
+neigh_read_for_vlan (struct zebra_ns *zns, struct interface *vlan_if)
+{
+}
+
+static int
+privs_change (zebra_privs_ops_t op)
+{
+  return 0;
+}
+
+/* A bridge, and a VxLAN interface in it for each VNI, as zebra would
+ * have learnt them from the kernel. */
+static void
+interfaces_setup (struct in_addr local_vtep)
+{
+  struct interface *br, *ifp;
+  struct zebra_if *zif;
+  struct zebra_l2if_vxlan *vxl;
+  char name[INTERFACE_NAMSIZ];
+  int i;
+
+  br = if_get_by_name ("br0");
+  br->ifindex = NO_IFINDEX - 1;
+  br->flags = IFF_UP | IFF_RUNNING;
+  zif = XCALLOC (MTYPE_TMP, sizeof (struct zebra_if));
+  zif->zif_type = ZEBRA_IF_BRIDGE;
+  zif->l2if = XCALLOC (MTYPE_TMP, sizeof (struct zebra_l2if_bridge));
+  br->info = zif;
+
+  for (i = 0; i < VNIS; i++)
+    {
+      snprintf (name, sizeof (name), "vxlan%d", i + 1);
+      ifp = if_get_by_name (name);
+      ifp->ifindex = NO_IFINDEX + i;
+      ifp->flags = IFF_UP | IFF_RUNNING;
+
+      vxl = XCALLOC (MTYPE_TMP, sizeof (struct zebra_l2if_vxlan));
+      vxl->vni = i + 1;
+      vxl->vtep_ip = local_vtep;
+      vxl->br_slave.bridge_ifindex = br->ifindex;
+      vxl->br_slave.br_if = br;
+
+      zif = XCALLOC (MTYPE_TMP, sizeof (struct zebra_if));
+      zif->zif_type = ZEBRA_IF_VXLAN;
+      zif->l2if = vxl;
+      ifp->info = zif;
+    }
+}
+
+/* A ZAPI message from BGP, whose body the caller has written to the
+ * client's input stream. */
+typedef int (*zapi_handler) (struct zserv *, int, u_short,
+                             struct zebra_vrf *);
+
+static void
+deliver (zapi_handler handler, struct zserv *client)
+{
+  handler (client, -1, stream_get_endp (client->ibuf), &zvrf);
+  stream_reset (client->ibuf);
+}
+
+static void
+mac_make (struct ethaddr *mac, int n)
+{
+  mac->octet[0] = 0x02;
+  mac->octet[1] = 0x00;
+  mac->octet[2] = 0x5e;
+  mac->octet[3] = n >> 16;
+  mac->octet[4] = n >> 8;
+  mac->octet[5] = n;
+}
+
+/* Remote MACs known for a VNI, from 'show evpn vni'. */
+static unsigned int
+vni_macs (struct vty *vty, vni_t vni)
+{
+  const char *tag = "Number of MACs (local and remote) known for this VNI: ";
+  unsigned int count = 0;
+  char *out, *p;
+
+  buffer_reset (vty->obuf);
+  zebra_vxlan_print_vni (vty, &zvrf, vni);
+  out = buffer_getstr (vty->obuf);
+  if ((p = strstr (out, tag)) != NULL)
+    count = strtoul (p + strlen (tag), NULL, 10);
+  XFREE (MTYPE_TMP, out);
+  return count;
+}
+
+int
+main (void)
+{
+  struct zserv client;
+  struct stream *s;
+  struct in_addr local_vtep, remote_vtep;
+  struct ethaddr mac;
+  struct timeval start, stop;
+  struct vty *vty;
+  long msecs;
+  vni_t vni;
+  int i, n;
+
+  zserv_privs.change = privs_change;
+  zebrad.master = thread_master_create ();
+
+  /* The kernel rejects every request: don't log each batch of them. */
+  zlog_default = openzlog ("test-vxlan-mac-install", ZLOG_ZEBRA, 0,
+                           LOG_CONS | LOG_NDELAY | LOG_PID, LOG_DAEMON);
+  zlog_set_level (NULL, ZLOG_DEST_SYSLOG, ZLOG_DISABLED);
+
+  qobj_init ();
+  vrf_init ();
+  vty = vty_new ();
+  vty->type = VTY_TERM;
+
+  zns.ns_id = NS_DEFAULT;
+  zns.netlink.sock = -1;
+  zns.netlink.name = XSTRDUP (MTYPE_TMP, "netlink-listen");
+  zns.netlink_cmd.sock = -1;
+  zns.netlink_cmd.name = XSTRDUP (MTYPE_TMP, "netlink-cmd");
+  kernel_init (&zns);
+
+  zvrf.vrf_id = VRF_DEFAULT;
+  zvrf.zns = &zns;
+  zebra_vxlan_init_tables (&zvrf);
+
+  inet_aton ("192.0.2.1", &local_vtep);
+  inet_aton ("192.0.2.2", &remote_vtep);
+  interfaces_setup (local_vtep);
+
+  memset (&client, 0, sizeof (client));
+  client.proto = ZEBRA_ROUTE_BGP;
+  client.ibuf = s = stream_new (ZEBRA_MAX_PACKET_SIZ);
+
+  /* BGP turns EVPN on, which creates the VNIs, and learns the remote
+   * VTEP of each VNI from its type-3 route. */
+  stream_putc (s, 1);
+  deliver (zebra_vxlan_advertise_all_vni, &client);
+
+  for (vni = 1; vni <= VNIS; vni++)
+    {
+      stream_putl (s, vni);
+      stream_putc (s, 0);
+      stream_putw (s, AF_INET);
+      stream_putc (s, IPV4_MAX_BITLEN);
+      stream_put_in_addr (s, &remote_vtep);
+      deliver (zebra_vxlan_remote_vtep_add, &client);
+    }
+
+  /* Then the MACs behind it, one message per VNI as bgpd batches them. */
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (vni = 1, n = 0; vni <= VNIS; vni++)
+    {
+      for (i = 0; i < MACS_PER_VNI; i++, n++)
+        {
+          mac_make (&mac, n);
+          stream_putl (s, vni);
+          stream_put (s, &mac.octet, ETHER_ADDR_LEN);
+          stream_putl (s, 0);
+          stream_put_in_addr (s, &remote_vtep);
+        }
+      deliver (zebra_vxlan_remote_macip_add, &client);
+    }
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &stop);
+
+  msecs = 1000 * (stop.tv_sec - start.tv_sec);
+  msecs += (stop.tv_usec - start.tv_usec) / 1000;
+
+  printf ("Installing %d remote MACs in %d VNIs took %ld.%03ld seconds",
+          MACS, VNIS, msecs / 1000, msecs % 1000);
+  if (msecs)
+    printf (", %ld MACs per second", MACS * 1000L / msecs);
+  printf (".\n");
+
+  /* Every MAC made it into zebra's tables. */
+  for (vni = 1; vni <= VNIS; vni++)
+    if (vni_macs (vty, vni) != MACS_PER_VNI)
+      {
+        printf ("VNI %u has %u MACs, not %d\n", vni, vni_macs (vty, vni),
+                MACS_PER_VNI);
+        return 1;
+      }
+
+  return 0;
+}
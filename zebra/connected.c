@@ -214,7 +214,7 @@ connected_up_ipv4 (struct interface *ifp, struct connected *ifc)
   if (IS_ZEBRA_DEBUG_RIB_DETAILED)
     zlog_debug ("%u: IF %s IPv4 address add/up, scheduling RIB processing",
                 ifp->vrf_id, ifp->name);
-  rib_update (ifp->vrf_id, RIB_UPDATE_IF_CHANGE);
+  rib_update_interface (ifp);
 
   /* Schedule LSP forwarding entries for processing, if appropriate. */
   if (ifp->vrf_id == VRF_DEFAULT)
@@ -343,7 +343,7 @@ connected_down_ipv4 (struct interface *ifp, struct connected *ifc)
     zlog_debug ("%u: IF %s IPv4 address down, scheduling RIB processing",
                 ifp->vrf_id, ifp->name);
 
-  rib_update (ifp->vrf_id, RIB_UPDATE_IF_CHANGE);
+  rib_update_interface (ifp);
 
   /* Schedule LSP forwarding entries for processing, if appropriate. */
   if (ifp->vrf_id == VRF_DEFAULT)
@@ -378,7 +378,7 @@ connected_delete_ipv4 (struct interface *ifp, int flags, struct in_addr *addr,
     zlog_debug ("%u: IF %s IPv4 address del, scheduling RIB processing",
                 ifp->vrf_id, ifp->name);
 
-  rib_update (ifp->vrf_id, RIB_UPDATE_IF_CHANGE);
+  rib_update_interface (ifp);
 
   /* Schedule LSP forwarding entries for processing, if appropriate. */
   if (ifp->vrf_id == VRF_DEFAULT)
@@ -417,7 +417,7 @@ connected_up_ipv6 (struct interface *ifp, struct connected *ifc)
     zlog_debug ("%u: IF %s IPv6 address down, scheduling RIB processing",
                 ifp->vrf_id, ifp->name);
 
-  rib_update (ifp->vrf_id, RIB_UPDATE_IF_CHANGE);
+  rib_update_interface (ifp);
 
   /* Schedule LSP forwarding entries for processing, if appropriate. */
   if (ifp->vrf_id == VRF_DEFAULT)
@@ -516,7 +516,7 @@ connected_down_ipv6 (struct interface *ifp, struct connected *ifc)
     zlog_debug ("%u: IF %s IPv6 address down, scheduling RIB processing",
                 ifp->vrf_id, ifp->name);
 
-  rib_update (ifp->vrf_id, RIB_UPDATE_IF_CHANGE);
+  rib_update_interface (ifp);
 
   /* Schedule LSP forwarding entries for processing, if appropriate. */
   if (ifp->vrf_id == VRF_DEFAULT)
@@ -550,7 +550,7 @@ connected_delete_ipv6 (struct interface *ifp, struct in6_addr *address,
     zlog_debug ("%u: IF %s IPv6 address del, scheduling RIB processing",
                 ifp->vrf_id, ifp->name);
 
-  rib_update (ifp->vrf_id, RIB_UPDATE_IF_CHANGE);
+  rib_update_interface (ifp);
 
   /* Schedule LSP forwarding entries for processing, if appropriate. */
   if (ifp->vrf_id == VRF_DEFAULT)
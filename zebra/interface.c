@@ -134,6 +134,8 @@ if_zebra_delete_hook (struct interface *ifp)
       if (zebra_if->l2if)
         XFREE (MTYPE_ZEBRA_L2IF, zebra_if->l2if);
 
+      THREAD_TIMER_OFF (zebra_if->t_update);
+
       XFREE (MTYPE_TMP, zebra_if);
     }
 
@@ -834,7 +836,7 @@ if_up (struct interface *ifp)
   if (IS_ZEBRA_DEBUG_RIB_DETAILED)
     zlog_debug ("%u: IF %s up, scheduling RIB processing",
                 ifp->vrf_id, ifp->name);
-  rib_update (ifp->vrf_id, RIB_UPDATE_IF_CHANGE);
+  rib_update_interface (ifp);
 
   zebra_vrf_static_route_interface_fixup (ifp);
 
@@ -867,7 +869,7 @@ if_down (struct interface *ifp)
   if (IS_ZEBRA_DEBUG_RIB_DETAILED)
     zlog_debug ("%u: IF %s down, scheduling RIB processing",
                 ifp->vrf_id, ifp->name);
-  rib_update (ifp->vrf_id, RIB_UPDATE_IF_CHANGE);
+  rib_update_interface (ifp);
 
   if_nbr_ipv6ll_to_ipv4ll_neigh_del_all (ifp);
 
@@ -228,6 +228,10 @@ struct zebra_if
   unsigned int down_count;
   char down_last[QUAGGA_TIMESTAMP_LEN];
 
+  /* Up/down notification held back from clients by the delay-timer */
+  int update_pending;
+  struct thread *t_update;
+
 #if defined(HAVE_RTADV)
   struct rtadvconf rtadv;
   unsigned int ra_sent, ra_rcvd;
@@ -457,22 +457,15 @@ nl_rttype_to_str (u_char rttype)
 }
 
 /*
- * netlink_parse_info
+ * netlink_parse_buf
  *
- * Receive message from netlink interface and pass those information
- *  to the given function.
- *
- * filter  -> Function to call to read the results
- * nl      -> netlink socket information
- * zns     -> The zebra namespace data
- * count   -> How many we should read in, 0 means as much as possible
- * startup -> Are we reading in under startup conditions? passed to
- *            the filter.
+ * Body of netlink_parse_info, reading into the given buffer.
  */
-int
-netlink_parse_info (int (*filter) (struct sockaddr_nl *, struct nlmsghdr *,
-                                   ns_id_t, int),
-                    struct nlsock *nl, struct zebra_ns *zns, int count, int startup)
+static int
+netlink_parse_buf (int (*filter) (struct sockaddr_nl *, struct nlmsghdr *,
+                                  ns_id_t, int),
+                   struct nlsock *nl, struct zebra_ns *zns, int count,
+                   int startup, char *buf, size_t buf_size)
 {
   int status;
   int ret = 0;
@@ -481,10 +474,9 @@ netlink_parse_info (int (*filter) (struct sockaddr_nl *, struct nlmsghdr *,
 
   while (1)
     {
-      char buf[NL_PKT_BUF_SIZE];
       struct iovec iov = {
         .iov_base = buf,
-        .iov_len = sizeof buf
+        .iov_len = buf_size
       };
       struct sockaddr_nl snl;
       struct msghdr msg = {
@@ -536,6 +528,12 @@ netlink_parse_info (int (*filter) (struct sockaddr_nl *, struct nlmsghdr *,
         }
 
       read_in++;
+      if (startup)
+        {
+          zebrad.startup_dump_reads++;
+          zebrad.startup_dump_bytes += status;
+        }
+
       for (h = (struct nlmsghdr *) buf; NLMSG_OK (h, (unsigned int) status);
            h = NLMSG_NEXT (h, status))
         {
@@ -660,6 +658,43 @@ netlink_parse_info (int (*filter) (struct sockaddr_nl *, struct nlmsghdr *,
   return ret;
 }
 
+/*
+ * netlink_parse_info
+ *
+ * Receive message from netlink interface and pass those information
+ *  to the given function.
+ *
+ * filter  -> Function to call to read the results
+ * nl      -> netlink socket information
+ * zns     -> The zebra namespace data
+ * count   -> How many we should read in, 0 means as much as possible
+ * startup -> Are we reading in under startup conditions? passed to
+ *            the filter.
+ *
+ * Startup reads are table dumps, which are read with a buffer large
+ * enough for the kernel to pack as many messages into each read as it
+ * will.
+ */
+int
+netlink_parse_info (int (*filter) (struct sockaddr_nl *, struct nlmsghdr *,
+                                   ns_id_t, int),
+                    struct nlsock *nl, struct zebra_ns *zns, int count, int startup)
+{
+  char buf[NL_PKT_BUF_SIZE];
+  char *dump_buf;
+  int ret;
+
+  if (!startup)
+    return netlink_parse_buf (filter, nl, zns, count, startup,
+                              buf, sizeof buf);
+
+  dump_buf = XMALLOC (MTYPE_TMP, NL_DUMP_BUF_SIZE);
+  ret = netlink_parse_buf (filter, nl, zns, count, startup,
+                           dump_buf, NL_DUMP_BUF_SIZE);
+  XFREE (MTYPE_TMP, dump_buf);
+  return ret;
+}
+
 /*
  * netlink_talk
  *
@@ -736,6 +771,180 @@ netlink_talk (int (*filter) (struct sockaddr_nl *, struct nlmsghdr *,
   return netlink_parse_info (filter, nl, zns, 0, startup);
 }
 
+/*
+ * Requests queued for the command socket while a batch is open. They
+ * go to the kernel in a single sendmsg() when the batch is closed or
+ * full, and their acks are collected afterwards, so a walk installing
+ * many FDB or neighbor entries does not wait for the kernel once per
+ * entry. The batch is bounded by message count as well as size: every
+ * request is answered by its own ack, and all of those must fit in the
+ * command socket's receive buffer at once.
+ */
+static struct
+{
+  int depth;
+  int failed;                   /* A flush before the end failed. */
+  struct nlsock *nl;
+  struct zebra_ns *zns;
+  unsigned int count;
+  size_t len;
+  char buf[NL_BATCH_BUF_SIZE];
+} nl_batch;
+
+/*
+ * netlink_batch_flush
+ *
+ * Send the queued requests and read back one ack or error for each.
+ * The error for a rejected request is logged along with its type and
+ * sequence number as its ack is read.
+ */
+static int
+netlink_batch_flush (void)
+{
+  struct sockaddr_nl snl;
+  struct iovec iov = {
+    .iov_base = (void *) nl_batch.buf,
+    .iov_len = nl_batch.len
+  };
+  struct msghdr msg = {
+    .msg_name = (void *) &snl,
+    .msg_namelen = sizeof snl,
+    .msg_iov = &iov,
+    .msg_iovlen = 1,
+  };
+  unsigned int count = nl_batch.count;
+  unsigned int i, failed = 0;
+  int status;
+  int save_errno;
+
+  if (!count)
+    return 0;
+
+  nl_batch.count = 0;
+  nl_batch.len = 0;
+
+  memset (&snl, 0, sizeof snl);
+  snl.nl_family = AF_NETLINK;
+
+  if (IS_ZEBRA_DEBUG_KERNEL)
+    zlog_debug ("netlink_batch_flush: %s %u messages, len=%zu",
+                nl_batch.nl->name, count, iov.iov_len);
+
+  if (zserv_privs.change (ZPRIVS_RAISE))
+    zlog (NULL, LOG_ERR, "Can't raise privileges");
+  status = sendmsg (nl_batch.nl->sock, &msg, 0);
+  save_errno = errno;
+  if (zserv_privs.change (ZPRIVS_LOWER))
+    zlog (NULL, LOG_ERR, "Can't lower privileges");
+
+  if (status < 0)
+    {
+      zlog (NULL, LOG_ERR,
+            "netlink_batch_flush sendmsg() error: %s, %u requests lost",
+            safe_strerror (save_errno), count);
+      return -1;
+    }
+
+  /* The kernel has handled every request by the time sendmsg()
+   * returns; each ack or error arrives in a read of its own. */
+  for (i = 0; i < count; i++)
+    if (netlink_parse_info (netlink_talk_filter, nl_batch.nl,
+                            nl_batch.zns, 0, 0) < 0)
+      failed++;
+
+  if (failed)
+    {
+      zlog (NULL, LOG_ERR,
+            "netlink_batch_flush: %s rejected %u of %u requests",
+            nl_batch.nl->name, failed, count);
+      return -1;
+    }
+
+  return 0;
+}
+
+/*
+ * netlink_batch_begin
+ *
+ * Open a batch. Batches nest, requests are sent when the outermost
+ * one is closed.
+ */
+void
+netlink_batch_begin (void)
+{
+  nl_batch.depth++;
+}
+
+/*
+ * netlink_batch_end
+ *
+ * Close a batch, sending the queued requests if it is the outermost.
+ * Returns -1 if the kernel rejected any request queued in the batch,
+ * including those sent early because the batch was full.
+ */
+int
+netlink_batch_end (void)
+{
+  int ret;
+
+  assert (nl_batch.depth > 0);
+
+  if (--nl_batch.depth)
+    return 0;
+
+  ret = netlink_batch_flush ();
+  if (nl_batch.failed)
+    ret = -1;
+  nl_batch.failed = 0;
+  return ret;
+}
+
+/*
+ * netlink_batch_talk
+ *
+ * Like netlink_talk with netlink_talk_filter, except that the request
+ * is only queued while a batch is open, and 0 returned. Errors for
+ * queued requests are logged when they are sent, and reported by
+ * netlink_batch_end().
+ */
+int
+netlink_batch_talk (struct nlmsghdr *n, struct nlsock *nl,
+                    struct zebra_ns *zns)
+{
+  size_t len = NLMSG_ALIGN (n->nlmsg_len);
+
+  if (!nl_batch.depth)
+    return netlink_talk (netlink_talk_filter, n, nl, zns, 0);
+
+  /* The requests already queued fail or succeed on their own; this one
+   * is only queued. */
+  if (nl_batch.count
+      && (nl_batch.nl != nl
+          || nl_batch.count >= NL_BATCH_MAX_MSGS
+          || nl_batch.len + len > sizeof (nl_batch.buf))
+      && netlink_batch_flush () < 0)
+    nl_batch.failed = 1;
+
+  nl_batch.nl = nl;
+  nl_batch.zns = zns;
+
+  n->nlmsg_seq = ++nl->seq;
+  n->nlmsg_pid = nl->snl.nl_pid;
+  n->nlmsg_flags |= NLM_F_ACK;
+
+  if (IS_ZEBRA_DEBUG_KERNEL)
+    zlog_debug ("netlink_batch_talk: %s type %s(%u), len=%d seq=%u flags 0x%x",
+               nl->name,
+               lookup (nlmsg_str, n->nlmsg_type), n->nlmsg_type,
+               n->nlmsg_len, n->nlmsg_seq, n->nlmsg_flags);
+
+  memcpy (nl_batch.buf + nl_batch.len, n, n->nlmsg_len);
+  nl_batch.len += len;
+  nl_batch.count++;
+
+  return 0;
+}
+
 /* Get type specified information from netlink. */
 int
 netlink_request (int family, int type, struct nlsock *nl,
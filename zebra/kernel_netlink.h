@@ -26,6 +26,15 @@
 
 #define NL_PKT_BUF_SIZE         8192
 
+/* Receive buffer for table dumps; the kernel sizes each dump read to the
+ * buffer the reader last offered, up to 32k. */
+#define NL_DUMP_BUF_SIZE        32768
+
+/* Limits of a batch of requests sent with one sendmsg(); the count
+ * bounds the acks queued on the command socket at once. */
+#define NL_BATCH_BUF_SIZE       16384
+#define NL_BATCH_MAX_MSGS       64
+
 extern void netlink_parse_rtattr (struct rtattr **tb, int max,
                                   struct rtattr *rta, int len);
 extern int addattr_l (struct nlmsghdr *n, unsigned int maxlen,
@@ -54,6 +63,10 @@ extern int netlink_talk (int (*filter) (struct sockaddr_nl *, struct nlmsghdr *,
                                         ns_id_t, int startup),
                          struct nlmsghdr *n, struct nlsock *nl,
                          struct zebra_ns *zns, int startup);
+extern void netlink_batch_begin (void);
+extern int netlink_batch_end (void);
+extern int netlink_batch_talk (struct nlmsghdr *n, struct nlsock *nl,
+                               struct zebra_ns *zns);
 extern int netlink_request (int family, int type, struct nlsock *nl,
                             u_int32_t filter_mask);
 
@@ -94,3 +94,6 @@ int kernel_del_neigh (struct interface *ifp, struct ipaddr *ip)
 {
   return 0;
 }
+
+void kernel_batch_begin (void) { return; }
+int kernel_batch_end (void) { return 0; }
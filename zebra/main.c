@@ -242,6 +242,7 @@ main (int argc, char **argv)
   char *config_file = NULL;
   char *progname;
   struct thread thread;
+  struct timeval start;
   char *zserv_path = NULL;
   char *fpm_format = NULL;
 
@@ -406,7 +407,9 @@ main (int argc, char **argv)
   *  The notifications from kernel will show originating PID equal
   *  to that after daemon() completes (if ever called).
   */
+  zebra_startup_phase_begin (&start);
   vty_read_config (config_file, config_default);
+  zebra_startup_phase_end (ZEBRA_STARTUP_CONFIG, &start);
 
   /* Don't start execution if we are in dry-run mode */
   if (dryrun)
@@ -438,7 +441,11 @@ main (int argc, char **argv)
   * we have to have route_read() called before.
   */
   if (! keep_kernel_mode)
-    rib_sweep_route ();
+    {
+      zebra_startup_phase_begin (&start);
+      rib_sweep_route ();
+      zebra_startup_phase_end (ZEBRA_STARTUP_SWEEP, &start);
+    }
 
   /* Needed for BSD routing socket. */
   pid = getpid ();
@@ -452,6 +459,14 @@ main (int argc, char **argv)
   /* Print banner. */
   zlog_notice ("Zebra %s starting: vty@%d", QUAGGA_VERSION, vty_port);
 
+  /* Time the processing of the routes queued so far. It ends when the
+   * RIB work queue completes, or right away if nothing was queued. */
+  zebra_startup_phase_begin (&zebrad.startup_rib_begin);
+  if (zebrad.mq->size)
+    zebrad.startup_rib_pending = 1;
+  else
+    zebra_startup_phase_end (ZEBRA_STARTUP_RIB, &zebrad.startup_rib_begin);
+
   while (thread_fetch (zebrad.master, &thread))
     thread_call (&thread);
 
@@ -41,3 +41,9 @@ zfpm_trigger_update (struct route_node *rn, const char *reason)
 {
   return;
 }
+
+void
+zfpm_dest_deleted (struct route_node *rn)
+{
+  return;
+}
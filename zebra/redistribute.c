@@ -31,6 +31,8 @@
 #include "linklist.h"
 #include "log.h"
 #include "vrf.h"
+#include "buffer.h"
+#include "thread.h"
 
 #include "zebra/rib.h"
 #include "zebra/zserv.h"
@@ -41,6 +43,7 @@
 #include "zebra/debug.h"
 #include "zebra/router-id.h"
 #include "zebra/zebra_memory.h"
+#include "zebra/interface.h"
 
 #define ZEBRA_PTM_SUPPORT
 
@@ -49,6 +52,9 @@
 static int zebra_import_table_used[AFI_MAX][ZEBRA_KERNEL_TABLE_MAX];
 static u_int32_t zebra_import_table_distance[AFI_MAX][ZEBRA_KERNEL_TABLE_MAX];
 
+/* Window, in msec, over which interface up/down notifications are held */
+static u_int32_t zebra_if_update_timer = ZEBRA_IF_DEFAULT_UPDATE_TIMER;
+
 int
 is_zebra_import_table_enabled(afi_t afi, u_int32_t table_id)
 {
@@ -106,40 +112,196 @@ zebra_redistribute_default (struct zserv *client, vrf_id_t vrf_id)
     }
 }
 
+/*
+ * Redistribution snapshots: the routes a client is sent when it asks
+ * for a route type, walked over a table slice by slice so that a large
+ * table neither stalls zebra nor floods a client that is slow to read.
+ */
+DEFINE_MTYPE_STATIC(ZEBRA, REDIST_SNAPSHOT, "Redistribution snapshot")
+
+/* Most routes sent to a client in one slice. */
+#define ZEBRA_REDIST_SNAPSHOT_ROUTES    1000
+
+struct redist_snapshot
+{
+  int type;
+  u_short instance;
+  vrf_id_t vrf_id;
+  afi_t afi;
+
+  /* Where the walk over the table is. */
+  route_table_iter_t iter;
+};
+
+static int zebra_redistribute_snapshot_cb (struct thread *);
+
+/* Send the routes of a node that the snapshot asks for. */
+static unsigned int
+zebra_redistribute_node (struct zserv *client, struct redist_snapshot *snap,
+                         struct route_node *rn)
+{
+  struct rib *newrib;
+  unsigned int sent = 0;
+
+  RNODE_FOREACH_RIB (rn, newrib)
+    {
+      if (IS_ZEBRA_DEBUG_EVENT)
+        zlog_debug("%s: checking: selected=%d, type=%d, distance=%d, "
+                   "zebra_check_addr=%d", __func__,
+                   CHECK_FLAG (newrib->flags, ZEBRA_FLAG_SELECTED),
+                   newrib->type, newrib->distance,
+                   zebra_check_addr (&rn->p));
+
+      if (! CHECK_FLAG (newrib->flags, ZEBRA_FLAG_SELECTED))
+        continue;
+      if ((snap->type != ZEBRA_ROUTE_ALL &&
+           (newrib->type != snap->type || newrib->instance != snap->instance)))
+        continue;
+      if (newrib->distance == DISTANCE_INFINITY)
+        continue;
+      if (! zebra_check_addr (&rn->p))
+        continue;
+
+      zsend_redistribute_route (1, client, &rn->p, newrib);
+      sent++;
+    }
+
+  return sent;
+}
+
+/* Does the client still want the routes of the snapshot? */
+static int
+zebra_redistribute_wanted (struct zserv *client, struct redist_snapshot *snap)
+{
+  if (snap->instance)
+    return redist_check_instance (&client->mi_redist[snap->afi][snap->type],
+                                  snap->instance) != NULL;
+  return vrf_bitmap_check (client->redist[snap->afi][snap->type],
+                           snap->vrf_id);
+}
+
+static void
+zebra_redistribute_snapshot_done (struct zserv *client,
+                                  struct redist_snapshot *snap)
+{
+  route_table_iter_cleanup (&snap->iter);
+  listnode_delete (client->redist_snapshots, snap);
+  XFREE (MTYPE_REDIST_SNAPSHOT, snap);
+}
+
+/* Send the next slice of the client's snapshots. */
+static int
+zebra_redistribute_snapshot_cb (struct thread *thread)
+{
+  struct zserv *client = THREAD_ARG (thread);
+  struct redist_snapshot *snap;
+  struct route_table *table;
+  struct route_node *rn;
+  unsigned int sent = 0;
+
+  client->t_redist = NULL;
+
+  /* Wait for the client to read what it was sent so far. */
+  if (! buffer_empty (client->wb))
+    return 0;
+
+  client->corked = 1;
+
+  while ((snap = listnode_head (client->redist_snapshots)))
+    {
+      table = zebra_vrf_table (snap->afi, SAFI_UNICAST, snap->vrf_id);
+      if (! table || ! zebra_redistribute_wanted (client, snap))
+        {
+          zebra_redistribute_snapshot_done (client, snap);
+          continue;
+        }
+
+      /* The table may have been replaced since the walk paused; a paused
+       * walk only remembers the prefix it stopped at. */
+      snap->iter.table = table;
+
+      while ((rn = route_table_iter_next (&snap->iter)))
+        {
+          sent += zebra_redistribute_node (client, snap, rn);
+          if (sent >= ZEBRA_REDIST_SNAPSHOT_ROUTES
+              || thread_should_yield (thread))
+            break;
+        }
+
+      if (! rn)
+        {
+          zebra_redistribute_snapshot_done (client, snap);
+          continue;
+        }
+
+      route_table_iter_pause (&snap->iter);
+      break;
+    }
+
+  zebra_server_uncork (client);
+
+  if (listcount (client->redist_snapshots))
+    zebra_redistribute_resume (client);
+
+  return 0;
+}
+
+/* Schedule the next slice of the client's snapshots, unless what was
+ * already sent is still waiting to be written to the client, in which
+ * case this is called again once it has been. */
+void
+zebra_redistribute_resume (struct zserv *client)
+{
+  if (! client->redist_snapshots || ! listcount (client->redist_snapshots))
+    return;
+  if (client->t_redist || client->t_suicide || ! buffer_empty (client->wb))
+    return;
+
+  client->t_redist = thread_add_background (zebrad.master,
+                                            zebra_redistribute_snapshot_cb,
+                                            client, 0);
+}
+
+/* Drop the client's snapshots. */
+void
+zebra_redistribute_snapshot_free (struct zserv *client)
+{
+  struct redist_snapshot *snap;
+
+  THREAD_OFF (client->t_redist);
+
+  if (! client->redist_snapshots)
+    return;
+
+  while ((snap = listnode_head (client->redist_snapshots)))
+    zebra_redistribute_snapshot_done (client, snap);
+  list_free (client->redist_snapshots);
+  client->redist_snapshots = NULL;
+}
+
 /* Redistribute routes. */
 static void
 zebra_redistribute (struct zserv *client, int type, u_short instance, vrf_id_t vrf_id, int afi)
 {
-  struct rib *newrib;
+  struct redist_snapshot *snap;
   struct route_table *table;
-  struct route_node *rn;
 
   table = zebra_vrf_table (afi, SAFI_UNICAST, vrf_id);
   if (! table)
     return;
 
-  for (rn = route_top (table); rn; rn = route_next (rn))
-    RNODE_FOREACH_RIB (rn, newrib)
-      {
-        if (IS_ZEBRA_DEBUG_EVENT)
-          zlog_debug("%s: checking: selected=%d, type=%d, distance=%d, "
-                     "zebra_check_addr=%d", __func__,
-                     CHECK_FLAG (newrib->flags, ZEBRA_FLAG_SELECTED),
-                     newrib->type, newrib->distance,
-                     zebra_check_addr (&rn->p));
-
-        if (! CHECK_FLAG (newrib->flags, ZEBRA_FLAG_SELECTED))
-          continue;
-        if ((type != ZEBRA_ROUTE_ALL &&
-             (newrib->type != type || newrib->instance != instance)))
-          continue;
-        if (newrib->distance == DISTANCE_INFINITY)
-          continue;
-        if (! zebra_check_addr (&rn->p))
-          continue;
+  snap = XCALLOC (MTYPE_REDIST_SNAPSHOT, sizeof (struct redist_snapshot));
+  snap->type = type;
+  snap->instance = instance;
+  snap->vrf_id = vrf_id;
+  snap->afi = afi;
+  route_table_iter_init (&snap->iter, table);
 
-        zsend_redistribute_route (1, client, &rn->p, newrib);
-      }
+  if (! client->redist_snapshots)
+    client->redist_snapshots = list_new ();
+  listnode_add (client->redist_snapshots, snap);
+
+  zebra_redistribute_resume (client);
 }
 
 /* Either advertise a route for redistribution to registered clients or */
@@ -310,9 +472,9 @@ zebra_redistribute_default_delete (int command, struct zserv *client,
   vrf_bitmap_unset (client->redist_default, zvrf->vrf_id);
 }     
 
-/* Interface up information. */
-void
-zebra_interface_up_update (struct interface *ifp)
+/* Send interface up information to the clients. */
+static void
+zebra_interface_up_send (struct interface *ifp)
 {
   struct listnode *node, *nnode;
   struct zserv *client;
@@ -330,9 +492,9 @@ zebra_interface_up_update (struct interface *ifp)
   }
 }
 
-/* Interface down information. */
-void
-zebra_interface_down_update (struct interface *ifp)
+/* Send interface down information to the clients. */
+static void
+zebra_interface_down_send (struct interface *ifp)
 {
   struct listnode *node, *nnode;
   struct zserv *client;
@@ -346,6 +508,94 @@ zebra_interface_down_update (struct interface *ifp)
     }
 }
 
+/* Send the up/down notification held for an interface, if any. */
+static void
+zebra_interface_update_flush (struct interface *ifp)
+{
+  struct zebra_if *zif = ifp->info;
+  int cmd;
+
+  if (!zif || !zif->update_pending)
+    return;
+
+  cmd = zif->update_pending;
+  zif->update_pending = 0;
+  THREAD_TIMER_OFF (zif->t_update);
+
+  if (cmd == ZEBRA_INTERFACE_UP)
+    zebra_interface_up_send (ifp);
+  else
+    zebra_interface_down_send (ifp);
+}
+
+static int
+zebra_interface_update_timer (struct thread *thread)
+{
+  struct interface *ifp = THREAD_ARG (thread);
+  struct zebra_if *zif = ifp->info;
+
+  zif->t_update = NULL;
+  zebra_interface_update_flush (ifp);
+  return 0;
+}
+
+/*
+ * Hold an up/down notification for the interface until the update
+ * timer, started by the first change, expires. Later changes within
+ * the window replace the held one, so a flapping interface costs each
+ * client one message carrying its final state.
+ */
+static int
+zebra_interface_update_defer (struct interface *ifp, int cmd)
+{
+  struct zebra_if *zif = ifp->info;
+
+  if (!zebra_if_update_timer || !zif)
+    return 0;
+
+  if (IS_ZEBRA_DEBUG_EVENT && zif->update_pending)
+    zlog_debug ("MESSAGE: %s %s replaces pending %s",
+                zserv_command_string (cmd), ifp->name,
+                zserv_command_string (zif->update_pending));
+
+  zif->update_pending = cmd;
+  if (!zif->t_update)
+    zif->t_update = thread_add_timer_msec (zebrad.master,
+                                           zebra_interface_update_timer,
+                                           ifp, zebra_if_update_timer);
+  return 1;
+}
+
+/* Interface up information. */
+void
+zebra_interface_up_update (struct interface *ifp)
+{
+  if (!zebra_interface_update_defer (ifp, ZEBRA_INTERFACE_UP))
+    zebra_interface_up_send (ifp);
+}
+
+/* Interface down information. */
+void
+zebra_interface_down_update (struct interface *ifp)
+{
+  if (!zebra_interface_update_defer (ifp, ZEBRA_INTERFACE_DOWN))
+    zebra_interface_down_send (ifp);
+}
+
+void
+zebra_interface_set_delay_timer (u_int32_t value)
+{
+  zebra_if_update_timer = value;
+}
+
+void
+zebra_interface_write_delay_timer (struct vty *vty)
+{
+  if (zebra_if_update_timer != ZEBRA_IF_DEFAULT_UPDATE_TIMER)
+    vty_out (vty, "zebra interface delay-timer %u%s", zebra_if_update_timer,
+             VTY_NEWLINE);
+}
+
 /* Interface information update. */
 void
 zebra_interface_add_update (struct interface *ifp)
@@ -374,6 +624,15 @@ zebra_interface_delete_update (struct interface *ifp)
   if (IS_ZEBRA_DEBUG_EVENT)
     zlog_debug ("MESSAGE: ZEBRA_INTERFACE_DELETE %s", ifp->name);
 
+  /* Nothing held for the interface is of interest any more */
+  if (ifp->info)
+    {
+      struct zebra_if *zif = ifp->info;
+
+      zif->update_pending = 0;
+      THREAD_TIMER_OFF (zif->t_update);
+    }
+
   for (ALL_LIST_ELEMENTS (zebrad.client_list, node, nnode, client))
     {
       client->ifdel_cnt++;
@@ -405,6 +664,9 @@ zebra_interface_address_add_update (struct interface *ifp,
 
   router_id_add_address(ifc);
 
+  /* Clients learn of the interface state before its addresses */
+  zebra_interface_update_flush (ifp);
+
   for (ALL_LIST_ELEMENTS (zebrad.client_list, node, nnode, client))
     if (CHECK_FLAG (ifc->conf, ZEBRA_IFC_REAL))
       {
@@ -434,6 +696,8 @@ zebra_interface_address_delete_update (struct interface *ifp,
 
   router_id_del_address(ifc);
 
+  zebra_interface_update_flush (ifp);
+
   for (ALL_LIST_ELEMENTS (zebrad.client_list, node, nnode, client))
     if (CHECK_FLAG (ifc->conf, ZEBRA_IFC_REAL))
       {
@@ -455,6 +719,8 @@ zebra_interface_vrf_update_del (struct interface *ifp, vrf_id_t new_vrf_id)
     zlog_debug ("MESSAGE: ZEBRA_INTERFACE_VRF_UPDATE/DEL %s VRF Id %u -> %u",
                 ifp->name, ifp->vrf_id, new_vrf_id);
 
+  zebra_interface_update_flush (ifp);
+
   for (ALL_LIST_ELEMENTS (zebrad.client_list, node, nnode, client))
     {
       /* Need to delete if the client is not interested in the new VRF. */
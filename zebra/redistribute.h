@@ -36,11 +36,19 @@ extern void zebra_redistribute_default_add (int, struct zserv *, int,
 extern void zebra_redistribute_default_delete (int, struct zserv *, int,
 					       struct zebra_vrf *zvrf);
 
+extern void zebra_redistribute_resume (struct zserv *);
+extern void zebra_redistribute_snapshot_free (struct zserv *);
+
 extern void redistribute_update (struct prefix *, struct rib *, struct rib *);
 extern void redistribute_delete (struct prefix *, struct rib *);
 
+/* Default interface delay-timer, in msec */
+#define ZEBRA_IF_DEFAULT_UPDATE_TIMER 10
+
 extern void zebra_interface_up_update (struct interface *);
 extern void zebra_interface_down_update (struct interface *);
+extern void zebra_interface_set_delay_timer (u_int32_t);
+extern void zebra_interface_write_delay_timer (struct vty *);
 
 extern void zebra_interface_add_update (struct interface *);
 extern void zebra_interface_delete_update (struct interface *);
@@ -47,6 +47,10 @@ void zebra_interface_up_update (struct interface *a)
 { return; }
 void zebra_interface_down_update  (struct interface *a)
 { return; }
+void zebra_interface_set_delay_timer (u_int32_t a)
+{ return; }
+void zebra_interface_write_delay_timer (struct vty *a)
+{ return; }
 void zebra_interface_add_update (struct interface *a)
 { return; }
 void zebra_interface_delete_update (struct interface *a)
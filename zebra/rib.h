@@ -44,6 +44,13 @@ struct rib
   
   /* Nexthop structure */
   struct nexthop *nexthop;
+
+  /* Shared nexthop group, see zebra_nhg.h */
+  struct nhg_entry *nhg;
+
+  /* Interfaces the entry is filed under, see rib_update_interface() */
+  ifindex_t *ifindexes;
+  unsigned int ifindex_num;
   
   /* Refrence count. */
   unsigned long refcnt;
@@ -137,6 +144,12 @@ typedef struct rib_dest_t_
    */
   TAILQ_ENTRY(rib_dest_t_) fpm_q_entries;
 
+  /*
+   * FPM sequence number of the last change to this dest that the FPM
+   * has been, or is yet to be, told about.
+   */
+  u_int32_t fpm_seq;
+
 } rib_dest_t;
 
 #define RIB_ROUTE_QUEUED(x)	(1 << (x))
@@ -363,6 +376,7 @@ extern struct rib *rib_match_ipv4_multicast (vrf_id_t vrf_id, struct in_addr add
 extern struct rib *rib_lookup_ipv4 (struct prefix_ipv4 *, vrf_id_t);
 
 extern void rib_update (vrf_id_t, rib_update_event_t);
+extern void rib_update_interface (struct interface *);
 extern void rib_weed_tables (void);
 extern void rib_sweep_route (void);
 extern void rib_close_table (struct route_table *);
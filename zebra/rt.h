@@ -44,6 +44,11 @@ extern int kernel_add_neigh (struct interface *ifp, struct ipaddr *ip,
                              struct ethaddr *mac);
 extern int kernel_del_neigh (struct interface *ifp, struct ipaddr *ip);
 
+/* MAC and neighbor updates issued between these calls may be queued
+ * and handed to the kernel together. */
+extern void kernel_batch_begin (void);
+extern int kernel_batch_end (void);
+
 extern int kernel_add_lsp (zebra_lsp_t *);
 extern int kernel_upd_lsp (zebra_lsp_t *);
 extern int kernel_del_lsp (zebra_lsp_t *);
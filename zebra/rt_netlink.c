@@ -331,6 +331,9 @@ netlink_route_change_read_unicast (struct sockaddr_nl *snl, struct nlmsghdr *h,
 
   if (h->nlmsg_type == RTM_NEWROUTE)
     {
+      if (startup)
+        zebrad.startup_routes++;
+
       if (!tb[RTA_MULTIPATH])
         rib_add (afi, SAFI_UNICAST, vrf_id, ZEBRA_ROUTE_KERNEL,
                  0, flags, &p, gate, src, index,
@@ -1679,7 +1682,7 @@ netlink_macfdb_update (struct interface *ifp, vlanid_t vid,
                 mac2str (mac, buf, sizeof (buf)),
                 inet_ntoa (vtep_ip));
 
-  return netlink_talk (netlink_talk_filter, &req.n, &zns->netlink_cmd, zns, 0);
+  return netlink_batch_talk (&req.n, &zns->netlink_cmd, zns);
 }
 
 static int
@@ -1723,7 +1726,7 @@ netlink_neigh_update2 (struct interface *ifp, struct ipaddr *ip,
                 ipaddr2str (ip, buf, sizeof(buf)),
                 mac ? mac2str (mac, buf2, sizeof (buf2)) : "null");
 
-  return netlink_talk (netlink_talk_filter, &req.n, &zns->netlink_cmd, zns, 0);
+  return netlink_batch_talk (&req.n, &zns->netlink_cmd, zns);
 }
 
 /* Routing table change via netlink interface. */
@@ -2101,6 +2104,18 @@ int kernel_del_neigh (struct interface *ifp, struct ipaddr *ip)
   return netlink_neigh_update2 (ifp, ip, NULL, 0, RTM_DELNEIGH);
 }
 
+void
+kernel_batch_begin (void)
+{
+  netlink_batch_begin ();
+}
+
+int
+kernel_batch_end (void)
+{
+  return netlink_batch_end ();
+}
+
 /*
  * MPLS label forwarding table change via netlink interface.
  */
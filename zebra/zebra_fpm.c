@@ -108,6 +108,12 @@ typedef struct zfpm_stats_t_ {
   unsigned long t_conn_up_aborts;
   unsigned long t_conn_up_finishes;
 
+  unsigned long route_msgs_batched;
+  unsigned long acks_received;
+  unsigned long resync_requests;
+  unsigned long resync_full;
+  unsigned long resync_incremental;
+
 } zfpm_stats_t;
 
 /*
@@ -217,8 +223,48 @@ typedef struct zfpm_glob_t_
 
   struct {
     zfpm_rnodes_iter_t iter;
+
+    /*
+     * If the walk answers a resync request from the FPM, whether all
+     * routes are to be sent, and otherwise the sequence number after
+     * which changes are to be sent.
+     */
+    int resync;
+    int full;
+    uint32_t from_seq;
   } t_conn_up_state;
 
+  /*
+   * True if several route messages may be packed into one FPM
+   * message.
+   */
+  int batch;
+
+  /*
+   * True if we should wait for the FPM to ask for a resync once the
+   * connection comes up, rather than send it all routes.
+   */
+  int wait_resync;
+
+  /*
+   * Sequence number of the last route change, the sequence number
+   * after which the FPM can no longer be brought up to date by
+   * sending changed dests alone, and the last sequence number the
+   * FPM acknowledged. Route messages also carry our pid, so that
+   * the FPM can tell that the numbers came from this process.
+   */
+  uint32_t seq;
+  uint32_t del_seq;
+  uint32_t acked_seq;
+  uint32_t pid;
+
+  /*
+   * Resync whose end has yet to be signalled to the FPM, and whether
+   * it was a full one.
+   */
+  int resync_done_pending;
+  int resync_done_full;
+
   unsigned long connect_calls;
   time_t last_connect_call_time;
 
@@ -533,6 +579,37 @@ zfpm_write_off (void)
   THREAD_WRITE_OFF (zfpm_g->t_write);
 }
 
+/*
+ * zfpm_conn_up_dest_needed
+ *
+ * Returns TRUE if the walk that brings the FPM up to date needs to
+ * send the given dest.
+ */
+static int
+zfpm_conn_up_dest_needed (rib_dest_t *dest)
+{
+  if (!zfpm_g->t_conn_up_state.resync || zfpm_g->t_conn_up_state.full)
+    return 1;
+
+  /*
+   * In an incremental resync the FPM already has every route that
+   * has not changed since the sequence number it asked from.
+   */
+  if (dest->fpm_seq <= zfpm_g->t_conn_up_state.from_seq)
+    {
+      if (zfpm_route_for_update (dest))
+	SET_FLAG (dest->flags, RIB_DEST_SENT_TO_FPM);
+      return 0;
+    }
+
+  /*
+   * Changed dests are sent even if they have no route, as the FPM may
+   * still hold the one they had.
+   */
+  SET_FLAG (dest->flags, RIB_DEST_SENT_TO_FPM);
+  return 1;
+}
+
 /*
  * zfpm_conn_up_thread_cb
  *
@@ -565,7 +642,8 @@ zfpm_conn_up_thread_cb (struct thread *thread)
       if (dest)
 	{
 	  zfpm_g->stats.t_conn_up_dests_processed++;
-	  zfpm_trigger_update (rnode, NULL);
+	  if (zfpm_conn_up_dest_needed (dest))
+	    zfpm_trigger_update (rnode, NULL);
 	}
 
       /*
@@ -584,11 +662,43 @@ zfpm_conn_up_thread_cb (struct thread *thread)
 
   zfpm_g->stats.t_conn_up_finishes++;
 
+  /*
+   * Tell the FPM the resync is over once the queue drains.
+   */
+  if (zfpm_g->t_conn_up_state.resync)
+    {
+      zfpm_g->resync_done_pending = 1;
+      zfpm_g->resync_done_full = zfpm_g->t_conn_up_state.full;
+      if (!zfpm_g->t_write)
+	zfpm_write_on ();
+    }
+
  done:
   zfpm_rnodes_iter_cleanup (iter);
   return 0;
 }
 
+/*
+ * zfpm_start_conn_up_walk
+ *
+ * Start the thread that walks all dests to bring the FPM up to date.
+ */
+static void
+zfpm_start_conn_up_walk (int resync, int full, uint32_t from_seq)
+{
+  assert (!zfpm_g->t_conn_up);
+
+  zfpm_rnodes_iter_init (&zfpm_g->t_conn_up_state.iter);
+  zfpm_g->t_conn_up_state.resync = resync;
+  zfpm_g->t_conn_up_state.full = full;
+  zfpm_g->t_conn_up_state.from_seq = from_seq;
+
+  zfpm_debug ("Starting conn_up thread");
+  zfpm_g->t_conn_up = thread_add_background (zfpm_g->master,
+					     zfpm_conn_up_thread_cb, 0, 0);
+  zfpm_g->stats.t_conn_up_starts++;
+}
+
 /*
  * zfpm_connection_up
  *
@@ -601,18 +711,21 @@ zfpm_connection_up (const char *detail)
   zfpm_read_on ();
   zfpm_write_on ();
   zfpm_set_state (ZFPM_STATE_ESTABLISHED, detail);
+  zfpm_g->resync_done_pending = 0;
 
   /*
-   * Start thread to push existing routes to the FPM.
+   * The FPM will tell us what it needs.
    */
-  assert (!zfpm_g->t_conn_up);
-
-  zfpm_rnodes_iter_init (&zfpm_g->t_conn_up_state.iter);
+  if (zfpm_g->wait_resync)
+    {
+      zfpm_debug ("Waiting for the FPM to request a resync");
+      return;
+    }
 
-  zfpm_debug ("Starting conn_up thread");
-  zfpm_g->t_conn_up = thread_add_background (zfpm_g->master,
-					     zfpm_conn_up_thread_cb, 0, 0);
-  zfpm_g->stats.t_conn_up_starts++;
+  /*
+   * Start thread to push existing routes to the FPM.
+   */
+  zfpm_start_conn_up_walk (0, 1, 0);
 }
 
 /*
@@ -679,6 +792,7 @@ zfpm_conn_down_thread_cb (struct thread *thread)
 	  if (CHECK_FLAG (dest->flags, RIB_DEST_UPDATE_FPM))
 	    {
 	      TAILQ_REMOVE (&zfpm_g->dest_q, dest, fpm_q_entries);
+	      dest->fpm_seq = ++zfpm_g->seq;
 	    }
 
 	  UNSET_FLAG (dest->flags, RIB_DEST_UPDATE_FPM);
@@ -755,6 +869,29 @@ zfpm_connection_down (const char *detail)
   zfpm_set_state (ZFPM_STATE_IDLE, detail);
 }
 
+/*
+ * zfpm_process_msg
+ *
+ * Act on a message received from the FPM.
+ */
+static void
+zfpm_process_msg (fpm_msg_hdr_t *hdr)
+{
+  switch (hdr->msg_type)
+    {
+    case FPM_MSG_TYPE_NETLINK:
+#ifdef HAVE_NETLINK
+      zfpm_netlink_process_msg ((char *) fpm_msg_data (hdr),
+				fpm_msg_data_len (hdr));
+#endif /* HAVE_NETLINK */
+      break;
+
+    default:
+      zfpm_debug ("Ignoring message of type %d from the FPM", hdr->msg_type);
+      break;
+    }
+}
+
 /*
  * zfpm_read_cb
  */
@@ -835,9 +972,14 @@ zfpm_read_cb (struct thread *thread)
 
   zfpm_debug ("Read out a full fpm message");
 
+  zfpm_process_msg (hdr);
+
   /*
-   * Just throw it away for now.
+   * Processing the message may have taken the connection down.
    */
+  if (zfpm_g->state != ZFPM_STATE_ESTABLISHED)
+    return 0;
+
   stream_reset (ibuf);
 
  done:
@@ -904,6 +1046,14 @@ zfpm_encode_route (rib_dest_t *dest, struct rib *rib, char *in_buf,
     cmd = rib ? RTM_NEWROUTE : RTM_DELROUTE;
     len = zfpm_netlink_encode_route (cmd, dest, rib, in_buf, in_buf_len);
     assert(fpm_msg_align(len) == len);
+    if (len)
+      {
+	struct nlmsghdr *n = (struct nlmsghdr *) in_buf;
+
+	dest->fpm_seq = ++zfpm_g->seq;
+	n->nlmsg_seq = dest->fpm_seq;
+	n->nlmsg_pid = zfpm_g->pid;
+      }
     *msg_type = FPM_MSG_TYPE_NETLINK;
 #endif /* HAVE_NETLINK */
     break;
@@ -940,6 +1090,50 @@ zfpm_route_for_update (rib_dest_t *dest)
   return NULL;
 }
 
+/*
+ * zfpm_build_resync_done
+ *
+ * Write the message that tells the FPM a resync is over, if the
+ * message format has one.
+ */
+static void
+zfpm_build_resync_done (unsigned char *buf, unsigned char *buf_end)
+{
+#ifdef HAVE_NETLINK
+  fpm_msg_hdr_t *hdr;
+  unsigned char *data;
+  size_t data_len;
+  size_t msg_len;
+#endif /* HAVE_NETLINK */
+
+  zfpm_g->resync_done_pending = 0;
+
+  if (zfpm_g->message_format != ZFPM_MSG_FORMAT_NETLINK)
+    return;
+
+#ifdef HAVE_NETLINK
+  hdr = (fpm_msg_hdr_t *) buf;
+  hdr->version = FPM_PROTO_VERSION;
+  data = fpm_msg_data (hdr);
+
+  data_len = zfpm_netlink_encode_done (zfpm_g->resync_done_full,
+				       (char *) data, buf_end - data);
+  if (!data_len)
+    return;
+
+  ((struct nlmsghdr *) data)->nlmsg_seq = zfpm_g->seq;
+  ((struct nlmsghdr *) data)->nlmsg_pid = zfpm_g->pid;
+
+  hdr->msg_type = FPM_MSG_TYPE_NETLINK;
+  msg_len = fpm_data_len_to_msg_len (data_len);
+  hdr->msg_len = htons (msg_len);
+  stream_forward_endp (zfpm_g->obuf, msg_len);
+
+  zfpm_debug ("Sent end of %s resync at sequence number %u",
+	      zfpm_g->resync_done_full ? "full" : "incremental", zfpm_g->seq);
+#endif /* HAVE_NETLINK */
+}
+
 /*
  * zfpm_build_updates
  *
@@ -954,7 +1148,7 @@ zfpm_build_updates (void)
   unsigned char *buf, *data, *buf_end;
   size_t msg_len;
   size_t data_len;
-  fpm_msg_hdr_t *hdr;
+  fpm_msg_hdr_t *hdr, *batch_hdr;
   struct rib *rib;
   int is_add, write_msg;
   fpm_msg_type_e msg_type;
@@ -963,6 +1157,11 @@ zfpm_build_updates (void)
 
   assert (stream_empty (s));
 
+  /*
+   * FPM message that further route messages may be appended to.
+   */
+  batch_hdr = NULL;
+
   do {
 
     /*
@@ -976,7 +1175,11 @@ zfpm_build_updates (void)
 
     dest = TAILQ_FIRST (&zfpm_g->dest_q);
     if (!dest)
-      break;
+      {
+	if (zfpm_g->resync_done_pending && !zfpm_g->t_conn_up)
+	  zfpm_build_resync_done (buf, buf_end);
+	break;
+      }
 
     assert (CHECK_FLAG (dest->flags, RIB_DEST_UPDATE_FPM));
 
@@ -1005,17 +1208,38 @@ zfpm_build_updates (void)
 				    &msg_type);
 
       assert (data_len);
-      if (data_len)
+      if (data_len && batch_hdr && batch_hdr->msg_type == msg_type
+	  && fpm_msg_len (batch_hdr) + data_len <= FPM_MAX_MSG_LEN)
+	{
+	  /*
+	   * Append the route message to the open FPM message.
+	   */
+	  memmove (buf, data, data_len);
+	  batch_hdr->msg_len = htons (fpm_msg_len (batch_hdr) + data_len);
+	  stream_forward_endp (s, data_len);
+	  zfpm_g->stats.route_msgs_batched++;
+	}
+      else if (data_len)
 	{
 	  hdr->msg_type = msg_type;
 	  msg_len = fpm_data_len_to_msg_len (data_len);
 	  hdr->msg_len = htons (msg_len);
 	  stream_forward_endp (s, msg_len);
 
+	  if (zfpm_g->batch && msg_type == FPM_MSG_TYPE_NETLINK)
+	    batch_hdr = hdr;
+	}
+
+      if (data_len)
+	{
 	  if (is_add)
 	    zfpm_g->stats.route_adds++;
 	  else
-	    zfpm_g->stats.route_dels++;
+	    {
+	      zfpm_g->stats.route_dels++;
+	      if (dest->fpm_seq > zfpm_g->del_seq)
+		zfpm_g->del_seq = dest->fpm_seq;
+	    }
 	}
     }
 
@@ -1143,7 +1367,7 @@ zfpm_write_cb (struct thread *thread)
 static int
 zfpm_connect_cb (struct thread *t)
 {
-  int sock, ret;
+  int sock, ret, on;
   struct sockaddr_in serv;
 
   assert (zfpm_g->t_connect);
@@ -1160,6 +1384,17 @@ zfpm_connect_cb (struct thread *t)
 
   set_nonblocking(sock);
 
+  /*
+   * Updates are already framed into large writes. Disable Nagle so that
+   * a short last write, such as the end of a resync, is not held back
+   * until the FPM acknowledges the previous one.
+   */
+  on = 1;
+  if (setsockopt (sock, IPPROTO_TCP, TCP_NODELAY, (char *) &on,
+		  sizeof (on)) < 0)
+    zfpm_debug ("Failed to disable Nagle on FPM socket: %s",
+		safe_strerror (errno));
+
   /* Make server socket. */
   memset (&serv, 0, sizeof (serv));
   serv.sin_family = AF_INET;
@@ -1349,14 +1584,20 @@ zfpm_trigger_update (struct route_node *rn, const char *reason)
   rib_dest_t *dest;
   char buf[PREFIX_STRLEN];
 
+  dest = rib_dest_from_rnode (rn);
+
   /*
    * Ignore if the connection is down. We will update the FPM about
-   * all destinations once the connection comes up.
+   * all destinations once the connection comes up, or about those
+   * that changed since its last update if it asks for a resync.
    */
   if (!zfpm_conn_is_up ())
-    return;
-
-  dest = rib_dest_from_rnode (rn);
+    {
+      if (zfpm_g->enabled && dest
+	  && zfpm_is_table_for_fpm (rib_dest_table (dest)))
+	dest->fpm_seq = ++zfpm_g->seq;
+      return;
+    }
 
   /*
    * Ignore the trigger if the dest is not in a table that we would
@@ -1392,6 +1633,84 @@ zfpm_trigger_update (struct route_node *rn, const char *reason)
   zfpm_write_on ();
 }
 
+/*
+ * zfpm_dest_deleted
+ *
+ * The zebra code invokes this function when it frees the dest of the
+ * given route_node.
+ */
+void
+zfpm_dest_deleted (struct route_node *rn)
+{
+  rib_dest_t *dest;
+
+  dest = rib_dest_from_rnode (rn);
+  if (!zfpm_g->enabled || !dest
+      || !zfpm_is_table_for_fpm (rib_dest_table (dest)))
+    return;
+
+  /*
+   * Unless the FPM was just told the route is gone, it may still hold
+   * it, and the only way to bring it up to date from here on is to
+   * send it all routes.
+   */
+  if (dest->fpm_seq == zfpm_g->del_seq)
+    return;
+
+  zfpm_g->del_seq = ++zfpm_g->seq;
+}
+
+/*
+ * zfpm_ack
+ *
+ * Called when the FPM acknowledges the messages up to the given
+ * sequence number.
+ */
+void
+zfpm_ack (uint32_t seq)
+{
+  zfpm_g->stats.acks_received++;
+
+  if (seq > zfpm_g->acked_seq)
+    zfpm_g->acked_seq = seq;
+}
+
+/*
+ * zfpm_resync_request
+ *
+ * Called when the FPM asks to be brought up to date, having applied
+ * the messages up to the given sequence number from the process with
+ * the given pid.
+ */
+void
+zfpm_resync_request (uint32_t pid, uint32_t seq)
+{
+  int full;
+
+  zfpm_g->stats.resync_requests++;
+
+  full = (seq == 0 || pid != zfpm_g->pid || seq < zfpm_g->del_seq
+	  || seq > zfpm_g->seq);
+
+  if (full)
+    zfpm_g->stats.resync_full++;
+  else
+    zfpm_g->stats.resync_incremental++;
+
+  zfpm_debug ("FPM requested resync from sequence number %u, sending %s",
+	      seq, full ? "all routes" : "changes");
+
+  if (zfpm_g->t_conn_up)
+    {
+      THREAD_OFF (zfpm_g->t_conn_up);
+      zfpm_rnodes_iter_cleanup (&zfpm_g->t_conn_up_state.iter);
+      zfpm_g->stats.t_conn_up_aborts++;
+    }
+
+  zfpm_g->resync_done_pending = 0;
+  zfpm_start_conn_up_walk (1, full, seq);
+}
+
 /*
  * zfpm_stats_timer_cb
  */
@@ -1502,6 +1821,14 @@ zfpm_show_stats (struct vty *vty)
   ZFPM_SHOW_STAT (t_conn_up_yields);
   ZFPM_SHOW_STAT (t_conn_up_aborts);
   ZFPM_SHOW_STAT (t_conn_up_finishes);
+  ZFPM_SHOW_STAT (route_msgs_batched);
+  ZFPM_SHOW_STAT (acks_received);
+  ZFPM_SHOW_STAT (resync_requests);
+  ZFPM_SHOW_STAT (resync_full);
+  ZFPM_SHOW_STAT (resync_incremental);
+
+  vty_out (vty, "%sSequence number: %u, last acknowledged: %u%s", VTY_NEWLINE,
+	   zfpm_g->seq, zfpm_g->acked_seq, VTY_NEWLINE);
 
   if (!zfpm_g->last_stats_clear_time)
     return;
@@ -1612,6 +1939,48 @@ DEFUN ( no_fpm_remote_ip,
 
    return CMD_SUCCESS;
 }
+
+DEFUN (fpm_batch,
+       fpm_batch_cmd,
+       "fpm batch",
+       "Forwarding Path Manager configuration\n"
+       "Pack several route updates into each FPM message\n")
+{
+  zfpm_g->batch = 1;
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_fpm_batch,
+       no_fpm_batch_cmd,
+       "no fpm batch",
+       NO_STR
+       "Forwarding Path Manager configuration\n"
+       "Pack several route updates into each FPM message\n")
+{
+  zfpm_g->batch = 0;
+  return CMD_SUCCESS;
+}
+
+DEFUN (fpm_wait_resync,
+       fpm_wait_resync_cmd,
+       "fpm wait-resync",
+       "Forwarding Path Manager configuration\n"
+       "Wait for the FPM to request a resync after connecting\n")
+{
+  zfpm_g->wait_resync = 1;
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_fpm_wait_resync,
+       no_fpm_wait_resync_cmd,
+       "no fpm wait-resync",
+       NO_STR
+       "Forwarding Path Manager configuration\n"
+       "Wait for the FPM to request a resync after connecting\n")
+{
+  zfpm_g->wait_resync = 0;
+  return CMD_SUCCESS;
+}
 #endif
 
 /*
@@ -1692,6 +2061,12 @@ int fpm_remote_srv_write (struct vty *vty )
           zfpm_g->fpm_port != FPM_DEFAULT_PORT)
       vty_out (vty,"fpm connection ip %s port %d%s", inet_ntoa (in),zfpm_g->fpm_port,VTY_NEWLINE);
 
+   if (zfpm_g->batch)
+      vty_out (vty, "fpm batch%s", VTY_NEWLINE);
+
+   if (zfpm_g->wait_resync)
+      vty_out (vty, "fpm wait-resync%s", VTY_NEWLINE);
+
    return 0;
 }
 
@@ -1724,6 +2099,7 @@ zfpm_init (struct thread_master *master, int enable, uint16_t port,
   TAILQ_INIT(&zfpm_g->dest_q);
   zfpm_g->sock = -1;
   zfpm_g->state = ZFPM_STATE_IDLE;
+  zfpm_g->pid = getpid ();
 
   zfpm_stats_init (&zfpm_g->stats);
   zfpm_stats_init (&zfpm_g->last_ivl_stats);
@@ -1734,6 +2110,10 @@ zfpm_init (struct thread_master *master, int enable, uint16_t port,
   install_element (ENABLE_NODE, &clear_zebra_fpm_stats_cmd);
   install_element (CONFIG_NODE, &fpm_remote_ip_cmd);
   install_element (CONFIG_NODE, &no_fpm_remote_ip_cmd);
+  install_element (CONFIG_NODE, &fpm_batch_cmd);
+  install_element (CONFIG_NODE, &no_fpm_batch_cmd);
+  install_element (CONFIG_NODE, &fpm_wait_resync_cmd);
+  install_element (CONFIG_NODE, &no_fpm_wait_resync_cmd);
 #endif
 
   zfpm_init_message_format(format);
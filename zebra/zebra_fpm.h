@@ -31,6 +31,7 @@
 extern int zfpm_init (struct thread_master *master, int enable, uint16_t port,
 		      const char *message_format);
 extern void zfpm_trigger_update (struct route_node *rn, const char *reason);
+extern void zfpm_dest_deleted (struct route_node *rn);
 extern int fpm_remote_srv_write (struct vty *vty);
 
 #endif /* _ZEBRA_FPM_H */
@@ -36,6 +36,7 @@
 #include "zebra/rt_netlink.h"
 #include "nexthop.h"
 
+#include "fpm/fpm.h"
 #include "zebra/zebra_fpm_private.h"
 
 /*
@@ -491,3 +492,72 @@ zfpm_netlink_encode_route (int cmd, rib_dest_t *dest, struct rib *rib,
 
   return netlink_route_info_encode (ri, in_buf, in_buf_len);
 }
+
+/*
+ * zfpm_netlink_encode_done
+ *
+ * Create the NLMSG_DONE message that ends a resync in the given buffer
+ * space.
+ *
+ * Returns the number of bytes written to the buffer. 0 indicates an
+ * error.
+ */
+int
+zfpm_netlink_encode_done (int full, char *in_buf, size_t in_buf_len)
+{
+  struct nlmsghdr *n;
+
+  if (in_buf_len < NLMSG_SPACE (sizeof (int)))
+    return 0;
+
+  n = (struct nlmsghdr *) in_buf;
+  memset (n, 0, NLMSG_SPACE (sizeof (int)));
+  n->nlmsg_len = NLMSG_LENGTH (sizeof (int));
+  n->nlmsg_type = NLMSG_DONE;
+  n->nlmsg_flags = NLM_F_MULTI;
+  *(int *) NLMSG_DATA (n) = full ? FPM_RESYNC_FULL : FPM_RESYNC_INCREMENTAL;
+
+  return NLMSG_SPACE (sizeof (int));
+}
+
+/*
+ * zfpm_netlink_process_msg
+ *
+ * Act on the netlink messages carried in a message from the FPM.
+ */
+void
+zfpm_netlink_process_msg (char *buf, size_t buf_len)
+{
+  struct nlmsghdr *n;
+  struct nlmsgerr *err;
+  int len;
+
+  len = buf_len;
+  for (n = (struct nlmsghdr *) buf; NLMSG_OK (n, len);
+       n = NLMSG_NEXT (n, len))
+    {
+      switch (n->nlmsg_type)
+	{
+	case NLMSG_ERROR:
+	  if (n->nlmsg_len < NLMSG_LENGTH (sizeof (struct nlmsgerr)))
+	    break;
+
+	  err = NLMSG_DATA (n);
+	  if (err->error == 0)
+	    zfpm_ack (n->nlmsg_seq);
+	  else
+	    zfpm_debug ("FPM failed to apply message %u: %s", n->nlmsg_seq,
+			safe_strerror (-err->error));
+	  break;
+
+	case RTM_GETROUTE:
+	  zfpm_resync_request (n->nlmsg_pid, n->nlmsg_seq);
+	  break;
+
+	default:
+	  zfpm_debug ("Ignoring %s message from the FPM",
+		      nl_msg_type_to_str (n->nlmsg_type));
+	  break;
+	}
+    }
+}
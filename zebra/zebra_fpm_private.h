@@ -57,5 +57,12 @@ extern int
 zfpm_protobuf_encode_route (rib_dest_t *dest, struct rib *rib,
 			    uint8_t *in_buf, size_t in_buf_len);
 
+extern int
+zfpm_netlink_encode_done (int full, char *in_buf, size_t in_buf_len);
+
+extern void zfpm_netlink_process_msg (char *buf, size_t buf_len);
+
 extern struct rib *zfpm_route_for_update (rib_dest_t *dest);
+extern void zfpm_ack (uint32_t seq);
+extern void zfpm_resync_request (uint32_t pid, uint32_t seq);
 #endif /* _ZEBRA_FPM_PRIVATE_H */
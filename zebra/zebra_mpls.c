@@ -100,6 +100,14 @@ nhlfe_add (zebra_lsp_t *lsp, enum lsp_types_t lsp_type,
            char *ifname, ifindex_t ifindex, mpls_label_t out_label);
 static int
 nhlfe_del (zebra_nhlfe_t *snhlfe);
+static void
+nhlfe_gate_prefix (zebra_nhlfe_t *nhlfe, struct prefix *p);
+static void
+nhlfe_gate_index_add (zebra_nhlfe_t *nhlfe);
+static void
+nhlfe_gate_index_del (zebra_nhlfe_t *nhlfe);
+static void
+lsp_dirty_unlink (zebra_lsp_t *lsp);
 static int
 mpls_lsp_uninstall_all (struct hash *lsp_table, zebra_lsp_t *lsp,
 			enum lsp_types_t type);
@@ -523,6 +531,7 @@ lsp_processq_del (struct work_queue *wq, void *data)
         zlog_debug ("Free LSP in-label %u flags 0x%x",
                     lsp->ile.in_label, lsp->flags);
 
+      lsp_dirty_unlink (lsp);
       lsp = hash_release(lsp_table, &lsp->ile);
       if (lsp)
         XFREE(MTYPE_LSP, lsp);
@@ -663,6 +672,106 @@ nhlfe_find (zebra_lsp_t *lsp, enum lsp_types_t lsp_type,
   return nhlfe;
 }
 
+/*
+ * Make the host prefix for the nexthop address of a NHLFE.
+ */
+static void
+nhlfe_gate_prefix (zebra_nhlfe_t *nhlfe, struct prefix *p)
+{
+  memset (p, 0, sizeof (struct prefix));
+  p->family = NHLFE_FAMILY (nhlfe);
+  if (p->family == AF_INET)
+    {
+      p->prefixlen = IPV4_MAX_BITLEN;
+      p->u.prefix4 = nhlfe->nexthop->gate.ipv4;
+    }
+  else
+    {
+      p->prefixlen = IPV6_MAX_BITLEN;
+      p->u.prefix6 = nhlfe->nexthop->gate.ipv6;
+    }
+}
+
+/*
+ * Index a NHLFE by its nexthop address, so that a change to the RIB
+ * node its nexthop resolves over finds it.
+ */
+static void
+nhlfe_gate_index_add (zebra_nhlfe_t *nhlfe)
+{
+  struct zebra_vrf *zvrf;
+  struct route_table *table;
+  struct route_node *rn;
+  struct prefix p;
+  afi_t afi;
+
+  zvrf = vrf_info_lookup (VRF_DEFAULT);
+  if (!zvrf)
+    return;
+
+  nhlfe_gate_prefix (nhlfe, &p);
+  afi = family2afi (p.family);
+  table = zvrf->nhlfe_gate_table[afi];
+  if (!table)
+    table = zvrf->nhlfe_gate_table[afi] = route_table_init ();
+
+  rn = route_node_get (table, &p);
+  if (!rn->info)
+    rn->info = list_new ();
+  else
+    route_unlock_node (rn);
+  listnode_add (rn->info, nhlfe);
+}
+
+static void
+nhlfe_gate_index_del (zebra_nhlfe_t *nhlfe)
+{
+  struct zebra_vrf *zvrf;
+  struct route_table *table;
+  struct route_node *rn;
+  struct prefix p;
+
+  zvrf = vrf_info_lookup (VRF_DEFAULT);
+  if (!zvrf)
+    return;
+
+  nhlfe_gate_prefix (nhlfe, &p);
+  table = zvrf->nhlfe_gate_table[family2afi (p.family)];
+  if (!table)
+    return;
+
+  rn = route_node_lookup (table, &p);
+  if (!rn)
+    return;
+
+  listnode_delete (rn->info, nhlfe);
+  if (list_isempty ((struct list *) rn->info))
+    {
+      list_delete (rn->info);
+      rn->info = NULL;
+      route_unlock_node (rn);
+    }
+  route_unlock_node (rn);
+}
+
+/*
+ * Take a LSP that is about to be freed off the queue of LSPs awaiting
+ * processing.
+ */
+static void
+lsp_dirty_unlink (zebra_lsp_t *lsp)
+{
+  struct zebra_vrf *zvrf;
+
+  if (!CHECK_FLAG (lsp->flags, LSP_FLAG_DIRTY))
+    return;
+
+  zvrf = vrf_info_lookup (VRF_DEFAULT);
+  if (zvrf)
+    TAILQ_REMOVE (&zvrf->lsp_dirty, lsp, dirty_entry);
+  UNSET_FLAG (lsp->flags, LSP_FLAG_DIRTY);
+}
+
 /*
  * Add NHLFE. Base entry must have been created and duplicate
  * check done.
@@ -722,6 +831,8 @@ nhlfe_add (zebra_lsp_t *lsp, enum lsp_types_t lsp_type,
   nhlfe->next = lsp->nhlfe_list;
   lsp->nhlfe_list = nhlfe;
 
+  nhlfe_gate_index_add (nhlfe);
+
   return nhlfe;
 }
 
@@ -742,7 +853,10 @@ nhlfe_del (zebra_nhlfe_t *nhlfe)
 
   /* Free nexthop. */
   if (nhlfe->nexthop)
-    nexthop_free(nhlfe->nexthop);
+    {
+      nhlfe_gate_index_del (nhlfe);
+      nexthop_free(nhlfe->nexthop);
+    }
 
   /* Unlink from LSP */
   if (nhlfe->next)
@@ -809,6 +923,7 @@ mpls_lsp_uninstall_all (struct hash *lsp_table, zebra_lsp_t *lsp,
         zlog_debug ("Free LSP in-label %u flags 0x%x",
                     lsp->ile.in_label, lsp->flags);
 
+      lsp_dirty_unlink (lsp);
       lsp = hash_release(lsp_table, &lsp->ile);
       if (lsp)
         XFREE(MTYPE_LSP, lsp);
@@ -1484,6 +1599,7 @@ mpls_lsp_uninstall (struct zebra_vrf *zvrf, enum lsp_types_t type,
             zlog_debug ("Free LSP in-label %u flags 0x%x",
                         lsp->ile.in_label, lsp->flags);
 
+          lsp_dirty_unlink (lsp);
           lsp = hash_release(lsp_table, &lsp->ile);
           if (lsp)
             XFREE(MTYPE_LSP, lsp);
@@ -1760,6 +1876,82 @@ zebra_mpls_lsp_schedule (struct zebra_vrf *zvrf)
   hash_iterate(zvrf->lsp_table, lsp_schedule, NULL);
 }
 
+/*
+ * Mark the LSPs with a NHLFE whose nexthop may resolve over the RIB
+ * node for the passed prefix. NHLFE nexthops are resolved by longest
+ * match, so these are the NHLFEs at or below the prefix in the nexthop
+ * index.
+ */
+void
+zebra_mpls_lsp_mark_dependents (struct zebra_vrf *zvrf, struct prefix *p)
+{
+  struct route_table *table;
+  struct route_node *top;
+  struct route_node *rn;
+  struct listnode *node;
+  zebra_nhlfe_t *nhlfe;
+  zebra_lsp_t *lsp;
+
+  if (!zvrf || (p->family != AF_INET && p->family != AF_INET6))
+    return;
+
+  table = zvrf->nhlfe_gate_table[family2afi (p->family)];
+  if (!table || !table->top)
+    return;
+
+  /* Find the root of the subtree covered by the prefix, without
+   * creating it.
+   */
+  top = table->top;
+  while (top && top->p.prefixlen < p->prefixlen && prefix_match (&top->p, p))
+    top = top->link[prefix_bit (&p->u.prefix, top->p.prefixlen)];
+  if (!top || !prefix_match (p, &top->p))
+    return;
+
+  for (rn = route_lock_node (top); rn; rn = route_next_until (rn, top))
+    {
+      if (!rn->info)
+        continue;
+
+      for (ALL_LIST_ELEMENTS_RO ((struct list *) rn->info, node, nhlfe))
+        {
+          lsp = nhlfe->lsp;
+          if (CHECK_FLAG (lsp->flags, LSP_FLAG_DIRTY))
+            continue;
+
+          SET_FLAG (lsp->flags, LSP_FLAG_DIRTY);
+          TAILQ_INSERT_TAIL (&zvrf->lsp_dirty, lsp, dirty_entry);
+          mpls_mark_lsps_for_processing (zvrf);
+        }
+    }
+}
+
+/*
+ * Schedule the LSPs marked by zebra_mpls_lsp_mark_dependents() for
+ * processing.
+ */
+void
+zebra_mpls_lsp_schedule_dirty (struct zebra_vrf *zvrf)
+{
+  zebra_lsp_t *lsp;
+  u_int32_t count = 0;
+
+  if (!zvrf)
+    return;
+
+  while ((lsp = TAILQ_FIRST (&zvrf->lsp_dirty)) != NULL)
+    {
+      TAILQ_REMOVE (&zvrf->lsp_dirty, lsp, dirty_entry);
+      UNSET_FLAG (lsp->flags, LSP_FLAG_DIRTY);
+      lsp_processq_add (lsp);
+      count++;
+    }
+
+  if (IS_ZEBRA_DEBUG_MPLS && count)
+    zlog_debug ("%u: Scheduled %u LSPs affected by RIB changes",
+                zvrf->vrf_id, count);
+}
+
 /*
  * Display MPLS label forwarding table for a specific LSP
  * (VTY command handler).
@@ -1906,9 +2098,27 @@ zebra_mpls_write_lsp_config (struct vty *vty, struct zebra_vrf *zvrf)
 void
 zebra_mpls_close_tables (struct zebra_vrf *zvrf)
 {
+  struct route_node *rn;
+  afi_t afi;
+
   if (!zvrf)
     return;
   hash_iterate(zvrf->lsp_table, lsp_uninstall_from_kernel, NULL);
+
+  for (afi = AFI_IP; afi < AFI_MAX; afi++)
+    {
+      if (!zvrf->nhlfe_gate_table[afi])
+        continue;
+      for (rn = route_top (zvrf->nhlfe_gate_table[afi]); rn;
+           rn = route_next (rn))
+        if (rn->info)
+          {
+            list_delete (rn->info);
+            rn->info = NULL;
+          }
+      route_table_finish (zvrf->nhlfe_gate_table[afi]);
+      zvrf->nhlfe_gate_table[afi] = NULL;
+    }
 }
 
 /*
@@ -1922,6 +2132,7 @@ zebra_mpls_init_tables (struct zebra_vrf *zvrf)
     return;
   zvrf->slsp_table = hash_create(label_hash, label_cmp);
   zvrf->lsp_table = hash_create(label_hash, label_cmp);
+  TAILQ_INIT (&zvrf->lsp_dirty);
   zvrf->mpls_flags = 0;
 }
 
@@ -141,10 +141,14 @@ struct zebra_lsp_t_
 #define LSP_FLAG_SCHEDULED        (1 << 0)
 #define LSP_FLAG_INSTALLED        (1 << 1)
 #define LSP_FLAG_CHANGED          (1 << 2)
+#define LSP_FLAG_DIRTY            (1 << 3)
 
   /* Address-family of NHLFE - saved here for delete. All NHLFEs */
   /* have to be of the same AF */
   u_char addr_family;
+
+  /* Linkage on the VRF queue of LSPs awaiting processing */
+  TAILQ_ENTRY (zebra_lsp_t_) dirty_entry;
 };
 
 
@@ -251,6 +255,21 @@ zebra_mpls_static_lsp_del (struct zebra_vrf *zvrf, mpls_label_t in_label,
 void
 zebra_mpls_lsp_schedule (struct zebra_vrf *zvrf);
 
+/*
+ * Mark the LSPs with a NHLFE whose nexthop may resolve over the RIB
+ * node for the passed prefix, for processing once the RIB work queue
+ * drains.
+ */
+void
+zebra_mpls_lsp_mark_dependents (struct zebra_vrf *zvrf, struct prefix *p);
+
+/*
+ * Schedule the LSPs marked by zebra_mpls_lsp_mark_dependents() for
+ * processing.
+ */
+void
+zebra_mpls_lsp_schedule_dirty (struct zebra_vrf *zvrf);
+
 /*
  * Display MPLS label forwarding table for a specific LSP
  * (VTY command handler).
@@ -0,0 +1,525 @@
+/* Zebra shared nexthop groups
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <zebra.h>
+
+#include "prefix.h"
+#include "table.h"
+#include "memory.h"
+#include "hash.h"
+#include "jhash.h"
+#include "linklist.h"
+#include "nexthop.h"
+#include "vty.h"
+#include "vrf.h"
+
+#include "zebra/rib.h"
+#include "zebra/zebra_memory.h"
+#include "zebra/zebra_nhg.h"
+
+DEFINE_MTYPE_STATIC(ZEBRA, NHG, "Nexthop group")
+
+/* All groups, keyed by VRF, resolution class and nexthops */
+static struct hash *nhg_hash;
+
+/* Groups by gateway address, one table per address family. A change to
+ * the RIB node for prefix P can only affect the resolution of gateways
+ * at or below P in these tables.
+ */
+static struct route_table *nhg_gate_table[AFI_MAX];
+
+static u_int32_t nhg_id_next = 1;
+
+/* Address family of the gateway that resolution looks up for this
+ * nexthop, or 0 if the nexthop is not resolved through the RIB.
+ */
+static int
+nhg_gate_family (struct nexthop *nexthop)
+{
+  switch (nexthop->type)
+    {
+    case NEXTHOP_TYPE_IPV4:
+    case NEXTHOP_TYPE_IPV4_IFINDEX:
+      return AF_INET;
+    case NEXTHOP_TYPE_IPV6:
+      return AF_INET6;
+    case NEXTHOP_TYPE_IPV6_IFINDEX:
+      if (IN6_IS_ADDR_LINKLOCAL (&nexthop->gate.ipv6))
+        return 0;
+      return AF_INET6;
+    default:
+      return 0;
+    }
+}
+
+static void
+nhg_gate_prefix (struct nexthop *nexthop, struct prefix *p)
+{
+  memset (p, 0, sizeof (struct prefix));
+  p->family = nhg_gate_family (nexthop);
+  if (p->family == AF_INET)
+    {
+      p->prefixlen = IPV4_MAX_BITLEN;
+      p->u.prefix4 = nexthop->gate.ipv4;
+    }
+  else
+    {
+      p->prefixlen = IPV6_MAX_BITLEN;
+      p->u.prefix6 = nexthop->gate.ipv6;
+    }
+}
+
+static int
+nhg_nexthop_has_ifindex (struct nexthop *nexthop)
+{
+  return (nexthop->type == NEXTHOP_TYPE_IFINDEX ||
+          nexthop->type == NEXTHOP_TYPE_IPV4_IFINDEX ||
+          nexthop->type == NEXTHOP_TYPE_IPV6_IFINDEX);
+}
+
+/* Two nexthops are the same group member if resolution would treat them
+ * alike: same type, gateway and, where it is an input, ifindex.
+ */
+static int
+nhg_nexthop_same (struct nexthop *nh1, struct nexthop *nh2)
+{
+  if (nh1->type != nh2->type)
+    return 0;
+
+  switch (nh1->type)
+    {
+    case NEXTHOP_TYPE_IPV4:
+    case NEXTHOP_TYPE_IPV4_IFINDEX:
+      if (!IPV4_ADDR_SAME (&nh1->gate.ipv4, &nh2->gate.ipv4))
+        return 0;
+      break;
+    case NEXTHOP_TYPE_IPV6:
+    case NEXTHOP_TYPE_IPV6_IFINDEX:
+      if (!IPV6_ADDR_SAME (&nh1->gate.ipv6, &nh2->gate.ipv6))
+        return 0;
+      break;
+    default:
+      break;
+    }
+
+  if (nhg_nexthop_has_ifindex (nh1) && nh1->ifindex != nh2->ifindex)
+    return 0;
+
+  return 1;
+}
+
+static u_char
+nhg_class (struct rib *rib)
+{
+  u_char class = 0;
+
+  if (CHECK_FLAG (rib->flags, ZEBRA_FLAG_INTERNAL))
+    class |= NHG_CLASS_INTERNAL;
+  if (rib->type == ZEBRA_ROUTE_STATIC)
+    class |= NHG_CLASS_STATIC;
+  return class;
+}
+
+/* A RIB entry can share a group if at least one of its nexthops is
+ * resolved through the RIB, and none carries per-route state that
+ * changes the outcome of resolution.
+ */
+static int
+nhg_shareable (struct rib *rib)
+{
+  struct nexthop *nexthop;
+  int gates = 0;
+  int num = 0;
+
+  for (nexthop = rib->nexthop; nexthop; nexthop = nexthop->next)
+    {
+      if (CHECK_FLAG (nexthop->flags, NEXTHOP_FLAG_ONLINK) ||
+          CHECK_FLAG (nexthop->flags, NEXTHOP_FLAG_FILTERED))
+        return 0;
+      if (nhg_gate_family (nexthop))
+        gates++;
+      if (++num > UCHAR_MAX)
+        return 0;
+    }
+  return gates;
+}
+
+static unsigned int
+nhg_hash_key (void *arg)
+{
+  struct nhg_entry *nhg = arg;
+  struct nexthop *nexthop;
+  unsigned int key;
+
+  key = jhash_2words (nhg->vrf_id, nhg->class, 0);
+  for (nexthop = nhg->nexthop; nexthop; nexthop = nexthop->next)
+    {
+      key = jhash_1word (nexthop->type, key);
+      switch (nexthop->type)
+        {
+        case NEXTHOP_TYPE_IPV4:
+        case NEXTHOP_TYPE_IPV4_IFINDEX:
+          key = jhash_1word (nexthop->gate.ipv4.s_addr, key);
+          break;
+        case NEXTHOP_TYPE_IPV6:
+        case NEXTHOP_TYPE_IPV6_IFINDEX:
+          key = jhash2 (nexthop->gate.ipv6.s6_addr32, 4, key);
+          break;
+        default:
+          break;
+        }
+      if (nhg_nexthop_has_ifindex (nexthop))
+        key = jhash_1word (nexthop->ifindex, key);
+    }
+  return key;
+}
+
+static int
+nhg_hash_cmp (const void *arg1, const void *arg2)
+{
+  const struct nhg_entry *nhg1 = arg1;
+  const struct nhg_entry *nhg2 = arg2;
+  struct nexthop *nh1, *nh2;
+
+  if (nhg1->vrf_id != nhg2->vrf_id || nhg1->class != nhg2->class)
+    return 0;
+
+  for (nh1 = nhg1->nexthop, nh2 = nhg2->nexthop; nh1 && nh2;
+       nh1 = nh1->next, nh2 = nh2->next)
+    if (!nhg_nexthop_same (nh1, nh2))
+      return 0;
+
+  return (nh1 == NULL && nh2 == NULL);
+}
+
+static void
+nhg_gate_add (struct nhg_entry *nhg, struct nexthop *nexthop)
+{
+  struct route_table *table;
+  struct route_node *rn;
+  struct prefix p;
+
+  nhg_gate_prefix (nexthop, &p);
+  table = nhg_gate_table[family2afi (p.family)];
+  if (!table)
+    table = nhg_gate_table[family2afi (p.family)] = route_table_init ();
+
+  rn = route_node_get (table, &p);
+  if (!rn->info)
+    rn->info = list_new ();
+  else
+    route_unlock_node (rn);
+  listnode_add (rn->info, nhg);
+}
+
+static void
+nhg_gate_del (struct nhg_entry *nhg, struct nexthop *nexthop)
+{
+  struct route_table *table;
+  struct route_node *rn;
+  struct prefix p;
+
+  nhg_gate_prefix (nexthop, &p);
+  table = nhg_gate_table[family2afi (p.family)];
+  if (!table)
+    return;
+
+  rn = route_node_lookup (table, &p);
+  if (!rn)
+    return;
+
+  listnode_delete (rn->info, nhg);
+  if (list_isempty ((struct list *) rn->info))
+    {
+      list_delete (rn->info);
+      rn->info = NULL;
+      route_unlock_node (rn);
+    }
+  route_unlock_node (rn);
+}
+
+/* Copy a resolved chain. Unlike copy_nexthops(), every member of the
+ * chain is copied, not just its head.
+ */
+static void
+nhg_copy_resolved (struct nexthop **target, struct nexthop *resolved)
+{
+  struct nexthop *nh, *nexthop;
+
+  for (nh = resolved; nh; nh = nh->next)
+    {
+      nexthop = nexthop_new ();
+      nexthop->flags = nh->flags;
+      nexthop->type = nh->type;
+      nexthop->ifindex = nh->ifindex;
+      nexthop->gate = nh->gate;
+      nexthop->src = nh->src;
+      nexthop_add (target, nexthop);
+      if (CHECK_FLAG (nh->flags, NEXTHOP_FLAG_RECURSIVE))
+        nhg_copy_resolved (&nexthop->resolved, nh->resolved);
+    }
+}
+
+static void *
+nhg_entry_alloc (void *arg)
+{
+  struct nhg_entry *key = arg;
+  struct nhg_entry *nhg;
+  struct nexthop *nh, *nexthop;
+
+  nhg = XCALLOC (MTYPE_NHG, sizeof (struct nhg_entry));
+  nhg->id = nhg_id_next++;
+  nhg->vrf_id = key->vrf_id;
+  nhg->class = key->class;
+
+  for (nh = key->nexthop; nh; nh = nh->next)
+    {
+      nexthop = nexthop_new ();
+      nexthop->type = nh->type;
+      nexthop->ifindex = nh->ifindex;
+      nexthop->gate = nh->gate;
+      nexthop_add (&nhg->nexthop, nexthop);
+      nhg->nexthop_num++;
+
+      if (nhg_gate_family (nexthop))
+        nhg_gate_add (nhg, nexthop);
+    }
+
+  return nhg;
+}
+
+static void
+nhg_entry_free (struct nhg_entry *nhg)
+{
+  struct nexthop *nexthop;
+
+  for (nexthop = nhg->nexthop; nexthop; nexthop = nexthop->next)
+    if (nhg_gate_family (nexthop))
+      nhg_gate_del (nhg, nexthop);
+
+  nexthops_free (nhg->nexthop);
+  XFREE (MTYPE_NHG, nhg);
+}
+
+/* Make 'rib' reference the group for its current nexthops, creating the
+ * group if needed. The group of an entry whose nexthops changed since it
+ * was attached is replaced. Returns the group, or NULL if the entry
+ * cannot share one.
+ */
+struct nhg_entry *
+zebra_nhg_attach (struct rib *rib)
+{
+  struct nhg_entry lookup;
+  struct nhg_entry *nhg;
+
+  if (!nhg_shareable (rib))
+    {
+      zebra_nhg_release (rib);
+      return NULL;
+    }
+
+  memset (&lookup, 0, sizeof (lookup));
+  lookup.vrf_id = rib->vrf_id;
+  lookup.class = nhg_class (rib);
+  lookup.nexthop = rib->nexthop;
+
+  if (rib->nhg && nhg_hash_cmp (rib->nhg, &lookup))
+    return rib->nhg;
+
+  zebra_nhg_release (rib);
+
+  if (!nhg_hash)
+    nhg_hash = hash_create (nhg_hash_key, nhg_hash_cmp);
+
+  nhg = hash_get (nhg_hash, &lookup, nhg_entry_alloc);
+  nhg->refcnt++;
+  rib->nhg = nhg;
+  return nhg;
+}
+
+/* Drop the reference 'rib' holds on its group. */
+void
+zebra_nhg_release (struct rib *rib)
+{
+  struct nhg_entry *nhg = rib->nhg;
+
+  if (!nhg)
+    return;
+
+  rib->nhg = NULL;
+  if (--nhg->refcnt)
+    return;
+
+  hash_release (nhg_hash, nhg);
+  nhg_entry_free (nhg);
+}
+
+/* Does any gateway of the group lie within 'p'? Resolution of such a
+ * group may depend on which route is being resolved, since a route never
+ * resolves over itself, so the cached result cannot be used for a route
+ * to 'p'.
+ */
+int
+zebra_nhg_covered (struct nhg_entry *nhg, struct prefix *p)
+{
+  struct nexthop *nexthop;
+  struct prefix gate;
+
+  for (nexthop = nhg->nexthop; nexthop; nexthop = nexthop->next)
+    {
+      if (nhg_gate_family (nexthop) != p->family)
+        continue;
+      nhg_gate_prefix (nexthop, &gate);
+      if (prefix_match (p, &gate))
+        return 1;
+    }
+  return 0;
+}
+
+/* Is the outcome of resolving this nexthop kept in the group? */
+int
+zebra_nhg_nexthop_cacheable (struct nexthop *nexthop)
+{
+  return (nhg_gate_family (nexthop) != 0);
+}
+
+/* Apply the resolution cached in the group member 'cached' to the RIB
+ * entry's 'nexthop'. Returns the cached ACTIVE state.
+ */
+int
+zebra_nhg_nexthop_load (struct nexthop *nexthop, struct nexthop *cached)
+{
+  UNSET_FLAG (nexthop->flags, NEXTHOP_FLAG_RECURSIVE);
+  nexthops_free (nexthop->resolved);
+  nexthop->resolved = NULL;
+  nexthop->ifindex = cached->ifindex;
+
+  if (CHECK_FLAG (cached->flags, NEXTHOP_FLAG_RECURSIVE))
+    {
+      SET_FLAG (nexthop->flags, NEXTHOP_FLAG_RECURSIVE);
+      nhg_copy_resolved (&nexthop->resolved, cached->resolved);
+    }
+
+  return CHECK_FLAG (cached->flags, NEXTHOP_FLAG_ACTIVE);
+}
+
+/* Record the resolution just done for 'nexthop' in the group member
+ * 'cached'.
+ */
+void
+zebra_nhg_nexthop_save (struct nexthop *cached, struct nexthop *nexthop,
+                        int active)
+{
+  cached->flags = 0;
+  if (active)
+    SET_FLAG (cached->flags, NEXTHOP_FLAG_ACTIVE);
+  if (CHECK_FLAG (nexthop->flags, NEXTHOP_FLAG_RECURSIVE))
+    SET_FLAG (cached->flags, NEXTHOP_FLAG_RECURSIVE);
+  cached->ifindex = nexthop->ifindex;
+
+  nexthops_free (cached->resolved);
+  cached->resolved = NULL;
+  nhg_copy_resolved (&cached->resolved, nexthop->resolved);
+}
+
+/* The RIB node for 'p' in 'vrf_id' has been processed. Mark the groups
+ * whose gateways may resolve over it for re-resolution.
+ */
+void
+zebra_nhg_invalidate (vrf_id_t vrf_id, struct prefix *p)
+{
+  struct route_table *table;
+  struct route_node *top;
+  struct route_node *rn;
+  struct listnode *node;
+  struct nhg_entry *nhg;
+
+  if (p->family != AF_INET && p->family != AF_INET6)
+    return;
+
+  table = nhg_gate_table[family2afi (p->family)];
+  if (!table || !table->top)
+    return;
+
+  /* Find the root of the subtree covered by 'p', without creating it. */
+  top = table->top;
+  while (top && top->p.prefixlen < p->prefixlen && prefix_match (&top->p, p))
+    top = top->link[prefix_bit (&p->u.prefix, top->p.prefixlen)];
+  if (!top || !prefix_match (p, &top->p))
+    return;
+
+  for (rn = route_lock_node (top); rn; rn = route_next_until (rn, top))
+    {
+      if (!rn->info)
+        continue;
+      for (ALL_LIST_ELEMENTS_RO ((struct list *) rn->info, node, nhg))
+        if (nhg->vrf_id == vrf_id)
+          UNSET_FLAG (nhg->flags, NHG_FLAG_VALID);
+    }
+}
+
+static void
+nhg_invalidate_entry (struct hash_backet *backet, void *arg)
+{
+  struct nhg_entry *nhg = backet->data;
+
+  UNSET_FLAG (nhg->flags, NHG_FLAG_VALID);
+}
+
+/* Mark every group for re-resolution, e.g. when interface state or the
+ * resolve-via-default setting changes.
+ */
+void
+zebra_nhg_invalidate_all (void)
+{
+  if (nhg_hash)
+    hash_iterate (nhg_hash, nhg_invalidate_entry, NULL);
+}
+
+static void
+nhg_print_entry (struct hash_backet *backet, void *arg)
+{
+  struct vty *vty = arg;
+  struct nhg_entry *nhg = backet->data;
+  struct nexthop *nexthop;
+  char buf[INET6_ADDRSTRLEN + 16];
+
+  vty_out (vty, "%-10u %-8u %-8u %-6s ", nhg->id, nhg->refcnt, nhg->vrf_id,
+           CHECK_FLAG (nhg->flags, NHG_FLAG_VALID) ? "yes" : "no");
+  for (nexthop = nhg->nexthop; nexthop; nexthop = nexthop->next)
+    vty_out (vty, "%s%s", nexthop2str (nexthop, buf, sizeof (buf)),
+             nexthop->next ? ", " : "");
+  vty_out (vty, "%s", VTY_NEWLINE);
+}
+
+void
+zebra_nhg_print (struct vty *vty)
+{
+  if (!nhg_hash || !nhg_hash->count)
+    {
+      vty_out (vty, "No nexthop groups%s", VTY_NEWLINE);
+      return;
+    }
+
+  vty_out (vty, "%lu nexthop groups%s", nhg_hash->count, VTY_NEWLINE);
+  vty_out (vty, "%-10s %-8s %-8s %-6s %s%s", "ID", "Refcnt", "VRF", "Valid",
+           "Nexthops", VTY_NEWLINE);
+  hash_iterate (nhg_hash, nhg_print_entry, vty);
+}
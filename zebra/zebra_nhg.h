@@ -0,0 +1,75 @@
+/*
+ * Zebra shared nexthop groups header
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _ZEBRA_NHG_H
+#define _ZEBRA_NHG_H
+
+#include "prefix.h"
+#include "vty.h"
+
+/*
+ * A nexthop group is the interned set of nexthops shared by every RIB
+ * entry in a VRF that uses the same gateways and resolves them the same
+ * way. The group keeps its own copy of those nexthops, which carries the
+ * result of the last recursive resolution (ACTIVE and RECURSIVE flags,
+ * ifindex and the resolved chain), so that resolution is done once per
+ * group rather than once per route.
+ */
+struct nhg_entry
+{
+  /* Identifier, unique for the lifetime of the group */
+  u_int32_t id;
+
+  /* Number of RIB entries referencing this group */
+  u_int32_t refcnt;
+
+  /* VRF identifier. */
+  vrf_id_t vrf_id;
+
+  /* Resolution class of the referencing routes */
+  u_char class;
+#define NHG_CLASS_INTERNAL      0x01    /* ZEBRA_FLAG_INTERNAL routes */
+#define NHG_CLASS_STATIC        0x02    /* ZEBRA_ROUTE_STATIC routes */
+
+  u_char flags;
+#define NHG_FLAG_VALID          0x01    /* cached resolution is current */
+
+  /* Nexthops of the group, carrying the cached resolution */
+  struct nexthop *nexthop;
+  u_char nexthop_num;
+
+  /* MTU of the resolving route, see rib->nexthop_mtu */
+  u_int32_t nexthop_mtu;
+};
+
+extern struct nhg_entry *zebra_nhg_attach (struct rib *rib);
+extern void zebra_nhg_release (struct rib *rib);
+extern int zebra_nhg_covered (struct nhg_entry *nhg, struct prefix *p);
+extern int zebra_nhg_nexthop_cacheable (struct nexthop *nexthop);
+extern int zebra_nhg_nexthop_load (struct nexthop *nexthop,
+                                   struct nexthop *cached);
+extern void zebra_nhg_nexthop_save (struct nexthop *cached,
+                                    struct nexthop *nexthop, int active);
+extern void zebra_nhg_invalidate (vrf_id_t vrf_id, struct prefix *p);
+extern void zebra_nhg_invalidate_all (void);
+extern void zebra_nhg_print (struct vty *vty);
+
+#endif /* _ZEBRA_NHG_H */
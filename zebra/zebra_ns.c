@@ -27,6 +27,7 @@
 #include "lib/memory.h"
 
 #include "rtadv.h"
+#include "zserv.h"
 #include "zebra_ns.h"
 #include "zebra_vrf.h"
 #include "zebra_memory.h"
@@ -46,6 +47,7 @@ int
 zebra_ns_enable (ns_id_t ns_id, void **info)
 {
   struct zebra_ns *zns = (struct zebra_ns *) (*info);
+  struct timeval start;
 #ifdef HAVE_NETLINK
   char nl_name[64];
 #endif
@@ -66,8 +68,14 @@ zebra_ns_enable (ns_id_t ns_id, void **info)
 #endif
   zns->if_table = route_table_init ();
   kernel_init (zns);
+
+  zebra_startup_phase_begin (&start);
   interface_list (zns);
+  zebra_startup_phase_end (ZEBRA_STARTUP_INTERFACES, &start);
+
+  zebra_startup_phase_begin (&start);
   route_read (zns);
+  zebra_startup_phase_end (ZEBRA_STARTUP_KERNEL_ROUTES, &start);
 
   return 0;
 }
@@ -38,6 +38,8 @@
 #include "nexthop.h"
 #include "vrf.h"
 #include "mpls.h"
+#include "hash.h"
+#include "jhash.h"
 
 #include "zebra/rib.h"
 #include "zebra/rt.h"
@@ -49,10 +51,13 @@
 #include "zebra/debug.h"
 #include "zebra/zebra_fpm.h"
 #include "zebra/zebra_rnh.h"
+#include "zebra/zebra_nhg.h"
 #include "zebra/interface.h"
 #include "zebra/connected.h"
 #include "zebra/zebra_vxlan.h"
 
+DEFINE_MTYPE_STATIC(ZEBRA, RIB_IFINDEX, "RIB interface index")
+
 /* Should we allow non Quagga processes to delete our routes */
 extern int allow_delete;
 
@@ -1047,9 +1052,50 @@ rib_lookup_ipv4_route (struct prefix_ipv4 *p, union sockunion * qgate,
  * The return value is the final value of 'ACTIVE' flag.
  */
 
+/* Resolve a gateway nexthop through the RIB. If 'cached' is given, it is
+ * the member of the RIB entry's nexthop group matching 'nexthop': with
+ * 'use_cached' set, its resolution is applied instead of doing a lookup,
+ * otherwise the resolution done here is stored in it for the other
+ * entries of the group. Without 'set', only what a lookup would have
+ * updated (ACTIVE state and ifindex) is taken from the group.
+ */
+static int
+nexthop_active_resolve (struct route_node *rn, struct rib *rib,
+			struct nexthop *nexthop, int set,
+			struct nexthop *cached, int use_cached)
+{
+  int active;
+
+  if (cached && use_cached && !set)
+    {
+      nexthop->ifindex = cached->ifindex;
+      return CHECK_FLAG (cached->flags, NEXTHOP_FLAG_ACTIVE);
+    }
+
+  if (cached && use_cached)
+    {
+      active = zebra_nhg_nexthop_load (nexthop, cached);
+      if (CHECK_FLAG (nexthop->flags, NEXTHOP_FLAG_RECURSIVE) &&
+	  CHECK_FLAG (rib->flags, ZEBRA_FLAG_INTERNAL))
+	SET_FLAG (rib->status, RIB_ENTRY_NEXTHOPS_CHANGED);
+      return active;
+    }
+
+  if (nexthop->type == NEXTHOP_TYPE_IPV4 ||
+      nexthop->type == NEXTHOP_TYPE_IPV4_IFINDEX)
+    active = nexthop_active_ipv4 (rib, nexthop, set, rn);
+  else
+    active = nexthop_active_ipv6 (rib, nexthop, set, rn);
+
+  if (cached)
+    zebra_nhg_nexthop_save (cached, nexthop, active);
+  return active;
+}
+
 static unsigned
 nexthop_active_check (struct route_node *rn, struct rib *rib,
-		      struct nexthop *nexthop, int set)
+		      struct nexthop *nexthop, int set,
+		      struct nexthop *cached, int use_cached)
 {
   rib_table_info_t *info = rn->table->info;
   struct interface *ifp;
@@ -1075,14 +1121,14 @@ nexthop_active_check (struct route_node *rn, struct rib *rib,
     case NEXTHOP_TYPE_IPV4:
     case NEXTHOP_TYPE_IPV4_IFINDEX:
       family = AFI_IP;
-      if (nexthop_active_ipv4 (rib, nexthop, set, rn))
+      if (nexthop_active_resolve (rn, rib, nexthop, set, cached, use_cached))
 	SET_FLAG (nexthop->flags, NEXTHOP_FLAG_ACTIVE);
       else
 	UNSET_FLAG (nexthop->flags, NEXTHOP_FLAG_ACTIVE);
       break;
     case NEXTHOP_TYPE_IPV6:
       family = AFI_IP6;
-      if (nexthop_active_ipv6 (rib, nexthop, set, rn))
+      if (nexthop_active_resolve (rn, rib, nexthop, set, cached, use_cached))
 	SET_FLAG (nexthop->flags, NEXTHOP_FLAG_ACTIVE);
       else
 	UNSET_FLAG (nexthop->flags, NEXTHOP_FLAG_ACTIVE);
@@ -1101,7 +1147,8 @@ nexthop_active_check (struct route_node *rn, struct rib *rib,
 	}
       else
 	{
-	  if (nexthop_active_ipv6 (rib, nexthop, set, rn))
+	  if (nexthop_active_resolve (rn, rib, nexthop, set, cached,
+				      use_cached))
 	    SET_FLAG (nexthop->flags, NEXTHOP_FLAG_ACTIVE);
 	  else
 	    UNSET_FLAG (nexthop->flags, NEXTHOP_FLAG_ACTIVE);
@@ -1151,12 +1198,311 @@ nexthop_active_check (struct route_node *rn, struct rib *rib,
   return CHECK_FLAG (nexthop->flags, NEXTHOP_FLAG_ACTIVE);
 }
 
+/* Whether an interface event leaves the route to be reprocessed by the
+ * protocol that owns it or by nexthop evaluation (NHT). That is the case
+ * for routes of protocols, and for static routes whose nexthops are all
+ * gateways. Other routes - system, kernel and the remaining static
+ * routes - are examined by zebra. Note that NHT will get triggered upon
+ * an interface event as connected routes always get queued for
+ * processing.
+ */
+static int
+rib_update_if_change_skip (struct rib *rib)
+{
+  struct nexthop *nh;
+
+  if (rib->type == ZEBRA_ROUTE_OSPF ||
+      rib->type == ZEBRA_ROUTE_OSPF6 ||
+      rib->type == ZEBRA_ROUTE_BGP)
+    return 1; /* protocol will handle. */
+
+  if (rib->type == ZEBRA_ROUTE_STATIC)
+    {
+      for (nh = rib->nexthop; nh; nh = nh->next)
+        if (!(nh->type == NEXTHOP_TYPE_IPV4 ||
+              nh->type == NEXTHOP_TYPE_IPV6))
+          break;
+
+      /* If we only have nexthops to a gateway, NHT will take care. */
+      if (!nh)
+        return 1;
+    }
+
+  return 0;
+}
+
+/*
+ * Reverse index from an interface to the route nodes holding RIB entries
+ * that an event on the interface can affect, see rib_update_interface().
+ * An entry is filed under the ifindex of each of its nexthops and of the
+ * nexthops those resolve to, and under IFINDEX_INTERNAL while it has an
+ * inactive nexthop without an interface, which may come to resolve over
+ * any interface. The index is kept up to date by nexthop_active_update().
+ * Entries left to their protocol or to NHT are not indexed.
+ */
+struct rib_ifindex
+{
+  ifindex_t ifindex;
+
+  /* struct rib_ifindex_node */
+  struct hash *nodes;
+};
+
+struct rib_ifindex_node
+{
+  struct route_node *rn;
+
+  /* Number of RIB entries of the node filed under the ifindex */
+  unsigned int refcnt;
+};
+
+static struct hash *rib_ifindex_table;
+
+static unsigned int
+rib_ifindex_hash_key (void *arg)
+{
+  struct rib_ifindex *rif = arg;
+
+  return jhash_1word (rif->ifindex, 0);
+}
+
+static int
+rib_ifindex_hash_cmp (const void *arg1, const void *arg2)
+{
+  const struct rib_ifindex *rif1 = arg1;
+  const struct rib_ifindex *rif2 = arg2;
+
+  return rif1->ifindex == rif2->ifindex;
+}
+
+static unsigned int
+rib_ifindex_node_hash_key (void *arg)
+{
+  struct rib_ifindex_node *node = arg;
+
+  return jhash (&node->rn, sizeof (node->rn), 0);
+}
+
+static int
+rib_ifindex_node_hash_cmp (const void *arg1, const void *arg2)
+{
+  const struct rib_ifindex_node *node1 = arg1;
+  const struct rib_ifindex_node *node2 = arg2;
+
+  return node1->rn == node2->rn;
+}
+
+static void *
+rib_ifindex_alloc (void *arg)
+{
+  struct rib_ifindex *rif;
+
+  rif = XCALLOC (MTYPE_RIB_IFINDEX, sizeof (struct rib_ifindex));
+  rif->ifindex = ((struct rib_ifindex *) arg)->ifindex;
+  rif->nodes = hash_create (rib_ifindex_node_hash_key,
+                            rib_ifindex_node_hash_cmp);
+  return rif;
+}
+
+static void *
+rib_ifindex_node_alloc (void *arg)
+{
+  struct rib_ifindex_node *node;
+
+  node = XCALLOC (MTYPE_RIB_IFINDEX, sizeof (struct rib_ifindex_node));
+  node->rn = ((struct rib_ifindex_node *) arg)->rn;
+  return node;
+}
+
+static void
+rib_ifindex_ref (ifindex_t ifindex, struct route_node *rn)
+{
+  struct rib_ifindex lookup;
+  struct rib_ifindex_node node_lookup;
+  struct rib_ifindex *rif;
+  struct rib_ifindex_node *node;
+
+  if (!rib_ifindex_table)
+    rib_ifindex_table = hash_create (rib_ifindex_hash_key,
+                                     rib_ifindex_hash_cmp);
+
+  lookup.ifindex = ifindex;
+  rif = hash_get (rib_ifindex_table, &lookup, rib_ifindex_alloc);
+  node_lookup.rn = rn;
+  node = hash_get (rif->nodes, &node_lookup, rib_ifindex_node_alloc);
+  node->refcnt++;
+}
+
+static void
+rib_ifindex_unref (ifindex_t ifindex, struct route_node *rn)
+{
+  struct rib_ifindex lookup;
+  struct rib_ifindex_node node_lookup;
+  struct rib_ifindex *rif;
+  struct rib_ifindex_node *node;
+
+  if (!rib_ifindex_table)
+    return;
+
+  lookup.ifindex = ifindex;
+  if (!(rif = hash_lookup (rib_ifindex_table, &lookup)))
+    return;
+  node_lookup.rn = rn;
+  if (!(node = hash_lookup (rif->nodes, &node_lookup)))
+    return;
+
+  if (--node->refcnt)
+    return;
+
+  hash_release (rif->nodes, node);
+  XFREE (MTYPE_RIB_IFINDEX, node);
+
+  if (!hashcount (rif->nodes))
+    {
+      hash_release (rib_ifindex_table, rif);
+      hash_free (rif->nodes);
+      XFREE (MTYPE_RIB_IFINDEX, rif);
+    }
+}
+
+/* Buffer for the interfaces of the entry being updated */
+static ifindex_t *rib_ifindex_ids;
+static unsigned int rib_ifindex_ids_size;
+
+/* Collect the sorted set of interfaces a RIB entry is to be filed under,
+ * see struct rib_ifindex, into rib_ifindex_ids. Returns its size.
+ */
+static unsigned int
+rib_ifindex_collect (struct rib *rib)
+{
+  struct nexthop *nexthop, *tnexthop;
+  int recursing;
+  unsigned int num = 0;
+  unsigned int i;
+  ifindex_t ifindex;
+
+  for (ALL_NEXTHOPS_RO(rib->nexthop, nexthop, tnexthop, recursing))
+    {
+      ifindex = nexthop->ifindex;
+      if (ifindex == IFINDEX_INTERNAL
+          && (recursing || CHECK_FLAG (nexthop->flags, NEXTHOP_FLAG_ACTIVE)))
+        continue;
+
+      for (i = 0; i < num && rib_ifindex_ids[i] < ifindex; i++)
+        ;
+      if (i < num && rib_ifindex_ids[i] == ifindex)
+        continue;
+
+      if (num == rib_ifindex_ids_size)
+        {
+          rib_ifindex_ids_size = num ? num * 2 : 16;
+          rib_ifindex_ids = XREALLOC (MTYPE_RIB_IFINDEX, rib_ifindex_ids,
+                                      rib_ifindex_ids_size
+                                      * sizeof (ifindex_t));
+        }
+      memmove (&rib_ifindex_ids[i + 1], &rib_ifindex_ids[i],
+               (num - i) * sizeof (ifindex_t));
+      rib_ifindex_ids[i] = ifindex;
+      num++;
+    }
+
+  return num;
+}
+
+/* File the RIB entry under the interfaces its nexthops now use. A static
+ * route left with only gateway nexthops drops out of the index.
+ */
+static void
+rib_ifindex_update (struct route_node *rn, struct rib *rib)
+{
+  ifindex_t *ids;
+  unsigned int num = 0;
+  unsigned int i, j;
+
+  if (!rib_update_if_change_skip (rib))
+    num = rib_ifindex_collect (rib);
+  ids = rib_ifindex_ids;
+
+  if (num == rib->ifindex_num
+      && (!num || !memcmp (ids, rib->ifindexes, num * sizeof (ifindex_t))))
+    return;
+
+  /* Move the entry from the interfaces it no longer uses to the new ones */
+  for (i = j = 0; i < rib->ifindex_num || j < num; )
+    {
+      if (j == num || (i < rib->ifindex_num && rib->ifindexes[i] < ids[j]))
+        rib_ifindex_unref (rib->ifindexes[i++], rn);
+      else if (i == rib->ifindex_num || ids[j] < rib->ifindexes[i])
+        rib_ifindex_ref (ids[j++], rn);
+      else
+        i++, j++;
+    }
+
+  if (num)
+    {
+      rib->ifindexes = XREALLOC (MTYPE_RIB_IFINDEX, rib->ifindexes,
+                                 num * sizeof (ifindex_t));
+      memcpy (rib->ifindexes, ids, num * sizeof (ifindex_t));
+    }
+  else if (rib->ifindexes)
+    XFREE (MTYPE_RIB_IFINDEX, rib->ifindexes);
+  rib->ifindex_num = num;
+}
+
+/* Drop the RIB entry from the interface index. */
+static void
+rib_ifindex_release (struct route_node *rn, struct rib *rib)
+{
+  unsigned int i;
+
+  for (i = 0; i < rib->ifindex_num; i++)
+    rib_ifindex_unref (rib->ifindexes[i], rn);
+  if (rib->ifindexes)
+    XFREE (MTYPE_RIB_IFINDEX, rib->ifindexes);
+  rib->ifindex_num = 0;
+}
+
+static void
+rib_ifindex_queue_node (struct hash_backet *backet, void *arg)
+{
+  struct rib_ifindex_node *node = backet->data;
+
+  rib_queue_add (node->rn);
+}
+
+/* Schedule the route nodes filed under the interface. */
+static void
+rib_ifindex_queue (ifindex_t ifindex)
+{
+  struct rib_ifindex lookup;
+  struct rib_ifindex *rif;
+
+  if (!rib_ifindex_table)
+    return;
+
+  lookup.ifindex = ifindex;
+  if (!(rif = hash_lookup (rib_ifindex_table, &lookup)))
+    return;
+
+  if (IS_ZEBRA_DEBUG_RIB_DETAILED)
+    zlog_debug ("ifindex %d: scheduling %lu route nodes for processing",
+                ifindex, hashcount (rif->nodes));
+
+  hash_iterate (rif->nodes, rib_ifindex_queue_node, NULL);
+}
+
 /* Iterate over all nexthops of the given RIB entry and refresh their
  * ACTIVE flag. rib->nexthop_active_num is updated accordingly. If any
  * nexthop is found to toggle the ACTIVE flag, the whole rib structure
  * is flagged with RIB_ENTRY_CHANGED. The 4th 'set' argument is
  * transparently passed to nexthop_active_check().
  *
+ * The entry is attached to its shared nexthop group. Gateway resolution
+ * is then taken from the group if it is still valid. Otherwise, when
+ * 'set' is non-zero, it is done here and stored in the group. A group
+ * whose gateways lie within the entry's own prefix is resolved per
+ * entry, as a route never resolves over itself.
+ *
  * Return value is the new number of active nexthops.
  */
 
@@ -1164,6 +1510,9 @@ static int
 nexthop_active_update (struct route_node *rn, struct rib *rib, int set)
 {
   struct nexthop *nexthop;
+  struct nhg_entry *nhg = NULL;
+  struct nexthop *cached = NULL;
+  int use_cached = 0;
   union g_addr prev_src;
   unsigned int prev_active, new_active, old_num_nh;
   ifindex_t prev_index;
@@ -1172,13 +1521,29 @@ nexthop_active_update (struct route_node *rn, struct rib *rib, int set)
   rib->nexthop_active_num = 0;
   UNSET_FLAG (rib->status, RIB_ENTRY_CHANGED);
 
+  if ((nhg = zebra_nhg_attach (rib)) != NULL)
+    {
+      use_cached = CHECK_FLAG (nhg->flags, NHG_FLAG_VALID);
+      /* Without 'set' there is no resolved chain to store in the group */
+      if (zebra_nhg_covered (nhg, &rn->p) || (!set && !use_cached))
+	nhg = NULL;
+      else
+	cached = nhg->nexthop;
+    }
+
   for (nexthop = rib->nexthop; nexthop; nexthop = nexthop->next)
   {
     /* No protocol daemon provides src and so we're skipping tracking it */
     prev_src = nexthop->rmap_src;
     prev_active = CHECK_FLAG (nexthop->flags, NEXTHOP_FLAG_ACTIVE);
     prev_index = nexthop->ifindex;
-    if ((new_active = nexthop_active_check (rn, rib, nexthop, set)))
+    new_active = nexthop_active_check (rn, rib, nexthop, set,
+				       (cached &&
+					zebra_nhg_nexthop_cacheable (nexthop)) ?
+				       cached : NULL, use_cached);
+    if (cached)
+      cached = cached->next;
+    if (new_active)
       rib->nexthop_active_num++;
     /* Don't allow src setting on IPv6 addr for now */
     if (prev_active != new_active ||
@@ -1195,6 +1560,17 @@ nexthop_active_update (struct route_node *rn, struct rib *rib, int set)
       }
   }
 
+  if (nhg && set)
+    {
+      if (use_cached)
+	rib->nexthop_mtu = nhg->nexthop_mtu;
+      else
+	{
+	  nhg->nexthop_mtu = rib->nexthop_mtu;
+	  SET_FLAG (nhg->flags, NHG_FLAG_VALID);
+	}
+    }
+
   if (old_num_nh != rib->nexthop_active_num)
     SET_FLAG (rib->status, RIB_ENTRY_CHANGED);
 
@@ -1203,6 +1579,8 @@ nexthop_active_update (struct route_node *rn, struct rib *rib, int set)
       SET_FLAG (rib->status, RIB_ENTRY_NEXTHOPS_CHANGED);
     }
 
+  rib_ifindex_update (rn, rib);
+
   return rib->nexthop_active_num;
 }
 
@@ -1354,6 +1732,8 @@ rib_gc_dest (struct route_node *rn)
   if (IS_ZEBRA_DEBUG_RIB)
     rnode_debug (rn, zvrf->vrf_id, "removing dest from table");
 
+  zfpm_dest_deleted (rn);
+
   dest->rnode = NULL;
   XFREE (MTYPE_RIB_DEST, dest);
   rn->info = NULL;
@@ -1993,6 +2373,18 @@ rib_process (struct route_node *rn)
         }
     }
 
+  /*
+   * Queue the tracked nexthops that may resolve over this node for
+   * evaluation once the meta queue drains.
+   */
+  if (zvrf && rib_table_info (rib_dest_table (dest))->safi == SAFI_UNICAST)
+    {
+      zebra_rnh_mark_dependents (vrf_id, &rn->p);
+      zebra_nhg_invalidate (vrf_id, &rn->p);
+      if (vrf_id == VRF_DEFAULT)
+        zebra_mpls_lsp_mark_dependents (zvrf, &rn->p);
+    }
+
   /*
    * Check if the dest can be deleted now.
    */
@@ -2054,9 +2446,9 @@ meta_queue_process_complete (struct work_queue *dummy)
   vrf_iter_t iter;
   struct zebra_vrf *zvrf;
 
-  /* Evaluate nexthops for those VRFs which underwent route processing. This
-   * should limit the evaluation to the necessary VRFs in most common
-   * situations.
+  /* Evaluate nexthops for those VRFs which underwent route processing. Only
+   * the entries that rib_process() marked as possibly resolving over a
+   * processed node are looked at.
    */
   for (iter = vrf_first (); iter != VRF_ITER_INVALID; iter = vrf_next (iter))
     {
@@ -2064,22 +2456,26 @@ meta_queue_process_complete (struct work_queue *dummy)
           (zvrf->flags & ZEBRA_VRF_RIB_SCHEDULED))
         {
           zvrf->flags &= ~ZEBRA_VRF_RIB_SCHEDULED;
-          zebra_evaluate_rnh(zvrf->vrf_id, AF_INET, 0, RNH_NEXTHOP_TYPE, NULL);
-          zebra_evaluate_rnh(zvrf->vrf_id, AF_INET, 0, RNH_IMPORT_CHECK_TYPE, NULL);
-          zebra_evaluate_rnh(zvrf->vrf_id, AF_INET6, 0, RNH_NEXTHOP_TYPE, NULL);
-          zebra_evaluate_rnh(zvrf->vrf_id, AF_INET6, 0, RNH_IMPORT_CHECK_TYPE, NULL);
+          zebra_evaluate_dirty_rnh(zvrf->vrf_id, AF_INET, RNH_NEXTHOP_TYPE);
+          zebra_evaluate_dirty_rnh(zvrf->vrf_id, AF_INET, RNH_IMPORT_CHECK_TYPE);
+          zebra_evaluate_dirty_rnh(zvrf->vrf_id, AF_INET6, RNH_NEXTHOP_TYPE);
+          zebra_evaluate_dirty_rnh(zvrf->vrf_id, AF_INET6, RNH_IMPORT_CHECK_TYPE);
         }
     }
 
-  /* Schedule LSPs for processing, if needed. */
+  /* Schedule the LSPs whose nexthops resolve over a processed node. */
   zvrf = vrf_info_lookup(VRF_DEFAULT);
   if (mpls_should_lsps_be_processed(zvrf))
     {
-      if (IS_ZEBRA_DEBUG_MPLS)
-        zlog_debug ("%u: Scheduling all LSPs upon RIB completion", zvrf->vrf_id);
-      zebra_mpls_lsp_schedule (zvrf);
+      zebra_mpls_lsp_schedule_dirty (zvrf);
       mpls_unmark_lsps_for_processing(zvrf);
     }
+
+  if (zebrad.startup_rib_pending && !zebrad.mq->size)
+    {
+      zebra_startup_phase_end (ZEBRA_STARTUP_RIB, &zebrad.startup_rib_begin);
+      zebrad.startup_rib_pending = 0;
+    }
 }
 
 /* Dispatch the meta queue by picking, processing and unlocking the next RN from
@@ -2374,6 +2770,8 @@ rib_unlink (struct route_node *rn, struct rib *rib)
 
   /* free RIB and nexthops */
   zebra_deregister_rnh_static_nexthops (rib->vrf_id, rib->nexthop, rn);
+  zebra_nhg_release (rib);
+  rib_ifindex_release (rn, rib);
   nexthops_free(rib->nexthop);
   XFREE (MTYPE_RIB, rib);
 
@@ -2946,35 +3344,9 @@ rib_update_table (struct route_table *table, rib_update_event_t event)
       switch (event)
         {
         case RIB_UPDATE_IF_CHANGE:
-          /* Examine all routes that won't get processed by the protocol or
-           * triggered by nexthop evaluation (NHT). This would be system,
-           * kernel and certain static routes. Note that NHT will get
-           * triggered upon an interface event as connected routes always
-           * get queued for processing.
-           */
           RNODE_FOREACH_RIB_SAFE (rn, rib, next)
-            {
-              if (rib->type == ZEBRA_ROUTE_OSPF ||
-                  rib->type == ZEBRA_ROUTE_OSPF6 ||
-                  rib->type == ZEBRA_ROUTE_BGP)
-                continue; /* protocol will handle. */
-              else if (rib->type == ZEBRA_ROUTE_STATIC)
-                {
-                  struct nexthop *nh;
-                  for (nh = rib->nexthop; nh; nh = nh->next)
-                    if (!(nh->type == NEXTHOP_TYPE_IPV4 ||
-                        nh->type == NEXTHOP_TYPE_IPV6))
-                      break;
-
-                  /* If we only have nexthops to a gateway, NHT will
-                   * take care.
-                   */
-                  if (nh)
-                    rib_queue_add (rn);
-                }
-              else
-                  rib_queue_add (rn);
-            }
+            if (!rib_update_if_change_skip (rib))
+              rib_queue_add (rn);
           break;
 
         case RIB_UPDATE_RMAP_CHANGE:
@@ -2998,6 +3370,9 @@ rib_update (vrf_id_t vrf_id, rib_update_event_t event)
 {
   struct route_table *table;
 
+  /* Interface state feeds into nexthop resolution */
+  zebra_nhg_invalidate_all ();
+
   /* Process routes of interested address-families. */
   table = zebra_vrf_table (AFI_IP, SAFI_UNICAST, vrf_id);
   if (table)
@@ -3008,6 +3383,19 @@ rib_update (vrf_id_t vrf_id, rib_update_event_t event)
     rib_update_table (table, event);
 }
 
+/* RIB update for a change of state or addresses of an interface, which
+ * is limited to the routes filed under the interface in the interface
+ * index, and those with a nexthop yet to be resolved.
+ */
+void
+rib_update_interface (struct interface *ifp)
+{
+  zebra_nhg_invalidate_all ();
+
+  rib_ifindex_queue (ifp->ifindex);
+  rib_ifindex_queue (IFINDEX_INTERNAL);
+}
+
 /* Remove all routes which comes from non main table.  */
 static void
 rib_weed_table (struct route_table *table)
@@ -92,6 +92,21 @@ static inline struct route_table *get_rnh_table(vrf_id_t vrfid, int family,
   return t;
 }
 
+static inline struct rnh_queue *get_rnh_dirty_queue(struct zebra_vrf *zvrf,
+                                                    int family,
+                                                    rnh_type_t type)
+{
+  switch (type)
+    {
+    case RNH_NEXTHOP_TYPE:
+      return &zvrf->rnh_dirty[family2afi(family)];
+    case RNH_IMPORT_CHECK_TYPE:
+      return &zvrf->import_check_dirty[family2afi(family)];
+    }
+
+  return NULL;
+}
+
 char *rnh_str (struct rnh *rnh, char *buf, int size)
 {
   prefix2str(&(rnh->node->p), buf, size);
@@ -179,6 +194,14 @@ zebra_delete_rnh (struct rnh *rnh, rnh_type_t type)
     }
 
   rnh->flags |= ZEBRA_NHT_DELETED;
+  if (rnh->flags & ZEBRA_NHT_DIRTY)
+    {
+      struct zebra_vrf *zvrf = zebra_vrf_lookup(rnh->vrf_id);
+
+      if (zvrf)
+        TAILQ_REMOVE (get_rnh_dirty_queue(zvrf, rn->p.family, type),
+                      rnh, dirty_entry);
+    }
   list_free(rnh->client_list);
   list_free(rnh->zebra_static_route_list);
   free_state(rnh->vrf_id, rnh->state, rn);
@@ -754,6 +777,108 @@ zebra_evaluate_rnh (vrf_id_t vrfid, int family, int force, rnh_type_t type,
     }
 }
 
+/*
+ * Queue the tracked entries of one type that may resolve over the RIB
+ * node for prefix 'p'. Resolution is by longest match, so these can only
+ * be the entries at or below 'p' in the tracking table. Of those, a
+ * nexthop already resolved over a more specific route than 'p' is not
+ * affected by a change to 'p' and is skipped.
+ */
+static void
+zebra_rnh_mark_subtree (struct zebra_vrf *zvrf, struct prefix *p,
+                        rnh_type_t type)
+{
+  struct route_table *table;
+  struct rnh_queue *queue;
+  struct route_node *top;
+  struct route_node *nrn;
+  struct rnh *rnh;
+
+  table = get_rnh_table(zvrf->vrf_id, p->family, type);
+  if (!table || !table->top)
+    return;
+
+  queue = get_rnh_dirty_queue(zvrf, p->family, type);
+
+  /* Find the root of the subtree covered by 'p', without creating it. */
+  top = table->top;
+  while (top && top->p.prefixlen < p->prefixlen && prefix_match(&top->p, p))
+    top = top->link[prefix_bit(&p->u.prefix, top->p.prefixlen)];
+  if (!top || !prefix_match(p, &top->p))
+    return;
+
+  for (nrn = route_lock_node(top); nrn; nrn = route_next_until(nrn, top))
+    {
+      rnh = nrn->info;
+      if (!rnh || (rnh->flags & ZEBRA_NHT_DIRTY))
+        continue;
+
+      if ((type == RNH_NEXTHOP_TYPE) && rnh->state &&
+          (rnh->resolved_route.prefixlen > p->prefixlen))
+        continue;
+
+      rnh->flags |= ZEBRA_NHT_DIRTY;
+      TAILQ_INSERT_TAIL (queue, rnh, dirty_entry);
+    }
+}
+
+/* Mark the tracked entries (nexthops and routes for import) that may
+ * be affected by processing of the RIB node for 'p'.
+ */
+void
+zebra_rnh_mark_dependents (vrf_id_t vrfid, struct prefix *p)
+{
+  struct zebra_vrf *zvrf;
+
+  if (p->family != AF_INET && p->family != AF_INET6)
+    return;
+
+  zvrf = zebra_vrf_lookup(vrfid);
+  if (!zvrf)
+    return;
+
+  zebra_rnh_mark_subtree (zvrf, p, RNH_NEXTHOP_TYPE);
+  zebra_rnh_mark_subtree (zvrf, p, RNH_IMPORT_CHECK_TYPE);
+}
+
+/* Evaluate the tracked entries of a VRF and address-family that were
+ * marked by zebra_rnh_mark_dependents() since the last call.
+ */
+void
+zebra_evaluate_dirty_rnh (vrf_id_t vrfid, int family, rnh_type_t type)
+{
+  struct zebra_vrf *zvrf;
+  struct rnh_queue *queue;
+  struct rnh *rnh;
+  unsigned int count = 0;
+
+  zvrf = zebra_vrf_lookup(vrfid);
+  if (!zvrf)
+    return;
+
+  queue = get_rnh_dirty_queue(zvrf, family, type);
+
+  TAILQ_FOREACH (rnh, queue, dirty_entry)
+    {
+      zebra_rnh_evaluate_entry (vrfid, family, 0, type, rnh->node);
+      count++;
+    }
+
+  /* As in zebra_evaluate_rnh(), flags are cleared only after every
+   * entry has been evaluated.
+   */
+  while ((rnh = TAILQ_FIRST (queue)) != NULL)
+    {
+      TAILQ_REMOVE (queue, rnh, dirty_entry);
+      rnh->flags &= ~ZEBRA_NHT_DIRTY;
+      zebra_rnh_clear_nhc_flag (vrfid, family, type, rnh->node);
+    }
+
+  if (IS_ZEBRA_DEBUG_NHT && count)
+    zlog_debug("%u: Evaluated %u dirty RNH entries, family %d type %d",
+               vrfid, count, family, type);
+}
+
 void
 zebra_print_rnh_table (vrf_id_t vrfid, int af, struct vty *vty, rnh_type_t type)
 {
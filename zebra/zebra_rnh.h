@@ -25,6 +25,7 @@
 
 #include "prefix.h"
 #include "vty.h"
+#include "queue.h"
 
 /* Nexthop structure. */
 struct rnh
@@ -34,6 +35,7 @@ struct rnh
 #define ZEBRA_NHT_CONNECTED  	0x1
 #define ZEBRA_NHT_DELETED       0x2
 #define ZEBRA_NHT_EXACT_MATCH   0x4
+#define ZEBRA_NHT_DIRTY         0x8
 
   /* VRF identifier. */
   vrf_id_t vrf_id;
@@ -44,6 +46,9 @@ struct rnh
   struct list *zebra_static_route_list; /* static routes dependent on this NH */
   struct route_node *node;
   int filtered[ZEBRA_ROUTE_MAX]; /* if this has been filtered for client */
+
+  /* Linkage on the VRF queue of entries awaiting re-evaluation */
+  TAILQ_ENTRY (rnh) dirty_entry;
 };
 
 typedef enum
@@ -70,6 +75,8 @@ extern void zebra_remove_rnh_client(struct rnh *rnh, struct zserv *client,
 				    rnh_type_t type);
 extern void zebra_evaluate_rnh(vrf_id_t vrfid, int family, int force, rnh_type_t type,
 			      struct prefix *p);
+extern void zebra_rnh_mark_dependents(vrf_id_t vrfid, struct prefix *p);
+extern void zebra_evaluate_dirty_rnh(vrf_id_t vrfid, int family, rnh_type_t type);
 extern void zebra_print_rnh_table(vrf_id_t vrfid, int family, struct vty *vty, rnh_type_t);
 extern char *rnh_str(struct rnh *rnh, char *buf, int size);
 extern int zebra_cleanup_rnh_client(vrf_id_t vrf, int family, struct zserv *client,
@@ -30,6 +30,12 @@ void zebra_evaluate_rnh (vrf_id_t vrfid, int family, int force, rnh_type_t type,
 		        struct prefix *p)
 {}
 
+void zebra_rnh_mark_dependents (vrf_id_t vrfid, struct prefix *p)
+{}
+
+void zebra_evaluate_dirty_rnh (vrf_id_t vrfid, int family, rnh_type_t type)
+{}
+
 void zebra_print_rnh_table (vrf_id_t vrfid, int family, struct vty *vty,
 			    rnh_type_t type)
 {}
@@ -326,6 +326,11 @@ zebra_vrf_alloc (vrf_id_t vrf_id, const char *name)
   zvrf->import_check_table[AFI_IP] = route_table_init();
   zvrf->import_check_table[AFI_IP6] = route_table_init();
 
+  TAILQ_INIT (&zvrf->rnh_dirty[AFI_IP]);
+  TAILQ_INIT (&zvrf->rnh_dirty[AFI_IP6]);
+  TAILQ_INIT (&zvrf->import_check_dirty[AFI_IP]);
+  TAILQ_INIT (&zvrf->import_check_dirty[AFI_IP6]);
+
   /* Set VRF ID */
   zvrf->vrf_id = vrf_id;
 
@@ -25,6 +25,12 @@
 
 #include <zebra/zebra_ns.h>
 
+/* Queue of tracked entries (struct rnh) awaiting re-evaluation */
+TAILQ_HEAD (rnh_queue, rnh);
+
+/* Queue of MPLS LSPs (zebra_lsp_t) awaiting processing */
+TAILQ_HEAD (lsp_queue, zebra_lsp_t_);
+
 /* Routing table instance.  */
 struct zebra_vrf
 {
@@ -58,6 +64,12 @@ struct zebra_vrf
   /* Import check table (used mostly by BGP */
   struct route_table *import_check_table[AFI_MAX];
 
+  /* Entries of the two tables above that may resolve over a RIB node
+   * processed since the last evaluation.
+   */
+  struct rnh_queue rnh_dirty[AFI_MAX];
+  struct rnh_queue import_check_dirty[AFI_MAX];
+
   /* Routing tables off of main table for redistribute table */
   struct route_table *other_table[AFI_MAX][ZEBRA_KERNEL_TABLE_MAX];
 
@@ -90,6 +102,10 @@ struct zebra_vrf
   /* MPLS label forwarding table */
   struct hash *lsp_table;
 
+  /* NHLFEs by nexthop address, and LSPs awaiting processing */
+  struct route_table *nhlfe_gate_table[AFI_MAX];
+  struct lsp_queue lsp_dirty;
+
   /* MPLS processing flags */
   u_int16_t mpls_flags;
 #define MPLS_FLAG_SCHEDULE_LSPS    (1 << 0)
@@ -38,6 +38,7 @@
 #include "zebra/zebra_vrf.h"
 #include "zebra/zebra_mpls.h"
 #include "zebra/zebra_rnh.h"
+#include "zebra/zebra_nhg.h"
 #include "zebra/redistribute.h"
 #include "zebra/zebra_routemap.h"
 #include "zebra/zebra_vxlan.h"
@@ -2648,6 +2649,7 @@ DEFUN (ip_nht_default_route,
     return CMD_SUCCESS;
 
   zebra_rnh_ip_default_route = 1;
+  zebra_nhg_invalidate_all ();
   zebra_evaluate_rnh(0, AF_INET, 1, RNH_NEXTHOP_TYPE, NULL);
   return CMD_SUCCESS;
 }
@@ -2664,6 +2666,7 @@ DEFUN (no_ip_nht_default_route,
     return CMD_SUCCESS;
 
   zebra_rnh_ip_default_route = 0;
+  zebra_nhg_invalidate_all ();
   zebra_evaluate_rnh(0, AF_INET, 1, RNH_NEXTHOP_TYPE, NULL);
   return CMD_SUCCESS;
 }
@@ -2679,6 +2682,7 @@ DEFUN (ipv6_nht_default_route,
     return CMD_SUCCESS;
 
   zebra_rnh_ipv6_default_route = 1;
+  zebra_nhg_invalidate_all ();
   zebra_evaluate_rnh(0, AF_INET6, 1, RNH_NEXTHOP_TYPE, NULL);
   return CMD_SUCCESS;
 }
@@ -2695,10 +2699,21 @@ DEFUN (no_ipv6_nht_default_route,
     return CMD_SUCCESS;
 
   zebra_rnh_ipv6_default_route = 0;
+  zebra_nhg_invalidate_all ();
   zebra_evaluate_rnh(0, AF_INET6, 1, RNH_NEXTHOP_TYPE, NULL);
   return CMD_SUCCESS;
 }
 
+DEFUN (show_nexthop_group,
+       show_nexthop_group_cmd,
+       "show nexthop-group",
+       SHOW_STR
+       "Nexthop groups shared by RIB entries\n")
+{
+  zebra_nhg_print (vty);
+  return CMD_SUCCESS;
+}
+
 DEFUN (show_ip_route_tag,
        show_ip_route_tag_cmd,
        "show ip route tag <1-4294967295>",
@@ -5811,6 +5826,44 @@ DEFUN (no_allow_external_route_update,
   return CMD_SUCCESS;
 }
 
+DEFUN (zebra_interface_timer,
+       zebra_interface_timer_cmd,
+       "zebra interface delay-timer <0-10000>",
+       "Zebra information\n"
+       "Interface state notification to clients\n"
+       "Time in msec to hold interface up/down notifications to clients\n"
+       "0 means notifications are sent immediately\n")
+{
+  u_int32_t delay_timer;
+
+  VTY_GET_INTEGER_RANGE ("delay-timer", delay_timer, argv[0], 0, 10000);
+  zebra_interface_set_delay_timer (delay_timer);
+
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_zebra_interface_timer,
+       no_zebra_interface_timer_cmd,
+       "no zebra interface delay-timer",
+       NO_STR
+       "Zebra information\n"
+       "Interface state notification to clients\n"
+       "Reset delay-timer to default value, 10 msec\n")
+{
+  zebra_interface_set_delay_timer (ZEBRA_IF_DEFAULT_UPDATE_TIMER);
+
+  return CMD_SUCCESS;
+}
+
+ALIAS (no_zebra_interface_timer,
+       no_zebra_interface_timer_val_cmd,
+       "no zebra interface delay-timer <0-10000>",
+       NO_STR
+       "Zebra information\n"
+       "Interface state notification to clients\n"
+       "Reset delay-timer to default value, 10 msec\n"
+       "0 means notifications are sent immediately\n")
+
 /* show vrf */
 DEFUN (show_vrf,
        show_vrf_cmd,
@@ -6198,6 +6251,8 @@ config_write_protocol (struct vty *vty)
   if (allow_delete)
     vty_out(vty, "allow-external-route-update%s", VTY_NEWLINE);
 
+  zebra_interface_write_delay_timer (vty);
+
   if (zebra_rnh_ip_default_route)
     vty_out(vty, "ip nht resolve-via-default%s", VTY_NEWLINE);
 
@@ -6233,6 +6288,9 @@ zebra_vty_init (void)
 
   install_element (CONFIG_NODE, &allow_external_route_update_cmd);
   install_element (CONFIG_NODE, &no_allow_external_route_update_cmd);
+  install_element (CONFIG_NODE, &zebra_interface_timer_cmd);
+  install_element (CONFIG_NODE, &no_zebra_interface_timer_cmd);
+  install_element (CONFIG_NODE, &no_zebra_interface_timer_val_cmd);
   install_element (CONFIG_NODE, &ip_mroute_cmd);
   install_element (CONFIG_NODE, &ip_mroute_dist_cmd);
   install_element (CONFIG_NODE, &no_ip_mroute_cmd);
@@ -6297,6 +6355,7 @@ zebra_vty_init (void)
 
   install_element (VIEW_NODE, &show_vrf_cmd);
   install_element (VIEW_NODE, &show_ip_route_cmd);
+  install_element (VIEW_NODE, &show_nexthop_group_cmd);
   install_element (VIEW_NODE, &show_ip_route_ospf_instance_cmd);
   install_element (VIEW_NODE, &show_ip_route_tag_cmd);
   install_element (VIEW_NODE, &show_ip_nht_cmd);
@@ -527,9 +527,11 @@ zvni_neigh_del_from_vtep (zebra_vni_t *zvni, int uninstall,
   wctx.flags = DEL_REMOTE_NEIGH_FROM_VTEP;
   wctx.r_vtep_ip = *r_vtep_ip;
 
+  kernel_batch_begin ();
   hash_iterate (zvni->neigh_table,
                 (void (*) (struct hash_backet *, void *))
                 zvni_neigh_del_hash_entry, &wctx);
+  kernel_batch_end ();
 }
 
 /*
@@ -551,9 +553,11 @@ zvni_neigh_del_all (struct zebra_vrf *zvrf, zebra_vni_t *zvni,
   wctx.upd_client = upd_client;
   wctx.flags = flags;
 
+  kernel_batch_begin ();
   hash_iterate (zvni->neigh_table,
                 (void (*) (struct hash_backet *, void *))
                 zvni_neigh_del_hash_entry, &wctx);
+  kernel_batch_end ();
 }
 
 /*
@@ -682,18 +686,8 @@ static unsigned int
 mac_hash_keymake (void *p)
 {
   zebra_mac_t *pmac = p;
-  char *pnt = (char *) pmac->macaddr.octet;
-  unsigned int key = 0;
-  int c = 0;
-  
-  key += pnt[c];
-  key += pnt[c + 1];
-  key += pnt[c + 2];
-  key += pnt[c + 3];
-  key += pnt[c + 4];
-  key += pnt[c + 5];
 
-  return (key);
+  return jhash (pmac->macaddr.octet, ETHER_ADDR_LEN, 0);
 }
 
 /*
@@ -809,9 +803,11 @@ zvni_mac_del_from_vtep (zebra_vni_t *zvni, int uninstall,
   wctx.flags = DEL_REMOTE_MAC_FROM_VTEP;
   wctx.r_vtep_ip = *r_vtep_ip;
 
+  kernel_batch_begin ();
   hash_iterate (zvni->mac_table,
                 (void (*) (struct hash_backet *, void *))
                 zvni_mac_del_hash_entry, &wctx);
+  kernel_batch_end ();
 }
 
 /*
@@ -833,9 +829,11 @@ zvni_mac_del_all (struct zebra_vrf *zvrf, zebra_vni_t *zvni,
   wctx.upd_client = upd_client;
   wctx.flags = flags;
 
+  kernel_batch_begin ();
   hash_iterate (zvni->mac_table,
                 (void (*) (struct hash_backet *, void *))
                 zvni_mac_del_hash_entry, &wctx);
+  kernel_batch_end ();
 }
 
 /*
@@ -2399,15 +2397,17 @@ int zebra_vxlan_update_access_vlan (struct interface *ifp,
   if (vlan_if)
     neigh_read_for_vlan (zvrf->zns, vlan_if);
 
-  /* Reinstall any remote MACs for this VNI - with new VLAN info. */
+  /* Reinstall any remote MACs and neighbors for this VNI - with new
+   * VLAN info - handing them to the kernel in batches. */
+  kernel_batch_begin ();
   memset (&m_wctx, 0, sizeof (struct mac_walk_ctx));
   m_wctx.zvni = zvni;
   hash_iterate(zvni->mac_table, zvni_install_mac_hash, &m_wctx);
 
-  /* Reinstall any remote neighbors for this VNI - with new VLAN info. */
   memset (&n_wctx, 0, sizeof (struct neigh_walk_ctx));
   n_wctx.zvni = zvni;
   hash_iterate(zvni->neigh_table, zvni_install_neigh_hash, &n_wctx);
+  kernel_batch_end ();
 
   return 0;
 }
@@ -2886,6 +2886,8 @@ zebra_vxlan_remote_macip_add (struct zserv *client, int sock,
 
   s = client->ibuf;
 
+  /* The entries of one message are installed in the kernel together. */
+  kernel_batch_begin ();
   while (l < length)
     {
       /* Obtain each remote MACIP and process. */
@@ -2974,6 +2976,7 @@ zebra_vxlan_remote_macip_add (struct zserv *client, int sock,
                   zlog_warn ("%u:Failed to add MAC %s VNI %u Remote VTEP %s",
                              zvrf->vrf_id, mac2str (&macaddr, buf, sizeof (buf)),
                              vni, inet_ntoa (r_vtep.u.prefix4));
+                  kernel_batch_end ();
                   return -1;
                 }
 
@@ -3019,6 +3022,7 @@ zebra_vxlan_remote_macip_add (struct zserv *client, int sock,
                              zvrf->vrf_id, ipaddr2str (&ip, buf1, sizeof (buf1)),
                              mac2str (&macaddr, buf, sizeof (buf)),
                              vni, inet_ntoa (r_vtep.u.prefix4));
+                  kernel_batch_end ();
                   return -1;
                 }
 
@@ -3045,6 +3049,7 @@ zebra_vxlan_remote_macip_add (struct zserv *client, int sock,
           zvni_neigh_install (zvni, n);
         }
     }
+  kernel_batch_end ();
 
   return 0;
 }
@@ -3069,6 +3074,7 @@ int zebra_vxlan_remote_macip_del (struct zserv *client, int sock,
 
   s = client->ibuf;
 
+  kernel_batch_begin ();
   while (l < length)
     {
       /* Obtain each remote MACIP and process. */
@@ -3164,6 +3170,7 @@ int zebra_vxlan_remote_macip_del (struct zserv *client, int sock,
             }
         }
     }
+  kernel_batch_end ();
 
   return 0;
 }
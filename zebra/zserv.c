@@ -99,6 +99,7 @@ zserv_flush_data(struct thread *thread)
       					 client, client->sock);
       break;
     case BUFFER_EMPTY:
+      zebra_redistribute_resume (client);
       break;
     }
 
@@ -106,6 +107,35 @@ zserv_flush_data(struct thread *thread)
   return 0;
 }
 
+/* Write out what was queued while the client was corked. */
+void
+zebra_server_uncork (struct zserv *client)
+{
+  client->corked = 0;
+
+  if (client->t_suicide || buffer_empty (client->wb))
+    return;
+
+  switch (buffer_flush_available (client->wb, client->sock))
+    {
+    case BUFFER_ERROR:
+      zlog_warn ("%s: buffer_flush_available failed to zserv client fd %d, "
+                 "closing", __func__, client->sock);
+      client->t_suicide = thread_add_event (zebrad.master, zserv_delayed_close,
+                                            client, 0);
+      return;
+    case BUFFER_EMPTY:
+      THREAD_OFF (client->t_write);
+      break;
+    case BUFFER_PENDING:
+      THREAD_WRITE_ON (zebrad.master, client->t_write,
+                       zserv_flush_data, client, client->sock);
+      break;
+    }
+
+  client->last_write_time = quagga_monotime();
+}
+
 int
 zebra_server_send_message(struct zserv *client)
 {
@@ -114,6 +144,14 @@ zebra_server_send_message(struct zserv *client)
 
   stream_set_getp(client->obuf, 0);
   client->last_write_cmd = stream_getw_from(client->obuf, 6);
+
+  /* Leave it to zebra_server_uncork() to write the message. */
+  if (client->corked)
+    {
+      buffer_put (client->wb, STREAM_DATA (client->obuf),
+                  stream_get_endp (client->obuf));
+      return 0;
+    }
   switch (buffer_write(client->wb, client->sock, STREAM_DATA(client->obuf),
 		       stream_get_endp(client->obuf)))
     {
@@ -1776,6 +1814,9 @@ zebra_client_close (struct zserv *client)
   /* Cleanup any registered nexthops - across all VRFs. */
   zebra_client_close_cleanup_rnh (client);
 
+  /* Drop the redistribution snapshots not yet sent. */
+  zebra_redistribute_snapshot_free (client);
+
   /* Close file descriptor. */
   if (client->sock)
     {
@@ -2360,6 +2401,9 @@ zebra_show_client_detail (struct vty *vty, struct zserv *client)
 	   client->redist_v4_del_cnt, VTY_NEWLINE);
   vty_out (vty, "Redist:v6   %-12d%-12d%-12d%s", client->redist_v6_add_cnt, 0,
 	   client->redist_v6_del_cnt, VTY_NEWLINE);
+  if (client->redist_snapshots && listcount (client->redist_snapshots))
+    vty_out (vty, "Redistribution snapshots pending: %d%s",
+             listcount (client->redist_snapshots), VTY_NEWLINE);
   vty_out (vty, "Connected   %-12d%-12d%-12d%s", client->ifadd_cnt, 0,
 	   client->ifdel_cnt, VTY_NEWLINE);
   vty_out (vty, "BFD peer    %-12d%-12d%-12d%s", client->bfd_peer_add_cnt,
@@ -2531,6 +2575,59 @@ DEFUN (show_zebra_client_summary,
   return CMD_SUCCESS;
 }
 
+/* Start timing a startup phase. */
+void
+zebra_startup_phase_begin (struct timeval *start)
+{
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, start);
+}
+
+/* Account the time since START to the given startup phase. */
+void
+zebra_startup_phase_end (int phase, struct timeval *start)
+{
+  struct timeval now;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
+  zebrad.startup_usecs[phase] += (now.tv_sec - start->tv_sec) * 1000000
+                                 + now.tv_usec - start->tv_usec;
+}
+
+static void
+zebra_show_startup_phase (struct vty *vty, const char *name, int phase)
+{
+  unsigned long usecs = zebrad.startup_usecs[phase];
+
+  vty_out (vty, "  %-28s %lu.%06lu sec%s", name,
+           usecs / 1000000, usecs % 1000000, VTY_NEWLINE);
+}
+
+DEFUN (show_zebra_startup,
+       show_zebra_startup_cmd,
+       "show zebra startup",
+       SHOW_STR
+       "Zebra information\n"
+       "Startup timing\n")
+{
+  vty_out (vty, "Startup:%s", VTY_NEWLINE);
+  zebra_show_startup_phase (vty, "Interfaces read", ZEBRA_STARTUP_INTERFACES);
+  zebra_show_startup_phase (vty, "Kernel routes read",
+                            ZEBRA_STARTUP_KERNEL_ROUTES);
+  zebra_show_startup_phase (vty, "Configuration read", ZEBRA_STARTUP_CONFIG);
+  zebra_show_startup_phase (vty, "Stale routes swept", ZEBRA_STARTUP_SWEEP);
+  if (zebrad.startup_rib_pending)
+    vty_out (vty, "  %-28s in progress%s", "Initial RIB processing",
+             VTY_NEWLINE);
+  else
+    zebra_show_startup_phase (vty, "Initial RIB processing",
+                              ZEBRA_STARTUP_RIB);
+
+  vty_out (vty, "  %lu kernel routes read in %lu reads of %lu bytes%s",
+           zebrad.startup_routes, zebrad.startup_dump_reads,
+           zebrad.startup_dump_bytes, VTY_NEWLINE);
+  return CMD_SUCCESS;
+}
+
 /* Table configuration write function. */
 static int
 config_write_table (struct vty *vty)
@@ -2705,6 +2802,7 @@ zebra_init (void)
   install_element (VIEW_NODE, &show_ip_forwarding_cmd);
   install_element (CONFIG_NODE, &ip_forwarding_cmd);
   install_element (CONFIG_NODE, &no_ip_forwarding_cmd);
+  install_element (VIEW_NODE, &show_zebra_startup_cmd);
   install_element (ENABLE_NODE, &show_zebra_client_cmd);
   install_element (ENABLE_NODE, &show_zebra_client_summary_cmd);
 
@@ -59,6 +59,14 @@ struct zserv
   /* Thread for delayed close. */
   struct thread *t_suicide;
 
+  /* Set while messages are only queued in wb, see zebra_server_uncork(). */
+  int corked;
+
+  /* Redistribution snapshots still to be sent, and the thread sending
+   * them, see zebra_redistribute(). */
+  struct list *redist_snapshots;
+  struct thread *t_redist;
+
   /* default routing table this client munges */
   int rtm_table;
 
@@ -121,6 +129,14 @@ struct zserv
   int last_write_cmd;
 };
 
+/* Startup phases, timed for "show zebra startup". */
+#define ZEBRA_STARTUP_INTERFACES        0
+#define ZEBRA_STARTUP_KERNEL_ROUTES     1
+#define ZEBRA_STARTUP_CONFIG            2
+#define ZEBRA_STARTUP_SWEEP             3
+#define ZEBRA_STARTUP_RIB               4
+#define ZEBRA_STARTUP_MAX               5
+
 /* Zebra instance */
 struct zebra_t
 {
@@ -137,6 +153,18 @@ struct zebra_t
 
   /* LSP work queue */
   struct work_queue *lsp_process_q;
+
+  /* Time spent in each startup phase, in microseconds. */
+  unsigned long startup_usecs[ZEBRA_STARTUP_MAX];
+
+  /* Start of the initial RIB processing, if it has not finished yet. */
+  struct timeval startup_rib_begin;
+  int startup_rib_pending;
+
+  /* Kernel routes read at startup, and the dump reads they took. */
+  unsigned long startup_routes;
+  unsigned long startup_dump_reads;
+  unsigned long startup_dump_bytes;
 };
 extern struct zebra_t zebrad;
 extern unsigned int multipath_num;
@@ -159,7 +187,10 @@ extern void kernel_terminate (struct zebra_ns *);
 extern void zebra_route_map_init (void);
 extern void zebra_snmp_init (void);
 extern void zebra_vty_init (void);
+extern void zebra_startup_phase_begin (struct timeval *start);
+extern void zebra_startup_phase_end (int phase, struct timeval *start);
 
+extern void zebra_server_uncork (struct zserv *);
 extern int zsend_vrf_add (struct zserv *, struct zebra_vrf *);
 extern int zsend_vrf_delete (struct zserv *, struct zebra_vrf *);
 
@@ -37,3 +37,9 @@ int zsend_vrf_add (struct zserv *zserv, struct zebra_vrf *zvrf)
 
 void router_id_init (struct zebra_vrf *zvrf)
 { return; }
+
+void zebra_startup_phase_begin (struct timeval *start)
+{ return; }
+
+void zebra_startup_phase_end (int phase, struct timeval *start)
+{ return; }